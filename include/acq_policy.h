@@ -0,0 +1,44 @@
+#pragma once
+#include <stdint.h>
+#include "geometry.h"
+
+// ==========================================
+// ADAPTIVE ACQUISITION POLICY
+// ==========================================
+
+struct AcqLevel {
+  uint8_t refreshHz;
+  uint8_t adcBits;
+};
+
+// One instance per sensor stream (device: sensor.cpp, host: per recording)
+struct AcqPolicy {
+  float *prevFrame;
+  bool havePrev;
+  uint32_t prevTimeMs;
+  int level;
+  int dwell;
+  int steadyFrames;
+  float motion;                       // smoothed moving-pixel fraction
+  float noise;                        // last per-frame temporal noise (C rms)
+  float levelNoise[ACQ_LEVEL_COUNT];  // smoothed noise measured at each level
+};
+
+struct AcqDecision {
+  bool changed;
+  int from;
+  int to;
+  float motion;
+  float noiseBefore;
+};
+
+void initAcqPolicy(AcqPolicy &p, float *prevFrame, int level);
+// Feed every conditioned frame with its capture time; a decision with
+// changed == true must be applied to the sensor before the next read.
+AcqDecision acqPolicyUpdate(AcqPolicy &p, const float *frame, uint32_t nowMs);
+
+const AcqLevel &acqLevel(int level);
+// Full-frame period (two subpages) in ms
+inline float acqLevelLatencyMs(int level) {
+  return 2000.0f / acqLevel(level).refreshHz;
+}
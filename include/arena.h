@@ -0,0 +1,166 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+#include "main.h"
+
+// ==========================================
+// ARENAS
+// ==========================================
+
+// DMA   - internal SRAM, DMA-capable: whatever is streamed to the panel
+// FAST  - internal SRAM: per-frame working set at sensor resolution, task stacks
+// PSRAM - external RAM: large, rarely touched buffers
+//
+// DMA and FAST are static arrays, so the internal layout is fixed and
+// budgeted at compile time. The PSRAM arena is allocated by initMemory()
+// when psramFound(); without PSRAM its buffers fall back to the internal
+// slots of MEMORY_PSRAM_FALLBACKS, or are null.
+enum MemArena {
+  ARENA_DMA = 0,
+  ARENA_FAST = 1,
+  ARENA_PSRAM = 2,
+  ARENA_COUNT = 3
+};
+
+// Extracted calibration of the selected sensor; host builds have no sensor
+#if defined(ARDUINO) && SENSOR_MODEL == SENSOR_MLX90641
+#include <MLX90641_API.h>
+#define SENSOR_PARAMS_BYTES sizeof(paramsMLX90641)
+#elif defined(ARDUINO)
+#include <MLX90640_API.h>
+#define SENSOR_PARAMS_BYTES sizeof(paramsMLX90640)
+#else
+#define SENSOR_PARAMS_BYTES 0
+#endif
+
+#define SENSOR_FRAME_BYTES  (FRAME_W * FRAME_H * sizeof(float))
+#define SENSOR_RAW_BYTES    (MLX_W * MLX_H * sizeof(float))
+#define SENSOR_SLOT_BYTES   (SENSOR_COUNT > 1 ? SENSOR_COUNT * 3 * SENSOR_RAW_BYTES : 0)
+#define EDGE_MASK_BYTES     ((FB_WIDTH * FB_HEIGHT + 7) / 8)
+#define FB_PIXEL_BYTES      (FB_INDEXED ? 1 : 2)
+#define PANEL_PIXEL_BYTES   3
+#define RENDER_CACHE_ROWS   (FOVEATED_RENDER ? 6 : 2)     // per render strip: 2 bilinear + 4 bicubic rows
+#define MONITOR_CELLS       ((FRAME_W / MONITOR_SNAPSHOT_DECIMATE) * (FRAME_H / MONITOR_SNAPSHOT_DECIMATE))
+#define MONITOR_STATS_BYTES (FRAME_W * FRAME_H * (3 * sizeof(int32_t) + 3 * sizeof(int16_t)))
+#define MONITOR_SNAPSHOT_BYTES (2 * sizeof(uint32_t) + 2 * MONITOR_CELLS * sizeof(int16_t))
+#define BURST_SAMPLE_BYTES  (2 * sizeof(uint32_t) + MLX_RAW_WORDS * sizeof(uint16_t))
+
+// ==========================================
+// BUFFER TABLE (name, arena, bytes)
+// ==========================================
+
+#define MEMORY_BUFFERS(X) \
+  X(BUF_FRAMEBUFFER,    FB_INDEXED ? ARENA_FAST : ARENA_DMA, FB_WIDTH * FB_HEIGHT * FB_PIXEL_BYTES) \
+  X(BUF_PUSH_LINES,     ARENA_DMA,  FB_INDEXED ? FB_PUSH_ROWS * FB_WIDTH * PANEL_PIXEL_BYTES : 0) \
+  X(BUF_EDGE_MASK,      ARENA_FAST, EDGE_MASK_BYTES) \
+  X(BUF_RENDER_ROWS,    ARENA_FAST, 2 * RENDER_CACHE_ROWS * FB_WIDTH * sizeof(float)) \
+  X(BUF_RAW_FRAME,      ARENA_FAST, SENSOR_FRAME_BYTES) \
+  X(BUF_SMOOTHED_FRAME, ARENA_FAST, SENSOR_FRAME_BYTES) \
+  X(BUF_LAST_VALID,     ARENA_FAST, SENSOR_FRAME_BYTES) \
+  X(BUF_TEMPORAL,       ARENA_FAST, TEMPORAL_FILTER_SIZE * SENSOR_FRAME_BYTES) \
+  X(BUF_SENSOR_SLOTS,   ARENA_FAST, SENSOR_SLOT_BYTES) \
+  X(BUF_SENSOR_PARAMS,  ARENA_FAST, SENSOR_COUNT * SENSOR_PARAMS_BYTES) \
+  X(BUF_CALIB_EEPROM,   ARENA_PSRAM, MLX_EEPROM_WORDS * sizeof(uint16_t)) \
+  X(BUF_INTERP_FRAMES,  ARENA_FAST, FRAME_INTERPOLATION ? 4 * SENSOR_FRAME_BYTES : 0) \
+  X(BUF_ACQ_PREV,       ARENA_FAST, ACQ_ADAPTIVE ? SENSOR_FRAME_BYTES : 0) \
+  X(BUF_TRACE_RING,     ARENA_FAST, TRACE_ENABLED ? TRACE_CORES * TRACE_RING_SIZE * TRACE_RECORD_BYTES : 0) \
+  X(BUF_LOG_RING,       ARENA_FAST, LOG_DEFERRED ? LOG_RING_SIZE * LOG_RECORD_BYTES : 0) \
+  X(BUF_MONITOR_STATS,  ARENA_FAST, MONITOR_ENABLED ? MONITOR_STATS_BYTES : 0) \
+  X(BUF_MONITOR_VIEW,   ARENA_FAST, MONITOR_ENABLED ? SENSOR_FRAME_BYTES : 0) \
+  X(BUF_MONITOR_SNAPS,  ARENA_PSRAM, MONITOR_ENABLED ? MONITOR_SNAPSHOT_COUNT * MONITOR_SNAPSHOT_BYTES : 0) \
+  X(BUF_BURST_RING,     ARENA_PSRAM, BURST_ENABLED ? BURST_SAMPLES * BURST_SAMPLE_BYTES : 0) \
+  X(BUF_STACK_ACQUIRE,  ARENA_FAST, FRAME_INTERPOLATION ? ACQUIRE_TASK_STACK : 0) \
+  X(BUF_STACK_SENSORS,  ARENA_FAST, SENSOR_COUNT > 1 ? 2 * SENSOR_TASK_STACK : 0) \
+  X(BUF_STACK_RENDER,   ARENA_FAST, PARALLEL_RENDER ? RENDER_WORKER_STACK : 0) \
+  X(BUF_STACK_LOG,      ARENA_FAST, LOG_DEFERRED ? LOG_TASK_STACK : 0) \
+  X(BUF_STACK_SENSOR_BOOT, ARENA_FAST, FAST_BOOT ? SENSOR_BOOT_STACK : 0)
+
+// Internal SRAM reserved at the end of the FAST arena for PSRAM buffers
+// that are needed without PSRAM too (the monitor ring is shorter there).
+// PSRAM buffers not listed, the burst ring, are null without PSRAM.
+#define MEMORY_PSRAM_FALLBACKS(X) \
+  X(BUF_CALIB_EEPROM,   MLX_EEPROM_WORDS * sizeof(uint16_t)) \
+  X(BUF_MONITOR_SNAPS,  MONITOR_ENABLED ? MONITOR_SNAPSHOT_COUNT_NO_PSRAM * MONITOR_SNAPSHOT_BYTES : 0)
+
+enum MemBuffer {
+#define MEM_BUFFER_ID(name, arena, bytes) name,
+  MEMORY_BUFFERS(MEM_BUFFER_ID)
+#undef MEM_BUFFER_ID
+  BUF_COUNT
+};
+
+struct MemBufferSpec {
+  MemArena arena;
+  size_t bytes;
+  const char *name;
+};
+
+constexpr size_t memAlign(size_t bytes) {
+  return (bytes + ARENA_ALIGN - 1) & ~(size_t)(ARENA_ALIGN - 1);
+}
+
+constexpr MemBufferSpec MEM_BUFFER_SPECS[BUF_COUNT] = {
+#define MEM_BUFFER_SPEC(name, arena, bytes) { arena, memAlign(bytes), #name },
+  MEMORY_BUFFERS(MEM_BUFFER_SPEC)
+#undef MEM_BUFFER_SPEC
+};
+
+constexpr size_t memOffset(MemBuffer id) {
+  size_t offset = 0;
+  for (int i = 0; i < id; i++) {
+    if (MEM_BUFFER_SPECS[i].arena == MEM_BUFFER_SPECS[id].arena) offset += MEM_BUFFER_SPECS[i].bytes;
+  }
+  return offset;
+}
+
+constexpr size_t memArenaSize(MemArena arena) {
+  size_t total = 0;
+  for (int i = 0; i < BUF_COUNT; i++) {
+    if (MEM_BUFFER_SPECS[i].arena == arena) total += MEM_BUFFER_SPECS[i].bytes;
+  }
+  return total;
+}
+
+struct MemFallbackSpec {
+  MemBuffer id;
+  size_t bytes;
+};
+
+constexpr MemFallbackSpec MEM_FALLBACK_SPECS[] = {
+#define MEM_FALLBACK_SPEC(name, bytes) { name, memAlign(bytes) },
+  MEMORY_PSRAM_FALLBACKS(MEM_FALLBACK_SPEC)
+#undef MEM_FALLBACK_SPEC
+};
+
+constexpr int MEM_FALLBACK_COUNT = sizeof(MEM_FALLBACK_SPECS) / sizeof(MEM_FALLBACK_SPECS[0]);
+
+// Fallback slot k, after the FAST buffers of the table
+constexpr size_t memFallbackOffset(int k) {
+  size_t offset = memArenaSize(ARENA_FAST);
+  for (int i = 0; i < k; i++) offset += MEM_FALLBACK_SPECS[i].bytes;
+  return offset;
+}
+
+constexpr size_t memFastStorageSize() {
+  return memFallbackOffset(MEM_FALLBACK_COUNT);
+}
+
+// The internal budget covers the static arrays only; the PSRAM arena is
+// checked against its budget here and against the heap at boot
+static_assert(memArenaSize(ARENA_DMA) + memFastStorageSize() <= INTERNAL_RAM_BUDGET,
+              "internal SRAM budget exceeded, move buffers to ARENA_PSRAM or shrink them");
+static_assert(memArenaSize(ARENA_PSRAM) <= PSRAM_BUDGET, "PSRAM budget exceeded");
+
+// Allocates the PSRAM arena; call before the first memBuffer()
+void initMemory();
+bool memHasPsram();
+// Null for a PSRAM buffer without PSRAM and without a fallback slot
+void *memBuffer(MemBuffer id);
+// Size of memBuffer(id): the fallback slot's without PSRAM, 0 when null
+size_t memBufferBytes(MemBuffer id);
+void reportMemory();
+
+template <typename T>
+inline T *memBufferAs(MemBuffer id) {
+  return static_cast<T *>(memBuffer(id));
+}
@@ -0,0 +1,82 @@
+#pragma once
+#include <stdint.h>
+#include <string.h>
+#include <type_traits>
+#include "main.h"
+
+// ==========================================
+// LOG FORMATS (id, printf format)
+// ==========================================
+
+// Records carry a format id and up to LOG_MAX_ARGS 32-bit arguments;
+// formatting happens later in the drain task (or on the host, see
+// scripts/log_decode.py, which reads this table). Conversions: d i u x X c
+// and f e g; length modifiers are ignored, %s is not supported.
+#define LOG_FORMATS(X) \
+  X(LOG_STATS_LIVE,    "Mode: LIVE | FPS: %.1f | Render: %.2fms | Temp: %.1f-%.1fC\n") \
+  X(LOG_STATS_RGB,     "Mode: RGB | FPS: %.1f | Render: %.2fms | Temp: %.1f-%.1fC\n") \
+  X(LOG_QUALITY,       "quality: level %d -> %d | work %.2fms, push %.2fms, budget %.2fms\n") \
+  X(LOG_FOVEA,         "fovea: %d px (%.1f%%) | upscale %.2fms\n") \
+  X(LOG_SENSOR_ERROR,  "sensor read error (status: %d)\n") \
+  X(LOG_BURST,         "burst: %lu subpages (%d kept) in %.1f ms, %.1f Hz, %lu errors\n") \
+  X(LOG_FRAME_REJECT,  "frame rejected: %d/%d crptd pixels (%.1f%%)\n") \
+  X(LOG_I2C_CLOCK,     "i2c clock -> %lu Hz (window errors: %lu, avg transfer %lu us)\n") \
+  X(LOG_I2C_SENSOR,    "i2c sensor %d: port %u clock -> %lu Hz (window errors: %lu, avg transfer %lu us)\n") \
+  X(LOG_ACQ_SWITCH,    "acq: %uHz/%ubit -> %uHz/%ubit | motion %.0f%%\n") \
+  X(LOG_ACQ_COST,      "acq:   noise %.2fC -> %.2fC | latency %.0f -> %.0f ms\n") \
+  X(LOG_BUS_TOTAL,     "bus: %lu bytes, %lu tx, %lu windows, %lu cs | worst %lu bytes | over budget %lu\n") \
+  X(LOG_BUS_SITES,     "  other %lu | frame %lu | markers %lu | hotspots %lu | legend %lu | menu %lu bytes\n")
+
+enum LogFormat : uint16_t {
+#define LOG_FORMAT_ID(id, fmt) id,
+  LOG_FORMATS(LOG_FORMAT_ID)
+#undef LOG_FORMAT_ID
+  LOG_FORMAT_COUNT
+};
+
+#define LOG_MAX_ARGS 6
+
+// seq is the slot's commit marker (ticket + 1) and doubles as a sequence
+// number for spotting drops in binary captures
+struct LogRecord {
+  uint32_t seq;
+  uint32_t timestampUs;
+  uint16_t format;
+  uint8_t argc;
+  uint8_t core;
+  uint32_t args[LOG_MAX_ARGS];
+};
+
+static_assert(sizeof(LogRecord) == LOG_RECORD_BYTES, "LOG_RECORD_BYTES out of sync");
+static_assert((LOG_RING_SIZE & (LOG_RING_SIZE - 1)) == 0, "LOG_RING_SIZE must be a power of two");
+
+void initLog();
+void logFlush();
+// While paused, records stay in the ring (synchronous logging drops them)
+// and the serial port belongs to the caller, e.g. frame injection
+void logPause(bool pause);
+void logPush(LogFormat format, const uint32_t *args, int argc);
+int logFormat(const LogRecord &rec, char *out, size_t size);
+const char *logFormatString(uint16_t format);
+uint32_t logDropped();
+
+template <typename T>
+inline uint32_t logWord(T v) {
+  static_assert(std::is_arithmetic<T>::value || std::is_enum<T>::value, "log arguments must be numbers");
+  if constexpr (std::is_floating_point<T>::value) {
+    float f = (float)v;
+    uint32_t w;
+    memcpy(&w, &f, sizeof(w));
+    return w;
+  } else {
+    return (uint32_t)v;
+  }
+}
+
+// Never blocks with LOG_DEFERRED: a full ring drops the record and counts it
+template <typename... Args>
+inline void logWrite(LogFormat format, Args... args) {
+  static_assert(sizeof...(Args) <= LOG_MAX_ARGS, "too many log arguments");
+  const uint32_t words[sizeof...(Args) + 1] = {logWord(args)...};
+  logPush(format, words, (int)sizeof...(Args));
+}
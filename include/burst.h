@@ -0,0 +1,42 @@
+#pragma once
+#include <stdint.h>
+#include "arena.h"
+
+// ==========================================
+// BURST CAPTURE RING (raw sensor subpages)
+// ==========================================
+
+// Subpages are stored exactly as read from the sensor (MLX_RAW_WORDS words,
+// pixel data plus the aux block) so capture costs nothing but the I2C
+// transfer; temperatures are computed only when a sample is reviewed or
+// exported. status < 0 marks a failed read whose raw words are garbage.
+struct BurstSample {
+  uint32_t timestampUs;
+  int16_t status;
+  uint16_t subpage;
+  uint16_t raw[MLX_RAW_WORDS];
+};
+
+static_assert(sizeof(BurstSample) == BURST_SAMPLE_BYTES, "BURST_SAMPLE_BYTES out of sync");
+
+// Memory is fixed at init; a burst of any length only overwrites the oldest samples
+struct BurstRing {
+  BurstSample *samples;
+  int capacity;
+  int head;               // next slot to write
+  int count;
+  uint32_t captured;      // including overwritten samples
+  uint32_t errors;
+};
+
+void initBurst(BurstRing &b, BurstSample *samples, int capacity);
+void burstReset(BurstRing &b);
+// Slot for the next read; overwrites the oldest sample once the ring is full
+BurstSample &burstNext(BurstRing &b);
+// Account the sample returned by the last burstNext()
+void burstCommit(BurstRing &b, const BurstSample &s);
+// k = 0 is the oldest sample still kept
+BurstSample &burstSample(const BurstRing &b, int k);
+// Span and mean subpage rate of the samples kept
+uint32_t burstSpanUs(const BurstRing &b);
+float burstRateHz(const BurstRing &b);
@@ -0,0 +1,65 @@
+#pragma once
+#include <stdint.h>
+#include "main.h"
+
+// ==========================================
+// DISPLAY BUS ACCOUNTING (site id, name)
+// ==========================================
+
+// Traffic is attributed to the call site that is current when it is sent;
+// anything outside a BusScope lands in BUS_SITE_OTHER.
+#define BUS_SITES(X) \
+  X(BUS_SITE_OTHER,    "other") \
+  X(BUS_SITE_FRAME,    "frame") \
+  X(BUS_SITE_MARKERS,  "markers") \
+  X(BUS_SITE_HOTSPOTS, "hotspots") \
+  X(BUS_SITE_LEGEND,   "legend") \
+  X(BUS_SITE_MENU,     "menu")
+
+enum BusSite : uint8_t {
+#define BUS_SITE_ID(id, name) id,
+  BUS_SITES(BUS_SITE_ID)
+#undef BUS_SITE_ID
+  BUS_SITE_COUNT
+};
+
+struct BusCounters {
+  uint32_t bytes;          // command + data bytes on the wire
+  uint32_t transactions;   // beginWrite .. endWrite pairs
+  uint32_t windowChanges;  // column / row address commands
+  uint32_t csToggles;
+};
+
+// One per bus. The firmware's panel bus uses displayBusLedger (only the
+// display task draws, so no locking); host tools keep one per thread.
+struct BusLedger {
+  BusCounters current[BUS_SITE_COUNT];
+  BusCounters lastFrame[BUS_SITE_COUNT];
+  BusSite site;
+  uint32_t frames;
+  uint32_t framesOverBudget;
+  uint32_t worstFrameBytes;
+};
+
+extern BusLedger displayBusLedger;
+
+void initBusLedger(BusLedger &l);
+
+// Bus implementations report what they send
+void busOnBeginWrite(BusLedger &l);
+void busOnEndWrite(BusLedger &l);
+void busOnCommand(BusLedger &l, uint8_t cmd);
+void busOnData(BusLedger &l, uint32_t bytes);
+
+// Closes the current frame. Returns false when a non-zero byte budget was
+// exceeded; the frame is still counted.
+bool busFrameEnd(BusLedger &l, uint32_t byteBudget = BUS_FRAME_BYTE_BUDGET);
+BusCounters busLastFrameTotal(const BusLedger &l);
+const char *busSiteName(BusSite site);
+void busReport(const BusLedger &l);
+
+struct BusScope {
+  BusSite previous;
+  explicit BusScope(BusSite site) : previous(displayBusLedger.site) { displayBusLedger.site = site; }
+  ~BusScope() { displayBusLedger.site = previous; }
+};
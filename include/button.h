@@ -2,6 +2,16 @@
 #include <stdint.h>
 #include "main.h"
 
+// Short and long presses fire on release, split at BTN_LONG_PRESS_MS. A
+// hold fires as soon as it reaches BTN_HOLD_PRESS_MS; the release after it
+// is swallowed. No press is ever held back waiting for a second one.
+enum ButtonEvent {
+  BTN_NONE = 0,
+  BTN_SHORT = 1,
+  BTN_LONG = 2,
+  BTN_HOLD = 3
+};
+
 void initButton();
-bool buttonPressed();
-void buttonUpdate();
\ No newline at end of file
+ButtonEvent buttonEvent();
+void buttonUpdate();
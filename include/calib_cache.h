@@ -0,0 +1,39 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+#include "main.h"
+
+// ==========================================
+// CALIBRATION CACHE
+// ==========================================
+
+// Record: CalibCacheHeader followed by the raw parameter struct (NVS keeps
+// the two as separate blobs so neither needs a staging buffer). A record is
+// only used when the device ID, the probe CRC (short EEPROM read at boot),
+// the parameter size and the parameter CRC all match.
+struct CalibCacheHeader {
+  uint32_t magic;
+  uint16_t version;
+  uint16_t sensorModel;
+  uint16_t deviceId[3];
+  uint16_t reserved;
+  uint32_t eepromCrc;     // full dump, for reporting / diagnostics
+  uint32_t probeCrc;      // first CALIB_PROBE_WORDS words
+  uint32_t paramsBytes;
+  uint32_t paramsCrc;
+};
+
+// Pure record (de)serialisation, shared by the NVS store and host tools.
+// calibHeaderMatches() checks everything but the parameter CRC.
+void calibMakeHeader(CalibCacheHeader &h, const uint16_t *eeprom, const void *params, size_t paramsBytes);
+bool calibHeaderMatches(const CalibCacheHeader &h, const uint16_t *probeWords, size_t paramsBytes);
+
+// Returns the record size written, or 0 if out is too small.
+size_t calibPackRecord(uint8_t *out, size_t outBytes, const uint16_t *eeprom,
+                       const void *params, size_t paramsBytes);
+bool calibUnpackRecord(const uint8_t *record, size_t recordBytes, const uint16_t *probeWords,
+                       void *params, size_t paramsBytes);
+
+// probeWords = EEPROM words [0, CALIB_PROBE_WORDS), which include the device ID
+bool calibCacheLoad(const uint16_t *probeWords, void *params, size_t paramsBytes);
+bool calibCacheStore(const uint16_t *eeprom, const void *params, size_t paramsBytes);
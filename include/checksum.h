@@ -0,0 +1,21 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+
+// ==========================================
+// CRC-32 (IEEE 802.3, reflected, as zlib)
+// ==========================================
+
+// Bitwise, no table: used for small records (calibration cache) and
+// once-per-frame checks, never in a pixel loop
+inline uint32_t crc32Bytes(const void *data, size_t bytes) {
+  const uint8_t *p = (const uint8_t*)data;
+  uint32_t crc = 0xFFFFFFFFUL;
+  for (size_t i = 0; i < bytes; i++) {
+    crc ^= p[i];
+    for (int b = 0; b < 8; b++) {
+      crc = (crc >> 1) ^ (0xEDB88320UL & (0U - (crc & 1U)));
+    }
+  }
+  return ~crc;
+}
@@ -0,0 +1,28 @@
+#pragma once
+#include <stdint.h>
+#include "geometry.h"
+
+// ==========================================
+// RAW FRAME CONDITIONING (median + bad pixel repair)
+// ==========================================
+
+// One instance per sensor stream. The firmware keeps a single one in
+// sensor.cpp; host tools keep one per recording.
+struct FrameConditioner {
+  float *temporal[TEMPORAL_FILTER_SIZE];
+  int temporalIndex;
+  bool temporalFilled;
+  float *lastValid;
+  bool lastValidInitialized;
+};
+
+void initConditioner(FrameConditioner &c, float *temporalBase, float *lastValid);
+int countInvalidPixels(const float *buf, int pixels = FrameGeom::pixels);
+
+// raw and out may alias. Returns false when the frame is rejected (more
+// than a quarter of the pixels invalid); invalidCount is set either way.
+// missingPixels are known to be invalid (a failed sensor's share of a
+// stitched frame): they are repaired, but the quarter is taken of the
+// remaining pixels only.
+bool conditionRawFrame(FrameConditioner &c, const float *raw, float *out, int &invalidCount,
+                       int missingPixels = 0);
@@ -0,0 +1,37 @@
+#pragma once
+#include <Arduino_GFX_Library.h>
+#include "bus_stats.h"
+
+// ==========================================
+// COUNTING DISPLAY BUS
+// ==========================================
+
+// Forwards every call to the real bus and reports the traffic to a
+// BusLedger. Calls not overridden here (batchOperation, the wider
+// command + data helpers) fall back to the base class, which issues them
+// through the overridden primitives, so they are counted there.
+class CountingBus : public Arduino_DataBus {
+public:
+  CountingBus(Arduino_DataBus *inner, BusLedger &ledger) : inner(inner), ledger(ledger) {}
+
+  bool begin(int32_t speed = GFX_NOT_DEFINED, int8_t dataMode = GFX_NOT_DEFINED) override;
+  void beginWrite() override;
+  void endWrite() override;
+  void writeCommand(uint8_t c) override;
+  void writeCommand16(uint16_t c) override;
+  void write(uint8_t d) override;
+  void write16(uint16_t d) override;
+  void writeC8D8(uint8_t c, uint8_t d) override;
+  void writeC8D16(uint8_t c, uint16_t d) override;
+  void writeC8D16D16(uint8_t c, uint16_t d1, uint16_t d2) override;
+  void writeRepeat(uint16_t p, uint32_t len) override;
+  void writePixels(uint16_t *data, uint32_t len) override;
+  void writeBytes(uint8_t *data, uint32_t len) override;
+  void writePattern(uint8_t *data, uint8_t len, uint32_t repeat) override;
+  void writeIndexedPixels(uint8_t *data, uint16_t *idx, uint32_t len) override;
+  void writeIndexedPixelsDouble(uint8_t *data, uint16_t *idx, uint32_t len) override;
+
+private:
+  Arduino_DataBus *inner;
+  BusLedger &ledger;
+};
@@ -1,15 +1,29 @@
 #pragma once
 #include <Arduino_GFX_Library.h>
 #include "main.h"
+#include "isotherm.h"
 
 extern Arduino_GFX *gfx;
 uint16_t rgb565(uint8_t r, uint8_t g, uint8_t b);
 
 void initDisplay();
 void displayStartupScreen();
+void drawStartupScreen();
 void drawThermalImage(const float *buf, float tMin, float tMax, DisplayMode mode);
+bool repaintFrame(DisplayMode mode);
+// Last drawThermalImage: full-quality (fovea) area and upscale time without the push
+int foveaPixels();
+uint32_t renderTimeUs();
+// Last drawThermalImage: framebuffer push to the panel
+uint32_t pushTimeUs();
+// Quality controller level (quality.h) for the following frames
+void setRenderQuality(int level);
+const IsoSegment *isothermSegments(int &count);
 void drawMenu(DisplayMode currentMode);
 void drawLegend(float tMin, float tMax, float fps);
+void drawBurstStatus(int index, int count);
 void drawChargingScreen();
 void resetDisplayState();
+// CRC-32 of the framebuffer as last rendered (before the panel push)
+uint32_t frameBufferCrc();
 void setDisplayBrightness(uint8_t level);
\ No newline at end of file
@@ -0,0 +1,7 @@
+#pragma once
+#include <stdint.h>
+#include "geometry.h"
+
+void initFrameInterp(float *published, float *prev, float *latest);
+void pushConditionedFrame(const float *frame, uint32_t timestampUs);
+bool synthesizeFrame(float *out, uint32_t nowUs);
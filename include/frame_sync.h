@@ -0,0 +1,50 @@
+#pragma once
+#include <stdint.h>
+#include "geometry.h"
+
+// ==========================================
+// MULTI-SENSOR FRAME SYNC
+// ==========================================
+
+// The publish / select half of the sensor array, kept free of Wire and
+// FreeRTOS. Acquisition tasks read a sensor into its slot's back buffer
+// and publish it; the consumer takes one frame from every sensor once they
+// were all published within STITCH_MAX_SKEW_US of each other. A failed read
+// publishes a NaN frame, so the neighbour covers the overlap and the
+// conditioner repairs the rest; a sensor that has not published for
+// STITCH_STALE_US is stitched as NaN instead of stalling the array.
+// Callers serialise publish and take (sensor_array.cpp holds slotLock).
+
+static const int FRAME_SYNC_MAX_SENSORS = 4;
+
+// Reads one frame of the given sensor; 0 on success
+typedef int (*SensorReadFn)(int sensor, float *frame, void *ctx);
+
+struct SensorSlot {
+  float *back;
+  float *front;
+  float *staged;
+  uint32_t timestampUs;
+  uint32_t sequence;
+  int status;
+};
+
+struct FrameSync {
+  SensorSlot slots[FRAME_SYNC_MAX_SENSORS];
+  uint32_t consumedSeq[FRAME_SYNC_MAX_SENSORS];
+  bool delivered[FRAME_SYNC_MAX_SENSORS];   // in the last taken set
+  int count;
+};
+
+// slotBase holds three SensorGeom frames per sensor
+void initFrameSync(FrameSync &f, int count, float *slotBase, uint32_t nowUs);
+int frameSyncRead(FrameSync &f, int sensor, SensorReadFn read, void *ctx);
+void frameSyncPublish(FrameSync &f, int sensor, int status, uint32_t nowUs);
+
+// Stages one frame per sensor and returns true when a set is ready. status
+// is 0 if at least one sensor delivered, else the first failing status.
+bool frameSyncTake(FrameSync &f, uint32_t nowUs, int &status);
+void frameSyncStitch(const FrameSync &f, float *out);
+// Stitched pixels only failed or stale sensors cover in the last taken set:
+// known NaN, so the conditioner leaves them out of its reject count
+int frameSyncMissingPixels(const FrameSync &f);
@@ -0,0 +1,46 @@
+#pragma once
+#include <stdint.h>
+#include "main.h"
+
+// ==========================================
+// COMPILE-TIME GEOMETRY
+// ==========================================
+
+template <int W, int H>
+struct Geometry {
+  static constexpr int width = W;
+  static constexpr int height = H;
+  static constexpr int pixels = W * H;
+};
+
+// 16.16 fixed-point sample positions of each output coordinate on a source
+// axis, clamped to [LO, SRC - 1 - HI] so the kernel can read LO samples
+// before and HI samples after the base index. With ZOOM > 1 the DST
+// outputs cover (SRC - 1) / ZOOM source pixels and indices are relative to
+// the view origin. nearest is the index of the closer sample.
+template <int SRC, int DST, int LO = 0, int HI = 1, int ZOOM = 1>
+struct AxisMap {
+  static constexpr uint32_t FIXED_SHIFT = 16;
+  static constexpr uint32_t scale_fixed = ((uint32_t)(SRC - 1) << FIXED_SHIFT) / (DST * ZOOM);
+  static_assert(SRC > LO + HI, "source axis too short for kernel footprint");
+
+  uint16_t index[DST];
+  uint16_t nearest[DST];
+  float frac[DST];
+
+  constexpr AxisMap() : index(), nearest(), frac() {
+    for (int i = 0; i < DST; i++) {
+      uint32_t pos = scale_fixed * (uint32_t)i;
+      int i0 = (int)(pos >> FIXED_SHIFT);
+      if (i0 >= SRC - HI) i0 = SRC - HI - 1;
+      if (i0 < LO) i0 = LO;
+      index[i] = (uint16_t)i0;
+      frac[i] = (float)(pos & 0xFFFF) / 65536.0f;
+      nearest[i] = (uint16_t)(i0 + (frac[i] >= 0.5f));
+    }
+  }
+};
+
+using SensorGeom = Geometry<MLX_W, MLX_H>;
+using FrameGeom  = Geometry<FRAME_W, FRAME_H>;
+using FbGeom     = Geometry<FB_WIDTH, FB_HEIGHT>;
@@ -0,0 +1,26 @@
+#pragma once
+#include <stdint.h>
+#include "geometry.h"
+
+// ==========================================
+// HOTSPOT DETECTION + TRACKING
+// ==========================================
+
+struct Hotspot {
+  uint16_t id;        // stable across frames while tracked
+  uint16_t area;      // sensor pixels
+  float peak;
+  float mean;
+  float cx, cy;       // centroid, sensor coordinates
+  uint8_t peakX, peakY;
+  uint8_t missed;     // consecutive frames without a match
+};
+
+// Thresholds the conditioned frame, labels 8-connected components and
+// updates the tracks. Returns the number of tracks visible this frame,
+// sorted by peak temperature (hottest first).
+int detectHotspots(const float *frame, float threshold);
+const Hotspot *hotspots();
+int hotspotCount();
+// Drops all tracks; ids restart at 1
+void resetHotspots();
@@ -0,0 +1,44 @@
+#pragma once
+#include <stdint.h>
+#include "geometry.h"
+
+enum I2cFrameResult {
+  I2C_FRAME_OK = 0,
+  I2C_FRAME_NACK = 1,
+  I2C_FRAME_TIMEOUT = 2,
+  I2C_FRAME_SANITY = 3
+};
+
+struct I2cHealthStats {
+  uint32_t clockHz;
+  uint8_t level;
+  uint16_t frames;
+  uint16_t nacks;
+  uint16_t timeouts;
+  uint16_t sanityFailures;
+  uint16_t corruptFrames;
+  uint32_t corruptPixels;
+  uint32_t lastTransferUs;
+  uint32_t avgTransferUs;
+  uint32_t lastWindowErrors;
+  uint32_t totalErrors;
+  uint32_t clockChanges;
+};
+
+// One per sensor link: with several sensors a dead one only steps down its
+// own clock. Corrupt pixels are counted against one sensor's frame.
+struct I2cHealth {
+  I2cHealthStats stats;
+  uint16_t stepUpBackoff[I2C_CLOCK_LEVEL_COUNT];
+  uint16_t cleanWindows;
+  uint16_t consecutiveErrors;
+  uint64_t windowTransferUs;
+};
+
+void i2cHealthInit(I2cHealth &h, uint32_t startHz);
+I2cFrameResult i2cClassifyFrame(int status, uint32_t transferUs);
+bool i2cHealthRecord(I2cHealth &h, int status, int corruptPixels, uint32_t transferUs);
+
+inline uint32_t i2cHealthClock(const I2cHealth &h) {
+  return h.stats.clockHz;
+}
@@ -0,0 +1,25 @@
+#pragma once
+#include <stdint.h>
+#include "main.h"
+
+// ==========================================
+// HIL FRAME INJECTION (host -> device over serial)
+// ==========================================
+
+// After INJECT_CMD the host sends a recording (recording.h): the header,
+// then one frame (RecordingFrameHeader + pixels) per "inj>" prompt, so the
+// device is always waiting when the bytes arrive and the host sets the
+// pace. The recorded status is replayed as the sensor read status.
+
+#define INJECT_STATUS_TIMEOUT  -100     // host stopped mid-run; ends injection
+
+// Reads and checks the header that follows INJECT_CMD
+bool injectBegin();
+void injectEnd();
+bool injectActive();
+// Stands in for the sensor read: recorded status or INJECT_STATUS_TIMEOUT.
+// Injection ends by itself after the header's frameCount frames.
+int injectReadFrame(float *buf);
+// Frames read so far and the last read's transfer time (prompt + wait + bytes)
+uint32_t injectFrameCount();
+uint32_t injectTransferUs();
@@ -0,0 +1,63 @@
+#pragma once
+#include <stdint.h>
+#include "geometry.h"
+#include "view.h"
+
+// ==========================================
+// ISOTHERM CONTOURS
+// ==========================================
+
+// One contour segment in sensor coordinates, 8.8 fixed point. Ten bytes, so
+// a frame's contours can be streamed or recorded as-is.
+struct IsoSegment {
+  uint16_t x0, y0;
+  uint16_t x1, y1;
+  uint8_t level;
+  uint8_t reserved;
+};
+
+static_assert(sizeof(IsoSegment) == 10, "IsoSegment must stay packed");
+
+// Marching squares over the frame for each level. Returns the number of
+// segments written (stops at maxSegments).
+int extractIsotherms(const float *frame, const float *levels, int levelCount,
+                     IsoSegment *out, int maxSegments);
+
+// ==========================================
+// RASTERISATION (integer Bresenham)
+// ==========================================
+
+template <typename Out>
+inline void drawLineFb(Out *fb, int stride, int x0, int y0, int x1, int y1, Out color) {
+  int dx = x1 > x0 ? x1 - x0 : x0 - x1;
+  int dy = y1 > y0 ? y0 - y1 : y1 - y0;
+  int sx = x0 < x1 ? 1 : -1;
+  int sy = y0 < y1 ? 1 : -1;
+  int err = dx + dy;
+
+  for (;;) {
+    fb[y0 * stride + x0] = color;
+    if (x0 == x1 && y0 == y1) break;
+    int e2 = 2 * err;
+    if (e2 >= dy) { err += dy; x0 += sx; }
+    if (e2 <= dx) { err += dx; y0 += sy; }
+  }
+}
+
+// Segments are mapped through the view; ones with an end outside the
+// window are dropped when zoomed (each spans at most one sensor cell)
+template <typename Src, typename Dst, typename Out>
+void drawIsotherms(const IsoSegment *segs, int count, Out *fb, Out color, const ViewWindow &view = FULL_VIEW) {
+  for (int i = 0; i < count; i++) {
+    const IsoSegment &s = segs[i];
+    int x0, y0, x1, y1;
+    bool in0 = viewToFbFixed<Src, Dst>(view, s.x0, s.y0, x0, y0);
+    bool in1 = viewToFbFixed<Src, Dst>(view, s.x1, s.y1, x1, y1);
+    if (!in0 || !in1) continue;
+    x0 = x0 < Dst::width ? x0 : Dst::width - 1;
+    x1 = x1 < Dst::width ? x1 : Dst::width - 1;
+    y0 = y0 < Dst::height ? y0 : Dst::height - 1;
+    y1 = y1 < Dst::height ? y1 : Dst::height - 1;
+    drawLineFb(fb, Dst::width, x0, y0, x1, y1, color);
+  }
+}
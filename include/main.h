@@ -6,11 +6,74 @@
 
 #define I2C_SDA_PIN         35
 #define I2C_SCL_PIN         34
-#define I2C_FREQ_HZ         1600000UL
+#define I2C_FREQ_HZ         1000000UL
 #define MLX90640_I2C_ADDR   0x33
+#define SENSOR_FPS          16
+
+#define SENSOR_MLX90640     0
+#define SENSOR_MLX90641     1
+#ifndef SENSOR_MODEL
+#define SENSOR_MODEL        SENSOR_MLX90640   // or -DSENSOR_MODEL=SENSOR_MLX90641
+#endif
+
+#if SENSOR_MODEL == SENSOR_MLX90641
+#define MLX_W               16
+#define MLX_H               12
+#else
 #define MLX_W               32
 #define MLX_H               24
-#define SENSOR_FPS          16
+#endif
+
+// ==========================================
+// ADAPTIVE ACQUISITION (refresh rate / ADC resolution)
+// ==========================================
+
+#define ACQ_ADAPTIVE        1
+#define ACQ_LEVELS          { {4, 19}, {8, 18}, {16, 18}, {32, 17} }   // {Hz, ADC bits}, slow -> fast
+#define ACQ_LEVEL_COUNT     4
+#define ACQ_DEFAULT_LEVEL   2       // must match the backend's begin() setting
+#define ACQ_MOTION_RATE     8.0f    // change rate (C/s) that counts a pixel as moving
+#define ACQ_MOTION_MIN_DELTA 0.5f   // smallest per-frame change counted, whatever the interval
+#define ACQ_MOTION_HIGH     0.15f   // moving fraction that jumps to the fastest level
+#define ACQ_MOTION_LOW      0.03f   // moving fraction considered steady
+#define ACQ_MOTION_SMOOTH   0.5f
+#define ACQ_STEADY_FRAMES   16      // steady frames before stepping one level slower
+#define ACQ_MIN_DWELL       4       // frames ignored after a switch (mixed subpages)
+
+// ==========================================
+// MULTI-SENSOR (stitched panorama)
+// ==========================================
+
+#define SENSOR_COUNT        1
+#define SENSOR_I2C_PORTS    { 0, 1 }
+#define SENSOR_I2C_ADDRS    { MLX90640_I2C_ADDR, MLX90640_I2C_ADDR }
+#define I2C1_SDA_PIN        1
+#define I2C1_SCL_PIN        2
+#define STITCH_OVERLAP      4
+#define STITCH_MAX_SKEW_US  (1000000UL / SENSOR_FPS / 2)
+#define STITCH_STALE_US     (4 * 1000000UL / SENSOR_FPS)  // silent sensor is stitched as NaN
+#define SENSOR_TASK_CORE    0
+#define SENSOR_TASK_STACK   8192
+#define SENSOR_TASK_PRIORITY 2
+
+// Conditioned frame geometry (equals MLX_W x MLX_H with a single sensor)
+#define FRAME_W             (SENSOR_COUNT * MLX_W - (SENSOR_COUNT - 1) * STITCH_OVERLAP)
+#define FRAME_H             MLX_H
+
+// ==========================================
+// I2C LINK HEALTH
+// ==========================================
+
+#define I2C_ADAPTIVE_CLOCK        1
+#define I2C_CLOCK_LEVELS          { 400000UL, 800000UL, 1000000UL, 1600000UL }
+#define I2C_CLOCK_LEVEL_COUNT     4
+#define I2C_HEALTH_WINDOW         32
+#define I2C_STEP_DOWN_ERRORS      2
+#define I2C_FAST_FAIL_ERRORS      4
+#define I2C_STEP_UP_WINDOWS       4
+#define I2C_STEP_UP_MAX_WINDOWS   64
+#define I2C_CORRUPT_PIXEL_RATIO   0.02f
+#define I2C_FRAME_TIMEOUT_US      500000UL
 
 // ==========================================
 // DISPLAY CONFIGURATION 
@@ -49,6 +112,13 @@
 #define MENU_WIDTH          72   
 #define MENU_HEIGHT         320
 
+// ==========================================
+// DIGITAL ZOOM (long press cycles, short press pans while zoomed)
+// ==========================================
+
+#define ZOOM_LEVELS         { 1, 2, 4 }
+#define ZOOM_LEVEL_COUNT    3
+
 // ==========================================
 // BUTTON CONFIG
 // ==========================================
@@ -56,7 +126,8 @@
 #define USE_INTERRUPTS 1
 #define BTN_PIN             33
 #define BTN_DEBOUNCE_MS     30
-#define BTN_LONG_PRESS_MS   1500
+#define BTN_LONG_PRESS_MS   1500    // released after this: long press
+#define BTN_HOLD_PRESS_MS   3000    // held this long: hold (burst capture)
 
 // ==========================================
 // COLOR SCHEME
@@ -83,7 +154,8 @@ enum DisplayMode {
   MODE_PAUSED = 1,
   MODE_RGB = 2,
   MODE_CHARGING = 3,
-  MODE_COUNT = 4
+  MODE_MONITOR = 4,
+  MODE_COUNT = 5
 };
 
 // ==========================================
@@ -101,13 +173,45 @@ enum DisplayMode {
 #define FRAME_SMOOTHING     0.7f
 #define TEMP_DISPLAY_SMOOTH 0.80f
 #define TARGET_FPS          32
+#define PARALLEL_RENDER     1
+#define RENDER_WORKER_CORE  0
+#define RENDER_WORKER_STACK 4096
+#define RENDER_WORKER_PRIORITY 1    // below the sensor tasks sharing its core
+
+// Display-rate temporal upsampling (renders at TARGET_FPS between sensor frames)
+#define FRAME_INTERPOLATION 1
+#define INTERP_BLEND        0
+#define INTERP_MOTION       1
+#define INTERP_MODE         INTERP_BLEND
+#define INTERP_BLOCK        8
+#define INTERP_SEARCH       2
+#define ACQUIRE_TASK_STACK  8192
+#define ACQUIRE_TASK_PRIORITY 2
+
+// Frame-budget quality controller (quality.h): steps through the degradation
+// levels while the smoothed per-frame work exceeds what the framebuffer push
+// leaves of 1000 / TARGET_FPS ms and back up once there is headroom again
+#define QUALITY_ADAPTIVE        1
+#define QUALITY_MAX_LEVEL       5       // deepest level used (QUALITY_HALF_RES)
+#define QUALITY_SMOOTH          0.3f    // EMA weight of the newest frame time
+#define QUALITY_DOWN_FRAMES     3       // smoothed frames over budget before degrading
+#define QUALITY_HEADROOM        0.7f    // budget fraction a step up needs to stay under
+#define QUALITY_UP_FRAMES       32      // frames under it before stepping up, doubled per failed step up
+#define QUALITY_MAX_BACKOFF     3
+#define QUALITY_MIN_DWELL       4       // frames ignored after a switch
+#define QUALITY_MIN_WORK_SHARE  0.5f    // budget share kept for render / UI when the push fills the frame
+#define QUALITY_UI_INTERVAL_MS  1000    // legend / menu refresh from QUALITY_SLOW_UI on
 
 // ==========================================
 // MEMORY ALLOCATION
 // ==========================================
 
 #define FRAMEBUFFER_ENABLED 1
-#define USE_DMA_ALLOCATION  1
+#define FB_INDEXED          1       // 8-bit palette indices, expanded to panel format at push time
+#define FB_PUSH_ROWS        4       // rows per SPI transfer buffer in indexed mode
+#define ARENA_ALIGN         16
+#define INTERNAL_RAM_BUDGET (280 * 1024)
+#define PSRAM_BUDGET        (2 * 1024 * 1024)
 
 // ==========================================
 // DISPLAY CONSTANTS
@@ -135,7 +239,7 @@ enum DisplayMode {
 #define LEGEND_PADDING      8
 
 // Menu layout
-#define MENU_ITEM_HEIGHT    80
+#define MENU_ITEM_HEIGHT    (MENU_HEIGHT / MODE_COUNT)
 #define MENU_TEXT_SIZE      1
 #define MENU_ICON_SIZE      2
 
@@ -144,7 +248,12 @@ enum DisplayMode {
 // ==========================================
 
 #define MLX_FRAME_SIZE      834
+#define MLX41_FRAME_SIZE    242
+#define MLX_EEPROM_WORDS    832
+#define MLX_EMISSIVITY      0.95f
+#define MLX_TA_SHIFT        8.0f
 #define FRAME_SMOOTH_COUNT  16
+#define TEMPORAL_FILTER_SIZE 3
 
 // ==========================================
 // TIMING CONSTANTS
@@ -154,7 +263,9 @@ enum DisplayMode {
 #define SETUP_DELAY_MS      500
 #define SENSOR_INIT_DELAY   100
 #define SENSOR_ERROR_WAIT   1000
+#define SENSOR_READY_POLL_MS 1       // sleep between data-ready polls; frees the core for the render worker
 #define STATS_INTERVAL_MS   1200
+#define UI_UPDATE_INTERVAL_MS 100
 #define PAUSE_UPDATE_MS     100
 #define PAUSE_DELAY_MS      50
 #define CHARGING_UPDATE_MS  500
@@ -163,6 +274,109 @@ enum DisplayMode {
 #define MAX_TEMP_RANGE      999.0f
 #define MIN_TEMP_INIT       -999.0f
 
+// ==========================================
+// BOOT
+// ==========================================
+
+#define FAST_BOOT               1
+#define FAST_BOOT_SPLASH_MIN_MS 300
+#define SENSOR_BOOT_TIMEOUT_MS  3000
+#define SENSOR_PROBE_TIMEOUT_MS 100
+#define SENSOR_BOOT_CORE        0
+#define SENSOR_BOOT_STACK       8192
+
+// Extracted calibration parameters cached in NVS, keyed by device ID and
+// validated against a CRC of the first CALIB_PROBE_WORDS EEPROM words
+#define CALIB_CACHE_ENABLED     1
+#define CALIB_CACHE_NAMESPACE   "mlxcal"
+#define CALIB_CACHE_VERSION     1
+#define CALIB_PROBE_WORDS       64
+#define MLX_EEPROM_ADDR         0x2400
+#define MLX_DEVICE_ID_OFFSET    7
+
+// ==========================================
+// EVENT TRACE
+// ==========================================
+
+#define TRACE_ENABLED       1
+#define TRACE_CORES         2
+#define TRACE_RING_SIZE     1024
+#define TRACE_RECORD_BYTES  8
+#define TRACE_DUMP_CMD      't'
+
+// ==========================================
+// DEFERRED LOGGING
+// ==========================================
+
+#define LOG_DEFERRED        1       // 0: format and print at the call site
+#define LOG_DRAIN_BINARY    0       // 1: framed binary records for scripts/log_decode.py
+#define LOG_RING_SIZE       64
+#define LOG_RECORD_BYTES    36
+#define LOG_TASK_CORE       0
+#define LOG_TASK_PRIORITY   1
+#define LOG_TASK_STACK      4096
+#define LOG_DRAIN_PERIOD_MS 20
+
+// ==========================================
+// DISPLAY BUS ACCOUNTING
+// ==========================================
+
+#define BUS_STATS_ENABLED       1
+#define BUS_FRAME_BYTE_BUDGET   0       // bytes per displayed frame, 0 = unchecked
+
+// ==========================================
+// HOTSPOTS (sensor-resolution blob tracking)
+// ==========================================
+
+#define HOTSPOT_ENABLED     1
+#define HOTSPOT_LEVEL       0.75f   // threshold as fraction of display range
+#define HOTSPOT_MIN_AREA    2       // sensor pixels
+#define HOTSPOT_MAX_BLOBS   16
+#define HOTSPOT_TOP_N       3
+#define HOTSPOT_TRACK_DIST  3.0f    // max centroid jump between frames (sensor px)
+#define HOTSPOT_MAX_AGE     4       // frames a lost track is kept
+#define HOTSPOT_MARKER_R    8
+
+// ==========================================
+// MONITORING (long-duration per-pixel statistics)
+// ==========================================
+
+#define MONITOR_ENABLED           1
+#define MONITOR_ALARM_C           60.0f     // exceedance threshold (deg C)
+#define MONITOR_STATS_WINDOW      4096      // frames of exact Welford before the weight is held
+#define MONITOR_SNAPSHOT_MS       60000UL
+#define MONITOR_SNAPSHOT_COUNT    64        // ring of decimated snapshots (oldest overwritten)
+#define MONITOR_SNAPSHOT_COUNT_NO_PSRAM 16  // ring when the PSRAM arena falls back to internal SRAM
+#define MONITOR_SNAPSHOT_DECIMATE 2
+#define MONITOR_DUMP_CMD          'm'
+#define MONITOR_RESET_CMD         'r'
+
+// ==========================================
+// BURST CAPTURE (hold: raw subpages at full sensor rate)
+// ==========================================
+
+// Rendering and UI stop while capturing; the ring keeps the newest
+// subpages until the next press ends the burst. Needs the PSRAM arena: in
+// internal SRAM the ring would cover a few hundred ms, so without PSRAM at
+// runtime it has no fallback slot and a hold only cycles the zoom.
+#define BURST_ENABLED             1
+#define BURST_REFRESH_HZ          64        // subpages per second
+#define BURST_ADC_BITS            18
+#define BURST_SAMPLES             256       // 4 s at 64 Hz
+#define BURST_EXPORT_CMD          'b'
+#define MLX_RAW_WORDS             (SENSOR_MODEL == SENSOR_MLX90641 ? MLX41_FRAME_SIZE : MLX_FRAME_SIZE)
+
+// ==========================================
+// HIL FRAME INJECTION (scripts/inject_frames.py)
+// ==========================================
+
+// Serial INJECT_CMD makes a recording streamed by the host the frame source
+// instead of the sensor; every injected frame is reported with timings and
+// CRCs of the rendered frame and the framebuffer
+#define INJECT_ENABLED            1
+#define INJECT_CMD                'i'
+#define INJECT_TIMEOUT_MS         2000      // host silent this long ends the run
+
 // ==========================================
 // UI TEXT RENDERING
 // ==========================================
@@ -178,4 +392,18 @@ enum DisplayMode {
 #define UI_CURSOR_Y              50
 #define EDGE_DETECTION_ENABLED true
 #define EDGE_THRESHOLD 0.2f
-#define EDGE_WIDTH 2
\ No newline at end of file
+#define EDGE_WIDTH 2
+
+// Foveated render: bicubic interpolation and the edge overlay only in tiles
+// within FOVEA_RADIUS of the max marker or the image centre, plain bilinear
+// without edges elsewhere
+#define FOVEATED_RENDER         1
+#define FOVEA_TILE              16      // px, multiple of 8
+#define FOVEA_RADIUS            64      // px
+
+// Isotherm contours (marching squares at sensor resolution); replaces the
+// Sobel edge overlay when enabled
+#define ISOTHERM_ENABLED        0
+#define ISOTHERM_LEVELS         { 30.0f, 40.0f, 60.0f }   // deg C
+#define ISOTHERM_LEVEL_COUNT    3
+#define ISOTHERM_MAX_SEGMENTS   512
\ No newline at end of file
@@ -0,0 +1,29 @@
+#pragma once
+#include <Wire.h>
+
+// ==========================================
+// MELEXIS I2C TRANSPORT ON TOP OF Wire
+// ==========================================
+
+// Shared by the MLX90640 and MLX90641 I2C drivers (MLX9064x_I2C* in the
+// backends). The Melexis API only hands a 7-bit slave address to the
+// driver, so bit 7 of that address selects Wire1; sensors on both
+// controllers can then be read concurrently.
+static const uint8_t MLX_WIRE_PORT1 = 0x80;
+
+inline uint8_t mlxWireAddress(uint8_t addr, TwoWire *wire) {
+  return wire == &Wire1 ? (addr | MLX_WIRE_PORT1) : addr;
+}
+
+int mlxWireRead(uint8_t slaveAddr, uint16_t startAddress, uint16_t words, uint16_t *data);
+int mlxWireWrite(uint8_t slaveAddr, uint16_t writeAddress, uint16_t data);
+
+// Sleeps SENSOR_READY_POLL_MS between status register polls until a new
+// subpage is ready: the Melexis GetFrameData() polls the bus back to back
+// and would hold the core against every lower-priority task on it. Returns
+// -1 on a bus error or after SENSOR_ERROR_WAIT ms.
+int mlxWireWaitReady(uint8_t slaveAddr);
+
+// General call reset and bus clock (kHz) of controller 0
+int mlxWireGeneralReset();
+void mlxWireFreqSet(int freq);
@@ -0,0 +1,66 @@
+#pragma once
+#include <stdint.h>
+#include "arena.h"
+#include "geometry.h"
+
+// ==========================================
+// LONG-DURATION MONITORING (per-pixel statistics)
+// ==========================================
+
+// Fixed point: temperatures in 1/100 C (int16), running mean in 1/65536 C
+// and variance in 1/4096 C^2 (int32). Welford's update runs exactly for the
+// first MONITOR_STATS_WINDOW frames; after that the weight stays at
+// 1 / MONITOR_STATS_WINDOW so a long run keeps resolving slow drifts instead
+// of freezing the mean at integer precision.
+#define MONITOR_TEMP_SCALE  100
+#define MONITOR_MEAN_SHIFT  16
+#define MONITOR_VAR_SHIFT   12
+
+// Decimated to MONITOR_SNAPSHOT_DECIMATE x MONITOR_SNAPSHOT_DECIMATE cells:
+// hottest max-hold and average running mean of each cell
+struct MonitorSnapshot {
+  uint32_t timeMs;
+  uint32_t frames;
+  int16_t maxC[MONITOR_CELLS];
+  int16_t meanC[MONITOR_CELLS];
+};
+
+static_assert(sizeof(MonitorSnapshot) == MONITOR_SNAPSHOT_BYTES, "MONITOR_SNAPSHOT_BYTES out of sync");
+
+// One instance per sensor stream (device: main.cpp, host: per recording).
+// Memory is fixed at init; a run of any length only overwrites it.
+struct Monitor {
+  int16_t *minC;
+  int16_t *maxC;
+  int16_t *baselineC;
+  int32_t *mean;
+  int32_t *var;
+  int32_t *exceed;        // frames at or above MONITOR_ALARM_C
+  uint32_t frames;
+  uint32_t startMs;
+  uint32_t lastSnapshotMs;
+  MonitorSnapshot *snapshots;
+  int snapshotCapacity;
+  int snapshotHead;       // next slot to write
+  int snapshotCount;
+};
+
+enum MonitorView {
+  MONITOR_VIEW_MAX_HOLD = 0,
+  MONITOR_VIEW_DELTA = 1,
+  MONITOR_VIEW_COUNT = 2
+};
+
+// stats holds MONITOR_STATS_BYTES, snapshots snapshotCapacity entries
+void initMonitor(Monitor &m, void *stats, MonitorSnapshot *snapshots, int snapshotCapacity);
+// Forget everything; the next frame becomes the baseline
+void monitorReset(Monitor &m);
+// Feed every conditioned sensor frame; O(pixels), no allocation
+void monitorUpdate(Monitor &m, const float *frame, uint32_t nowMs);
+// View as a temperature frame for the regular render path. live is only
+// read by MONITOR_VIEW_DELTA.
+void monitorRenderView(const Monitor &m, MonitorView view, const float *live, float *out);
+// k = 0 is the oldest snapshot still kept
+const MonitorSnapshot &monitorSnapshot(const Monitor &m, int k);
+float monitorStdDev(const Monitor &m, int i);
+const char *monitorViewName(MonitorView view);
@@ -0,0 +1,22 @@
+#pragma once
+#include <stdint.h>
+#include "main.h"
+
+// ==========================================
+// PALETTES (RGB565, COLOR_LUT_SIZE entries)
+// ==========================================
+
+// Temperatures map to 0 .. PALETTE_TOP_INDEX; the last entry of every
+// palette is the overlay colour (edges, isotherms), so an indexed frame can
+// be pushed with another palette and its overlay stays as rendered
+#define PALETTE_TOP_INDEX     (COLOR_LUT_SIZE - 2)
+#define PALETTE_OVERLAY_INDEX (COLOR_LUT_SIZE - 1)
+#define PALETTE_OVERLAY_COLOR 0xFFFF
+
+enum PaletteId {
+  PALETTE_IRON = 0,     // MODE_LIVE
+  PALETTE_RAINBOW = 1,  // MODE_RGB
+  PALETTE_COUNT = 2
+};
+
+void buildPalette(PaletteId id, uint16_t *lut);
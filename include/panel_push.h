@@ -0,0 +1,38 @@
+#pragma once
+#include <stdint.h>
+#include "arena.h"
+
+// ==========================================
+// INDEXED FRAMEBUFFER STREAMING
+// ==========================================
+
+// RGB565 to the three bytes the 18-bit panel takes (same expansion as
+// Arduino_ILI9488_18bit::draw16bitRGBBitmap)
+inline void expandPanelColor(uint16_t c, uint8_t *out) {
+  out[0] = (c & 0xF800) >> 8;
+  out[1] = (c & 0x07E0) >> 3;
+  out[2] = (uint8_t)(c << 3);
+}
+
+// Expands palette indices to panel pixels FB_PUSH_ROWS rows at a time and
+// sends each chunk with one writeBytes. The caller owns the transaction and
+// the address window. Bus is Arduino_DataBus on the device and the
+// recording bus in host tools, so both measure the same traffic.
+template <typename Bus>
+void streamIndexedRows(Bus &bus, const uint8_t *fb, const uint8_t (*palette)[PANEL_PIXEL_BYTES],
+                       uint8_t *lines) {
+  for (int y = 0; y < FB_HEIGHT; y += FB_PUSH_ROWS) {
+    const int rows = (FB_HEIGHT - y) < FB_PUSH_ROWS ? (FB_HEIGHT - y) : FB_PUSH_ROWS;
+    const uint8_t *src = &fb[y * FB_WIDTH];
+    uint8_t *dst = lines;
+
+    for (int i = 0; i < rows * FB_WIDTH; i++) {
+      const uint8_t *c = palette[src[i]];
+      dst[0] = c[0];
+      dst[1] = c[1];
+      dst[2] = c[2];
+      dst += PANEL_PIXEL_BYTES;
+    }
+    bus.writeBytes(lines, rows * FB_WIDTH * PANEL_PIXEL_BYTES);
+  }
+}
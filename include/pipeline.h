@@ -0,0 +1,179 @@
+#pragma once
+#include <string.h>
+#include "geometry.h"
+#include "simd.h"
+#include "stage_graph.h"
+
+// ==========================================
+// FRAME STATISTICS
+// ==========================================
+
+// Frame min/max over plausible temperatures (-40..300 C, NaN excluded), and
+// the auto-gain display range derived from it: widened to MIN_TEMP_RANGE
+// and capped at 100 C. Lanes keep their own extremes and are folded at the
+// end; min/max are order independent so every backend gives the same result.
+struct RangeStage {
+  static constexpr size_t bufferBytes = 0;
+  float frameMin = MAX_TEMP_RANGE;
+  float frameMax = MIN_TEMP_INIT;
+  float tMin = 0.0f;
+  float tMax = 0.0f;
+
+  void bind(uint8_t *) {}
+
+  template <typename V>
+  struct Pass {
+    using F = typename V::F;
+    using M = typename V::M;
+    RangeStage &s;
+    const F lo, hi;
+    F vMin, vMax;
+
+    explicit Pass(RangeStage &stage)
+        : s(stage), lo(V::splat(-40.0f)), hi(V::splat(300.0f)),
+          vMin(V::splat(MAX_TEMP_RANGE)), vMax(V::splat(MIN_TEMP_INIT)) {}
+
+    F apply(F t, int) {
+      M valid = V::both(V::ge(t, lo), V::le(t, hi));
+      vMin = V::select(V::both(valid, V::lt(t, vMin)), t, vMin);
+      vMax = V::select(V::both(valid, V::gt(t, vMax)), t, vMax);
+      return t;
+    }
+
+    void finish() {
+      s.frameMin = MAX_TEMP_RANGE;
+      s.frameMax = MIN_TEMP_INIT;
+      for (int l = 0; l < 4; l++) {
+        if (V::lane(vMin, l) < s.frameMin) s.frameMin = V::lane(vMin, l);
+        if (V::lane(vMax, l) > s.frameMax) s.frameMax = V::lane(vMax, l);
+      }
+
+      s.tMin = s.frameMin;
+      s.tMax = s.frameMax;
+      if (s.tMax - s.tMin < MIN_TEMP_RANGE) {
+        s.tMax = s.tMin + MIN_TEMP_RANGE;
+      }
+      if (s.tMax - s.tMin > 100.0f) {
+        float center = (s.tMin + s.tMax) / 2.0f;
+        s.tMin = center - 50.0f;
+        s.tMax = center + 50.0f;
+      }
+    }
+  };
+};
+
+// ==========================================
+// TEMPORAL SMOOTHING
+// ==========================================
+
+// EMA over the frames the graph sees; the state is the smoothed frame, which
+// is also what later stages receive. With FAST_BOOT the first frame seeds
+// the average instead of fading in from zero.
+template <typename G>
+struct EmaStage {
+  static constexpr size_t bufferBytes = G::pixels * sizeof(float);
+  float *smoothed = nullptr;
+  bool seeded = false;
+
+  void bind(uint8_t *buffer) {
+    smoothed = reinterpret_cast<float *>(buffer);
+    memset(smoothed, 0, bufferBytes);
+    seeded = false;
+  }
+
+  template <typename V>
+  struct Pass {
+    using F = typename V::F;
+    EmaStage &s;
+    const F va, vb;
+    const bool seed;
+
+    explicit Pass(EmaStage &stage)
+        : s(stage), va(V::splat(FRAME_SMOOTHING)), vb(V::splat(1.0f - FRAME_SMOOTHING)),
+          seed(FAST_BOOT && !stage.seeded) {}
+
+    F apply(F x, int i) {
+      F prev = seed ? x : V::load(&s.smoothed[i]);
+      F out = V::add(V::mul(prev, va), V::mul(x, vb));
+      V::store(&s.smoothed[i], out);
+      return out;
+    }
+
+    void finish() { s.seeded = true; }
+  };
+};
+
+// ==========================================
+// PIPELINES
+// ==========================================
+
+// With FRAME_INTERPOLATION the display range is taken on the synthesized
+// display frame, so smoothing and range run as separate graphs; otherwise
+// ConditionPipeline does both in a single pass over the conditioned frame.
+using SmoothingPipeline = StageGraph<FrameGeom, EmaStage<FrameGeom>>;
+using RangePipeline = StageGraph<FrameGeom, RangeStage>;
+using ConditionPipeline = StageGraph<FrameGeom, EmaStage<FrameGeom>, RangeStage>;
+
+// Single-kernel entry points, kept for the backend comparison in the batch tool
+template <typename G, typename V = Simd>
+inline void findMinMaxOptimized(const float *buf, float &tMin, float &tMax) {
+  StageGraph<G, RangeStage> graph;
+  graph.template run<V>(buf);
+  tMin = graph.template stage<0>().frameMin;
+  tMax = graph.template stage<0>().frameMax;
+}
+
+template <typename G, typename V = Simd>
+inline void applySmoothingOptimized(float *smoothed, const float *raw) {
+  StageGraph<G, EmaStage<G>> graph;
+  graph.template stage<0>().smoothed = smoothed;
+  graph.template stage<0>().seeded = true;
+  graph.template run<V>(raw);
+}
+
+// ==========================================
+// TEMPORAL MEDIAN
+// ==========================================
+
+// Median of three with the comparison order of the scalar decision tree, so
+// NaN inputs resolve to the same lane as before; selects instead of branches.
+template <typename V>
+inline typename V::F median3(typename V::F a, typename V::F b, typename V::F c) {
+  typename V::M ab = V::gt(a, b);
+  typename V::M bc = V::gt(b, c);
+  typename V::M ac = V::gt(a, c);
+  typename V::F whenAB = V::select(bc, b, V::select(ac, c, a));
+  typename V::F otherwise = V::select(ac, a, V::select(bc, c, b));
+  return V::select(ab, whenAB, otherwise);
+}
+
+// Positive finite floats order like their bit patterns, so their median is
+// min / max on integer lanes (PIE with SIMD_BACKEND=SIMD_PIE). False, with out untouched,
+// when a lane is zero, negative, infinite or NaN: ties of -0 and +0 and NaN
+// would not resolve as in median3.
+template <typename V>
+inline bool median3Bits(const float *a, const float *b, const float *c, float *out) {
+  using W = typename V::W;
+  const W wa = V::bitsW(a), wb = V::bitsW(b), wc = V::bitsW(c);
+  const W lo = V::minW(wa, wb), hi = V::maxW(wa, wb);
+  const W least = V::minW(lo, wc), most = V::maxW(hi, wc);
+  for (int l = 0; l < 4; l++) {
+    if (V::laneW(least, l) <= 0 || V::laneW(most, l) >= 0x7F800000) return false;
+  }
+  V::storeBitsW(out, V::maxW(lo, V::minW(hi, wc)));
+  return true;
+}
+
+template <typename G, typename V = Simd>
+inline void medianOf3Frames(const float *a, const float *b, const float *c, float *out) {
+  int i = 0;
+  for (; i + 4 <= G::pixels; i += 4) {
+    if (median3Bits<V>(&a[i], &b[i], &c[i], &out[i])) continue;
+    V::store(&out[i], median3<V>(V::load(&a[i]), V::load(&b[i]), V::load(&c[i])));
+  }
+  for (; i < G::pixels; i++) {
+    SimdScalar::F m = median3<SimdScalar>(SimdScalar::splat(a[i]), SimdScalar::splat(b[i]),
+                                          SimdScalar::splat(c[i]));
+    out[i] = m.v[0];
+  }
+}
@@ -0,0 +1,80 @@
+#pragma once
+#include <stdint.h>
+#include "main.h"
+#include "render.h"
+
+// ==========================================
+// FRAME-BUDGET QUALITY CONTROLLER
+// ==========================================
+
+// Degradation levels, cheapest last; each keeps the savings of the ones
+// before it
+enum QualityLevel {
+  QUALITY_FULL = 0,
+  QUALITY_SLOW_UI = 1,      // legend / menu every QUALITY_UI_INTERVAL_MS
+  QUALITY_NO_EDGES = 2,
+  QUALITY_BILINEAR = 3,     // no bicubic fovea
+  QUALITY_NEAREST = 4,
+  QUALITY_HALF_RES = 5,
+  QUALITY_LEVEL_COUNT = 6
+};
+
+static_assert(QUALITY_MAX_LEVEL < QUALITY_LEVEL_COUNT, "QUALITY_MAX_LEVEL out of range");
+
+// One instance per display loop (device: main.cpp, host: batch --quality-trace)
+struct QualityController {
+  int level;
+  float frameMs;          // smoothed reducible work per displayed frame
+  float pushMs;           // smoothed framebuffer push, which no level shrinks
+  int overFrames;         // consecutive frames over budget
+  int underFrames;        // consecutive frames under QUALITY_HEADROOM of it
+  int dwell;
+  int levelFrames;        // frames since the last switch
+  int backoff;            // doublings of QUALITY_UP_FRAMES
+  bool steppedUp;         // the last switch was a step up
+};
+
+struct QualityDecision {
+  bool changed;
+  int from;
+  int to;
+  float frameMs;
+  float budgetMs;         // what frameMs was held against
+};
+
+void initQuality(QualityController &q, int level = QUALITY_FULL);
+// Feed every displayed frame: frameMs is the work the levels can reduce
+// (render, overlays, UI), pushMs the framebuffer push, which every level
+// pays in full. A change applies from the next frame on. A step up that has
+// to be undone within QUALITY_UP_FRAMES doubles the wait before the next
+// one, so a load that sits right at a level boundary does not flip between
+// the two.
+QualityDecision qualityUpdate(QualityController &q, float frameMs, float pushMs = 0.0f);
+const char *qualityLevelName(int level);
+
+inline float qualityBudgetMs() {
+  return 1000.0f / TARGET_FPS;
+}
+
+// Budget left for the reducible work after the push. A push that alone
+// fills the frame (slow panel bus) leaves QUALITY_MIN_WORK_SHARE of it, so
+// the controller does not sink to the last level for a cost it cannot cut.
+inline float qualityWorkBudgetMs(float pushMs) {
+  const float left = qualityBudgetMs() - pushMs;
+  const float floor = qualityBudgetMs() * QUALITY_MIN_WORK_SHARE;
+  return left > floor ? left : floor;
+}
+
+// What the render path keeps at a level
+inline bool qualityEdges(int level) {
+  return level < QUALITY_NO_EDGES;
+}
+
+inline bool qualityFovea(int level) {
+  return level < QUALITY_BILINEAR;
+}
+
+inline RenderFilter qualityFilter(int level) {
+  if (level >= QUALITY_HALF_RES) return FILTER_NEAREST_HALF;
+  return level >= QUALITY_NEAREST ? FILTER_NEAREST : FILTER_BILINEAR;
+}
@@ -0,0 +1,37 @@
+#pragma once
+#include <stdint.h>
+
+// ==========================================
+// RADIOMETRIC RECORDING FORMAT
+// ==========================================
+
+// Little-endian, no padding:
+//   RecordingHeader
+//   per frame: RecordingFrameHeader + width * height float32 (deg C, row-major)
+// frameCount 0 means "until end of file" (recording was not finalised).
+// status is the sensor read status for that frame (0 = ok), so read errors
+// replay exactly as the device saw them.
+
+#define RECORDING_MAGIC   0x31465254UL   // "TRF1"
+#define RECORDING_VERSION 1
+
+struct RecordingHeader {
+  uint32_t magic;
+  uint16_t version;
+  uint16_t reserved;
+  uint16_t width;
+  uint16_t height;
+  uint32_t frameCount;
+};
+
+struct RecordingFrameHeader {
+  uint32_t timestampUs;
+  int32_t status;
+};
+
+static_assert(sizeof(RecordingHeader) == 16, "RecordingHeader layout");
+static_assert(sizeof(RecordingFrameHeader) == 8, "RecordingFrameHeader layout");
+
+inline uint32_t recordingFrameBytes(uint16_t width, uint16_t height) {
+  return sizeof(RecordingFrameHeader) + (uint32_t)width * height * sizeof(float);
+}
@@ -0,0 +1,471 @@
+#pragma once
+#include <math.h>
+#include <string.h>
+#include "geometry.h"
+#include "palette.h"
+#include "simd.h"
+#include "view.h"
+
+// ==========================================
+// FRAMEBUFFER PIXEL FORMAT
+// ==========================================
+
+// Indexed: the framebuffer holds palette indices and the palette is applied
+// while the panel transfer buffers are filled. Edge pixels use the reserved
+// PALETTE_OVERLAY_INDEX, which holds PALETTE_OVERLAY_COLOR in every palette,
+// so both formats show identical images.
+#if FB_INDEXED
+typedef uint8_t FbPixel;
+#else
+typedef uint16_t FbPixel;
+#endif
+
+#define EDGE_PALETTE_INDEX PALETTE_OVERLAY_INDEX
+
+// ==========================================
+// FAST COLOR LOOKUP
+// ==========================================
+
+inline int tempToIndexFast(float t, float tMin, float tMax) {
+  if (!AUTO_SCALE) {
+    tMin = TEMP_MIN_CLAMP;
+    tMax = TEMP_MAX_CLAMP;
+  }
+
+  t = t < tMin ? tMin : (t > tMax ? tMax : t);
+  float range = tMax - tMin;
+  if (range < MIN_RANGE_DEFAULT) range = MIN_RANGE_DEFAULT;
+  float n = (t - tMin) / range;
+  
+  int idx = (int)(n * PALETTE_TOP_INDEX);
+  return idx < 0 ? 0 : (idx > PALETTE_TOP_INDEX ? PALETTE_TOP_INDEX : idx);
+}
+
+// ==========================================
+// SCALE TABLES
+// ==========================================
+
+template <typename Src, typename Dst, int ZOOM = 1>
+struct ScaleMaps {
+  static constexpr AxisMap<Src::width, Dst::width, 0, 1, ZOOM> x{};
+  static constexpr AxisMap<Src::height, Dst::height, 0, 1, ZOOM> y{};
+};
+
+struct AxisRef {
+  const uint16_t *index;
+  const uint16_t *nearest;
+  const float *frac;
+  int origin;
+};
+
+// Tables of the view's zoom level (one compile-time pair per level), with
+// the pan origin to add to every index. The last level also takes any
+// out-of-range index, so the references are always set.
+template <typename Src, typename Dst, int L = 0>
+inline void viewAxes(const ViewWindow &v, AxisRef &x, AxisRef &y) {
+  if constexpr (L < ZOOM_LEVEL_COUNT) {
+    if (v.level == L || L == ZOOM_LEVEL_COUNT - 1) {
+      using Maps = ScaleMaps<Src, Dst, ZOOM_FACTORS[L]>;
+      x = {Maps::x.index, Maps::x.nearest, Maps::x.frac, v.originX};
+      y = {Maps::y.index, Maps::y.nearest, Maps::y.frac, v.originY};
+      return;
+    }
+    viewAxes<Src, Dst, L + 1>(v, x, y);
+  }
+}
+
+// Sobel footprint needs one sample before and two after the base index
+template <int SRC>
+inline int sobelBase(int i) {
+  return i < 1 ? 1 : (i > SRC - 3 ? SRC - 3 : i);
+}
+
+// Eight entries of an axis table plus the pan origin, clamped to [lo, hi]
+// (integer lanes, so PIE with SIMD_BACKEND=SIMD_PIE)
+template <typename V>
+inline void mapAxisLanes(const uint16_t *table, int origin, int lo, int hi, int16_t *out) {
+  typename V::H i = V::addH(V::loadH(table), V::splatH((int16_t)origin));
+  V::storeH(out, V::minH(V::maxH(i, V::splatH((int16_t)lo)), V::splatH((int16_t)hi)));
+}
+
+// ==========================================
+// FOVEA (tiles rendered at full quality)
+// ==========================================
+
+// Tile flags: fovea tiles next to a periphery tile ramp from bilinear at
+// that side to bicubic across the tile, so the kernels meet without a step
+enum FoveaTile : uint8_t {
+  FOVEA_NONE = 0,
+  FOVEA_INNER = 1,
+  FOVEA_RAMP_LEFT = 2,
+  FOVEA_RAMP_RIGHT = 4,
+  FOVEA_RAMP_TOP = 8,
+  FOVEA_RAMP_BOTTOM = 16
+};
+
+template <typename Dst>
+struct FoveaMap {
+  static constexpr int tilesX = Dst::width / FOVEA_TILE;
+  static constexpr int tilesY = (Dst::height + FOVEA_TILE - 1) / FOVEA_TILE;
+  static_assert(Dst::width % FOVEA_TILE == 0 && FOVEA_TILE % 8 == 0,
+                "fovea tiles must split rows into whole edge-mask bytes");
+
+  uint8_t tiles[tilesY][tilesX];
+  int tileCount;
+  int pixels;
+};
+
+// Tiles touching a disc of FOVEA_RADIUS around any focus (framebuffer
+// coordinates). The area depends only on where the foci are, so the
+// full-quality cost per frame is bounded by focusCount discs.
+template <typename Dst>
+void buildFoveaMap(FoveaMap<Dst> &map, const int *focusX, const int *focusY, int focusCount) {
+  constexpr int r2 = FOVEA_RADIUS * FOVEA_RADIUS;
+  map.tileCount = 0;
+  map.pixels = 0;
+
+  for (int ty = 0; ty < map.tilesY; ty++) {
+    const int y0 = ty * FOVEA_TILE;
+    const int y1 = (y0 + FOVEA_TILE < Dst::height ? y0 + FOVEA_TILE : Dst::height) - 1;
+    for (int tx = 0; tx < map.tilesX; tx++) {
+      const int x0 = tx * FOVEA_TILE;
+      const int x1 = x0 + FOVEA_TILE - 1;
+      bool hit = false;
+      for (int f = 0; f < focusCount && !hit; f++) {
+        int cx = focusX[f] < x0 ? x0 : (focusX[f] > x1 ? x1 : focusX[f]);
+        int cy = focusY[f] < y0 ? y0 : (focusY[f] > y1 ? y1 : focusY[f]);
+        int dx = focusX[f] - cx;
+        int dy = focusY[f] - cy;
+        hit = dx * dx + dy * dy <= r2;
+      }
+      map.tiles[ty][tx] = hit ? FOVEA_INNER : FOVEA_NONE;
+      if (hit) {
+        map.tileCount++;
+        map.pixels += FOVEA_TILE * (y1 - y0 + 1);
+      }
+    }
+  }
+
+  // Image borders count as fovea so the ramp only faces the periphery
+  for (int ty = 0; ty < map.tilesY; ty++) {
+    for (int tx = 0; tx < map.tilesX; tx++) {
+      uint8_t &t = map.tiles[ty][tx];
+      if (!t) continue;
+      if (tx > 0 && !map.tiles[ty][tx - 1]) t |= FOVEA_RAMP_LEFT;
+      if (tx < map.tilesX - 1 && !map.tiles[ty][tx + 1]) t |= FOVEA_RAMP_RIGHT;
+      if (ty > 0 && !map.tiles[ty - 1][tx]) t |= FOVEA_RAMP_TOP;
+      if (ty < map.tilesY - 1 && !map.tiles[ty + 1][tx]) t |= FOVEA_RAMP_BOTTOM;
+    }
+  }
+}
+
+// Bicubic share of four pixels starting at (x, y) in a ramped tile
+inline void foveaRamp(uint8_t tile, int x, int y, float w[4]) {
+  constexpr float step = 1.0f / FOVEA_TILE;
+  const int iy = y % FOVEA_TILE;
+  float wy = 1.0f;
+  if (tile & FOVEA_RAMP_TOP) wy = (iy + 0.5f) * step;
+  if ((tile & FOVEA_RAMP_BOTTOM) && (FOVEA_TILE - iy - 0.5f) * step < wy) wy = (FOVEA_TILE - iy - 0.5f) * step;
+
+  for (int l = 0; l < 4; l++) {
+    const int ix = (x + l) % FOVEA_TILE;
+    float wl = wy;
+    if ((tile & FOVEA_RAMP_LEFT) && (ix + 0.5f) * step < wl) wl = (ix + 0.5f) * step;
+    if ((tile & FOVEA_RAMP_RIGHT) && (FOVEA_TILE - ix - 0.5f) * step < wl) wl = (FOVEA_TILE - ix - 0.5f) * step;
+    w[l] = wl;
+  }
+}
+
+// Catmull-Rom weights for taps at -1, 0, +1, +2
+inline void cubicWeights(float t, float w[4]) {
+  const float t2 = t * t;
+  const float t3 = t2 * t;
+  w[0] = 0.5f * (-t3 + 2.0f * t2 - t);
+  w[1] = 0.5f * (3.0f * t3 - 5.0f * t2 + 2.0f);
+  w[2] = 0.5f * (-3.0f * t3 + 4.0f * t2 + t);
+  w[3] = 0.5f * (t3 - t2);
+}
+
+// ==========================================
+// EDGE MASK (Sobel on the interpolated field)
+// ==========================================
+
+// Rows are cleared and written independently, so disjoint row ranges can be
+// computed concurrently as long as each row starts on a byte boundary.
+// Eight pixels (one mask byte) per step: the base indices come from the
+// integer lanes of V, the gradients stay scalar float.
+template <typename Src, typename Dst, typename V = Simd>
+void calculateEdgeMaskRows(const float *tempBuf, uint8_t *edgeMask, int yBegin, int yEnd,
+                           const ViewWindow &view = FULL_VIEW, const FoveaMap<Dst> *fovea = nullptr) {
+  AxisRef ax, ay;
+  viewAxes<Src, Dst>(view, ax, ay);
+  static_assert(Dst::width % 8 == 0, "edge mask rows must be byte aligned");
+  constexpr float edgeThresholdSq = (EDGE_THRESHOLD * 8.0f) * (EDGE_THRESHOLD * 8.0f);
+  
+  memset(&edgeMask[yBegin * Dst::width / 8], 0, (yEnd - yBegin) * Dst::width / 8);
+  
+  const int yFirst = yBegin < 1 ? 1 : yBegin;
+  const int yLast = yEnd > Dst::height - 1 ? Dst::height - 1 : yEnd;
+  
+  for (int y = yFirst; y < yLast; y++) {
+    const int y0 = sobelBase<Src::height>(ay.origin + ay.index[y]);
+    
+    const float *row_m1 = &tempBuf[(y0 - 1) * Src::width];
+    const float *row_0 = &tempBuf[y0 * Src::width];
+    const float *row_p1 = &tempBuf[(y0 + 1) * Src::width];
+    
+    const int rowOffset = y * Dst::width;
+    const uint8_t *foveaRow = fovea ? fovea->tiles[y / FOVEA_TILE] : nullptr;
+    
+    for (int x8 = 0; x8 < Dst::width; x8 += 8) {
+      if (foveaRow && !foveaRow[x8 / FOVEA_TILE]) continue;
+      alignas(16) int16_t bases[8];
+      mapAxisLanes<V>(&ax.index[x8], ax.origin, 1, Src::width - 3, bases);
+      uint8_t bits = 0;
+
+      for (int l = 0; l < 8; l++) {
+        const int x = x8 + l;
+        if (x < 1 || x >= Dst::width - 1) continue;
+        const int x0 = bases[l];
+        const float fx = ax.frac[x];
+        
+        float tl = row_m1[x0] + (row_m1[x0 + 1] - row_m1[x0]) * fx;
+        float tc = row_m1[x0] + (row_m1[x0 + 1] - row_m1[x0]) * fx;
+        float tr = row_m1[x0 + 1] + (row_m1[x0 + 2] - row_m1[x0 + 1]) * fx;
+        
+        float ml = row_0[x0 - 1] + (row_0[x0] - row_0[x0 - 1]) * fx;
+        float mr = row_0[x0 + 1] + (row_0[x0 + 2] - row_0[x0 + 1]) * fx;
+        
+        float bl = row_p1[x0] + (row_p1[x0 + 1] - row_p1[x0]) * fx;
+        float bc = row_p1[x0] + (row_p1[x0 + 1] - row_p1[x0]) * fx;
+        float br = row_p1[x0 + 1] + (row_p1[x0 + 2] - row_p1[x0 + 1]) * fx;
+        
+        float gx = -tl + tr - 2.0f * ml + 2.0f * mr - bl + br;
+        float gy = -tl - 2.0f * tc - tr + bl + 2.0f * bc + br;
+        
+        if (gx * gx + gy * gy > edgeThresholdSq) bits |= (uint8_t)(1 << l);
+      }
+      edgeMask[(rowOffset + x8) >> 3] = bits;
+    }
+  }
+}
+
+template <typename Src, typename Dst>
+void calculateEdgeMask(const float *tempBuf, uint8_t *edgeMask, const ViewWindow &view = FULL_VIEW,
+                       const FoveaMap<Dst> *fovea = nullptr) {
+  calculateEdgeMaskRows<Src, Dst>(tempBuf, edgeMask, 0, Dst::height, view, fovea);
+}
+
+// ==========================================
+// BILINEAR UPSCALE + COLOR MAP
+// ==========================================
+
+// Periphery kernel (fovea tiles stay bicubic). The cheaper ones serve the
+// quality controller (quality.h) when frames run over budget.
+enum RenderFilter : uint8_t {
+  FILTER_BILINEAR = 0,
+  FILTER_NEAREST = 1,
+  FILTER_NEAREST_HALF = 2     // nearest on 2x2 output blocks
+};
+
+// Four temperatures to colours (or palette indices), edge pixels overridden
+template <typename V, typename Out>
+inline void storeColorLanes(typename V::F t, typename V::F vMin, typename V::F vMax, typename V::F vRange,
+                            typename V::F vSteps, const uint16_t *lut, const uint8_t *edgeMask, Out *out,
+                            int idx) {
+  constexpr bool indexed = sizeof(Out) == 1;
+  const Out edgeColor = indexed ? (Out)EDGE_PALETTE_INDEX : (Out)PALETTE_OVERLAY_COLOR;
+
+  t = V::select(V::lt(t, vMin), vMin, V::select(V::gt(t, vMax), vMax, t));
+  alignas(16) int32_t lanes[4];
+  V::toInt(lanes, V::mul(V::div(V::sub(t, vMin), vRange), vSteps));
+  V::storeW(lanes, V::minW(V::maxW(V::loadW(lanes), V::splatW(0)), V::splatW(PALETTE_TOP_INDEX)));
+
+  for (int l = 0; l < 4; l++) {
+    const int li = lanes[l];
+    Out color;
+    if constexpr (indexed) {
+      color = (Out)li;
+    } else {
+      color = lut[li];
+    }
+
+    if (edgeMask && (edgeMask[(idx + l) >> 3] >> ((idx + l) & 7)) & 1) {
+      color = edgeColor;
+    }
+
+    out[idx + l] = color;
+  }
+}
+
+// Horizontally interpolated source rows are cached in rowCache (2 * Dst::width
+// floats, one cache per concurrent caller) and reused by every output row
+// between the same pair of sensor rows; the vertical blend and the index
+// mapping then run four pixels per step, and the source columns are mapped
+// eight per step on the integer lanes. Arithmetic matches the per-pixel
+// form top + (bot - top) * fy exactly. Only the view's sub-window of the
+// source is read; zoom costs the same as the full view.
+//
+// With a fovea map, fovea tiles are skipped here and filled with Catmull-Rom
+// bicubic instead, whose horizontal pass over four source rows is cached
+// the same way in the next 4 * Dst::width floats of rowCache. Tiles on the
+// fovea border blend towards the bilinear value at the shared side.
+//
+// FILTER_NEAREST caches the nearest sample instead and copies an output row
+// that maps to the same source row as the one above it (unless there is an
+// edge mask); FILTER_NEAREST_HALF also fills only even cache columns and
+// copies every odd row. Strips must start on an even row for the 2x2 blocks
+// to line up across strips.
+// Out is uint16_t (RGB565 through lut) or uint8_t (palette index, lut unused)
+template <typename Src, typename Dst, typename Out, typename V = Simd>
+void renderThermalRows(const float *buf, float tMin, float tMax, const uint16_t *lut,
+                       const uint8_t *edgeMask, Out *out, int yBegin, int yEnd, float *rowCache,
+                       const ViewWindow &view = FULL_VIEW, const FoveaMap<Dst> *fovea = nullptr,
+                       RenderFilter filter = FILTER_BILINEAR) {
+  using F = typename V::F;
+  static_assert(Dst::width % 8 == 0, "render rows are mapped eight and coloured four pixels at a time");
+
+  if (!AUTO_SCALE) {
+    tMin = TEMP_MIN_CLAMP;
+    tMax = TEMP_MAX_CLAMP;
+  }
+  float range = tMax - tMin;
+  if (range < MIN_RANGE_DEFAULT) range = MIN_RANGE_DEFAULT;
+  const F vMin = V::splat(tMin);
+  const F vMax = V::splat(tMax);
+  const F vRange = V::splat(range);
+  const F vSteps = V::splat((float)PALETTE_TOP_INDEX);
+
+  AxisRef ax, ay;
+  viewAxes<Src, Dst>(view, ax, ay);
+
+  float *top = rowCache;
+  float *bot = rowCache + Dst::width;
+  float *cubic = rowCache + 2 * Dst::width;
+  int cachedY0 = -1;
+  int cubicY0 = -1;
+  int cubicTileRow = -1;
+  int nearestRow = -1;
+  const bool nearest = filter != FILTER_BILINEAR;
+  const bool half = filter == FILTER_NEAREST_HALF;
+
+  for (int y = yBegin; y < yEnd; y++) {
+    const int y0 = ay.origin + ay.index[y];
+    const F fy = V::splat(ay.frac[y]);
+    const uint8_t *foveaRow = fovea ? fovea->tiles[y / FOVEA_TILE] : nullptr;
+    const int rowOffset = y * Dst::width;
+
+    // nearestRow: source row of the row above, -1 if that row is not a plain nearest row
+    if (nearest && !foveaRow) {
+      const int sourceRow = y0 + (ay.frac[y] >= 0.5f);
+      if (nearestRow >= 0 && ((half && (y & 1)) || (!edgeMask && sourceRow == nearestRow))) {
+        memcpy(&out[rowOffset], &out[rowOffset - Dst::width], Dst::width * sizeof(Out));
+        continue;
+      }
+      nearestRow = sourceRow;
+    } else {
+      nearestRow = -1;
+    }
+
+    if (y0 != cachedY0) {
+      const float *row0 = &buf[y0 * Src::width];
+      const float *row1 = &buf[(y0 + 1) * Src::width];
+      alignas(16) int16_t xs[8];
+      if (nearest) {
+        for (int x8 = 0; x8 < Dst::width; x8 += 8) {
+          mapAxisLanes<V>(&ax.nearest[x8], ax.origin, 0, Src::width - 1, xs);
+          for (int l = 0; l < 8; l += half ? 2 : 1) {
+            const int x = x8 + l;
+            top[x] = row0[xs[l]];
+            bot[x] = row1[xs[l]];
+            if (half) {
+              top[x + 1] = top[x];
+              bot[x + 1] = bot[x];
+            }
+          }
+        }
+      } else {
+        for (int x8 = 0; x8 < Dst::width; x8 += 8) {
+          mapAxisLanes<V>(&ax.index[x8], ax.origin, 0, Src::width - 2, xs);
+          for (int l = 0; l < 8; l++) {
+            const int x = x8 + l;
+            const int x0 = xs[l];
+            const float fx = ax.frac[x];
+            top[x] = row0[x0] + (row0[x0 + 1] - row0[x0]) * fx;
+            bot[x] = row1[x0] + (row1[x0 + 1] - row1[x0]) * fx;
+          }
+        }
+      }
+      cachedY0 = y0;
+    }
+
+    if (nearest) {
+      const float *src = ay.frac[y] >= 0.5f ? bot : top;
+      for (int x = 0; x < Dst::width; x += 4) {
+        if (foveaRow && foveaRow[x / FOVEA_TILE]) continue;
+        storeColorLanes<V>(V::load(&src[x]), vMin, vMax, vRange, vSteps, lut, edgeMask, out, rowOffset + x);
+      }
+    } else {
+      for (int x = 0; x < Dst::width; x += 4) {
+        if (foveaRow && foveaRow[x / FOVEA_TILE]) continue;
+        F t0 = V::load(&top[x]);
+        F t = V::add(t0, V::mul(V::sub(V::load(&bot[x]), t0), fy));
+        storeColorLanes<V>(t, vMin, vMax, vRange, vSteps, lut, edgeMask, out, rowOffset + x);
+      }
+    }
+
+    if (!foveaRow) continue;
+
+    if (y0 != cubicY0 || y / FOVEA_TILE != cubicTileRow) {
+      const float *rows[4];
+      for (int r = 0; r < 4; r++) {
+        int sy = y0 - 1 + r;
+        sy = sy < 0 ? 0 : (sy > Src::height - 1 ? Src::height - 1 : sy);
+        rows[r] = &buf[sy * Src::width];
+      }
+      for (int x = 0; x < Dst::width; x++) {
+        if (!foveaRow[x / FOVEA_TILE]) {
+          x += FOVEA_TILE - 1;
+          continue;
+        }
+        const int x0 = ax.origin + ax.index[x];
+        int taps[4];
+        for (int k = 0; k < 4; k++) {
+          int sx = x0 - 1 + k;
+          taps[k] = sx < 0 ? 0 : (sx > Src::width - 1 ? Src::width - 1 : sx);
+        }
+        float w[4];
+        cubicWeights(ax.frac[x], w);
+        for (int r = 0; r < 4; r++) {
+          cubic[r * Dst::width + x] = rows[r][taps[0]] * w[0] + rows[r][taps[1]] * w[1] +
+                                      rows[r][taps[2]] * w[2] + rows[r][taps[3]] * w[3];
+        }
+      }
+      cubicY0 = y0;
+      cubicTileRow = y / FOVEA_TILE;
+    }
+
+    float wy[4];
+    cubicWeights(ay.frac[y], wy);
+    const F w0 = V::splat(wy[0]);
+    const F w1 = V::splat(wy[1]);
+    const F w2 = V::splat(wy[2]);
+    const F w3 = V::splat(wy[3]);
+
+    for (int x = 0; x < Dst::width; x += 4) {
+      const uint8_t tile = foveaRow[x / FOVEA_TILE];
+      if (!tile) continue;
+      F t = V::add(V::add(V::mul(V::load(&cubic[x]), w0), V::mul(V::load(&cubic[Dst::width + x]), w1)),
+                   V::add(V::mul(V::load(&cubic[2 * Dst::width + x]), w2),
+                          V::mul(V::load(&cubic[3 * Dst::width + x]), w3)));
+      if (tile != FOVEA_INNER) {
+        float ramp[4];
+        foveaRamp(tile, x, y, ramp);
+        F t0 = V::load(&top[x]);
+        F linear = V::add(t0, V::mul(V::sub(V::load(&bot[x]), t0), fy));
+        t = V::add(linear, V::mul(V::sub(t, linear), V::load(ramp)));
+      }
+      storeColorLanes<V>(t, vMin, vMax, vRange, vSteps, lut, edgeMask, out, rowOffset + x);
+    }
+  }
+}
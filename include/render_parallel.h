@@ -0,0 +1,20 @@
+#pragma once
+#include <stdint.h>
+#include "render.h"
+
+struct RenderJob {
+  const float *buf;
+  float tMin;
+  float tMax;
+  const uint16_t *lut;
+  uint8_t *edgeMask;
+  FbPixel *out;
+  float *rowCache;    // 2 strips x RENDER_CACHE_ROWS * FbGeom::width floats
+  ViewWindow view;
+  const FoveaMap<FbGeom> *fovea;    // null: periphery filter + edges everywhere
+  RenderFilter filter;
+};
+
+void initRenderWorkers();
+void renderStrip(const RenderJob &job, int yBegin, int yEnd);
+void renderParallel(const RenderJob &job);
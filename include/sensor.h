@@ -1,9 +1,26 @@
 #pragma once
-#include <Adafruit_MLX90640.h>
-#include "main.h"
+#include "sensor_backend.h"
 
-extern Adafruit_MLX90640 mlx;
+extern SensorBackend mlx;
+
+enum SensorBootState {
+  SENSOR_BOOT_PENDING = 0,
+  SENSOR_BOOT_READY = 1,
+  SENSOR_BOOT_FAILED = 2
+};
 
 bool initSensor();
+void beginSensorAsync(float *primeBuf);
+SensorBootState sensorBootState();
 bool readFrame(float *buf);
-bool isFrameReady();
\ No newline at end of file
+bool isFrameReady();
+// Drops temporal history so a replayed sequence starts from a clean state
+void resetConditioning();
+
+// Burst capture (SENSOR_COUNT == 1): readSubpage() returns the subpage
+// number or the read status (< 0); decodeSubpage() only writes the pixels
+// of that subpage into buf
+bool beginBurstAcquisition();
+void endBurstAcquisition();
+int readSubpage(uint16_t *raw);
+void decodeSubpage(uint16_t *raw, float *buf);
\ No newline at end of file
@@ -0,0 +1,9 @@
+#pragma once
+#include <stdint.h>
+#include "main.h"
+
+bool initSensorArray(uint32_t clockHz);
+// Each sensor keeps its own link health (i2c_health.h) and its port runs at
+// the slowest clock its sensors asked for. missingPixels: stitched pixels
+// that only failed sensors cover (frameSyncMissingPixels).
+int acquireStitchedFrame(float *buf, int &missingPixels);
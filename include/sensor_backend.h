@@ -0,0 +1,80 @@
+#pragma once
+#include <Wire.h>
+#include "geometry.h"
+
+// ==========================================
+// SENSOR BACKENDS
+// ==========================================
+
+// Each backend exposes its native geometry plus begin()/getFrame() returning
+// the Melexis status code (0 = ok) and setAcquisition() for runtime refresh
+// rate / ADC resolution changes. SENSOR_MODEL picks one at compile time.
+// Burst capture reads single raw subpages instead (getSubpage() returns the
+// subpage number or the status < 0) and decodes them later with
+// subpageTemps(), which only writes the pixels of that subpage; beginRaw()
+// must have succeeded first.
+
+// Control register refresh code shared by both sensors: 1 Hz = 1 ... 64 Hz = 7
+inline uint8_t mlxRefreshCode(uint8_t hz) {
+  uint8_t code = 1;
+  while (hz > 1) {
+    hz >>= 1;
+    code++;
+  }
+  return code;
+}
+
+#if SENSOR_MODEL == SENSOR_MLX90641
+
+#include <MLX90641_API.h>
+
+// Needs the Melexis MLX90641 API in lib/MLX90641 (scripts/fetch_melexis.py);
+// MLX90641_I2C_Driver is implemented on top of Wire in mlx90641_backend.cpp.
+class Mlx90641Backend {
+public:
+  using Geom = Geometry<16, 12>;
+
+  bool begin(uint8_t addr, TwoWire *wire);
+  int getFrame(float *buf);
+  void setAcquisition(uint8_t refreshHz, uint8_t adcBits);
+
+  bool beginRaw() { return true; }
+  int getSubpage(uint16_t *raw);
+  void subpageTemps(uint16_t *raw, float *buf);
+
+private:
+  uint8_t address = 0;
+  paramsMLX90641 *params = nullptr;   // BUF_SENSOR_PARAMS slot, claimed by begin()
+};
+
+using SensorBackend = Mlx90641Backend;
+
+#else
+
+#include <MLX90640_API.h>
+
+// Needs the Melexis MLX90640 API in lib/MLX90640 (scripts/fetch_melexis.py);
+// MLX90640_I2C_Driver is implemented on top of Wire in mlx90640_backend.cpp.
+class Mlx90640Backend {
+public:
+  using Geom = Geometry<32, 24>;
+
+  bool begin(uint8_t addr, TwoWire *wire);
+  int getFrame(float *buf);
+  void setAcquisition(uint8_t refreshHz, uint8_t adcBits);
+
+  bool beginRaw() { return true; }
+  int getSubpage(uint16_t *raw);
+  void subpageTemps(uint16_t *raw, float *buf);
+
+private:
+  uint8_t address = 0;
+  paramsMLX90640 *params = nullptr;   // BUF_SENSOR_PARAMS slot, claimed by begin()
+};
+
+using SensorBackend = Mlx90640Backend;
+
+#endif
+
+static_assert(SensorBackend::Geom::width == MLX_W && SensorBackend::Geom::height == MLX_H,
+              "MLX_W/MLX_H do not match the selected SENSOR_MODEL");
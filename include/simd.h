@@ -0,0 +1,190 @@
+#pragma once
+#include <stdint.h>
+#include <string.h>
+
+#if defined(ARDUINO)
+#include <sdkconfig.h>
+#endif
+
+// ==========================================
+// VECTOR LAYER (4 x float, 4 x int32, 8 x int16)
+// ==========================================
+
+// Backends share one static interface over a 4-lane float vector F, a lane
+// mask M and the integer vectors W (4 x int32) and H (8 x int16). Kernels
+// are templates on the backend, so the native build can run backends side
+// by side and compare results bit for bit.
+//
+//   SimdScalar - reference, plain per-lane loops
+//   SimdGcc    - GCC vector extensions (SSE / NEON on hosts)
+//   SimdPie    - ESP32-S3 PIE for the integer lanes, SimdScalar for floats
+//
+// SimdPie only replaces the five integer ops below (minW / maxW, addH /
+// minH / maxH), which serve the axis mapping, the palette index clamp and
+// the positive-finite fast path of the temporal median. Everything on F -
+// float min / max, the EMA, row interpolation, colour quantisation - stays
+// per-lane scalar on the S3 FPU. It is opt-in (-DSIMD_BACKEND=SIMD_PIE)
+// until it has been built and benchmarked on hardware; the S3 default is
+// SimdScalar.
+
+#define SIMD_SCALAR 0
+#define SIMD_GCC    1
+#define SIMD_PIE    2
+
+#ifndef SIMD_BACKEND
+#if defined(ARDUINO)
+#define SIMD_BACKEND SIMD_SCALAR
+#else
+#define SIMD_BACKEND SIMD_GCC
+#endif
+#endif
+
+struct SimdScalar {
+  struct F { float v[4]; };
+  struct M { bool v[4]; };
+  // 16-byte aligned so SimdPie can load them into its 128-bit registers
+  struct alignas(16) W { int32_t v[4]; };
+  struct alignas(16) H { int16_t v[8]; };
+
+  static F load(const float *p) { F r; for (int i = 0; i < 4; i++) r.v[i] = p[i]; return r; }
+  static void store(float *p, F a) { for (int i = 0; i < 4; i++) p[i] = a.v[i]; }
+  static F splat(float x) { return F{{x, x, x, x}}; }
+  static float lane(F a, int i) { return a.v[i]; }
+
+  static F add(F a, F b) { F r; for (int i = 0; i < 4; i++) r.v[i] = a.v[i] + b.v[i]; return r; }
+  static F sub(F a, F b) { F r; for (int i = 0; i < 4; i++) r.v[i] = a.v[i] - b.v[i]; return r; }
+  static F mul(F a, F b) { F r; for (int i = 0; i < 4; i++) r.v[i] = a.v[i] * b.v[i]; return r; }
+  static F div(F a, F b) { F r; for (int i = 0; i < 4; i++) r.v[i] = a.v[i] / b.v[i]; return r; }
+
+  // Ordered compares: false when either lane is NaN
+  static M lt(F a, F b) { M r; for (int i = 0; i < 4; i++) r.v[i] = a.v[i] < b.v[i]; return r; }
+  static M le(F a, F b) { M r; for (int i = 0; i < 4; i++) r.v[i] = a.v[i] <= b.v[i]; return r; }
+  static M gt(F a, F b) { M r; for (int i = 0; i < 4; i++) r.v[i] = a.v[i] > b.v[i]; return r; }
+  static M ge(F a, F b) { M r; for (int i = 0; i < 4; i++) r.v[i] = a.v[i] >= b.v[i]; return r; }
+  static M both(M a, M b) { M r; for (int i = 0; i < 4; i++) r.v[i] = a.v[i] && b.v[i]; return r; }
+  static F select(M m, F a, F b) { F r; for (int i = 0; i < 4; i++) r.v[i] = m.v[i] ? a.v[i] : b.v[i]; return r; }
+
+  // Truncating float -> int conversion, as a C cast
+  static void toInt(int32_t *p, F a) { for (int i = 0; i < 4; i++) p[i] = (int32_t)a.v[i]; }
+
+  static W loadW(const int32_t *p) { W r; memcpy(r.v, p, sizeof(r.v)); return r; }
+  static void storeW(int32_t *p, W a) { memcpy(p, a.v, sizeof(a.v)); }
+  // Bit patterns of four floats, and back
+  static W bitsW(const float *p) { W r; memcpy(r.v, p, sizeof(r.v)); return r; }
+  static void storeBitsW(float *p, W a) { memcpy(p, a.v, sizeof(a.v)); }
+  static W splatW(int32_t x) { return W{{x, x, x, x}}; }
+  static int32_t laneW(W a, int i) { return a.v[i]; }
+  static W minW(W a, W b) { W r; for (int i = 0; i < 4; i++) r.v[i] = a.v[i] < b.v[i] ? a.v[i] : b.v[i]; return r; }
+  static W maxW(W a, W b) { W r; for (int i = 0; i < 4; i++) r.v[i] = a.v[i] > b.v[i] ? a.v[i] : b.v[i]; return r; }
+
+  // H loads unsigned tables (values below 32768) into signed lanes
+  static H loadH(const uint16_t *p) { H r; memcpy(r.v, p, sizeof(r.v)); return r; }
+  static void storeH(int16_t *p, H a) { memcpy(p, a.v, sizeof(a.v)); }
+  static H splatH(int16_t x) { return H{{x, x, x, x, x, x, x, x}}; }
+  // Saturating, as the PIE add
+  static H addH(H a, H b) {
+    H r;
+    for (int i = 0; i < 8; i++) {
+      int s = a.v[i] + b.v[i];
+      r.v[i] = (int16_t)(s < INT16_MIN ? INT16_MIN : (s > INT16_MAX ? INT16_MAX : s));
+    }
+    return r;
+  }
+  static H minH(H a, H b) { H r; for (int i = 0; i < 8; i++) r.v[i] = a.v[i] < b.v[i] ? a.v[i] : b.v[i]; return r; }
+  static H maxH(H a, H b) { H r; for (int i = 0; i < 8; i++) r.v[i] = a.v[i] > b.v[i] ? a.v[i] : b.v[i]; return r; }
+};
+
+#if defined(__GNUC__)
+
+struct SimdGcc {
+  typedef float F __attribute__((vector_size(16)));
+  typedef int32_t M __attribute__((vector_size(16)));
+  typedef int32_t W __attribute__((vector_size(16)));
+  typedef int16_t H __attribute__((vector_size(16)));
+  typedef int32_t H32 __attribute__((vector_size(32)));
+
+  static F load(const float *p) { F r; memcpy(&r, p, sizeof(r)); return r; }
+  static void store(float *p, F a) { memcpy(p, &a, sizeof(a)); }
+  static F splat(float x) { return F{x, x, x, x}; }
+  static float lane(F a, int i) { return a[i]; }
+
+  static F add(F a, F b) { return a + b; }
+  static F sub(F a, F b) { return a - b; }
+  static F mul(F a, F b) { return a * b; }
+  static F div(F a, F b) { return a / b; }
+
+  static M lt(F a, F b) { return a < b; }
+  static M le(F a, F b) { return a <= b; }
+  static M gt(F a, F b) { return a > b; }
+  static M ge(F a, F b) { return a >= b; }
+  static M both(M a, M b) { return a & b; }
+  static F select(M m, F a, F b) { return m ? a : b; }
+
+  static void toInt(int32_t *p, F a) {
+    M r = __builtin_convertvector(a, M);
+    memcpy(p, &r, sizeof(r));
+  }
+
+  static W loadW(const int32_t *p) { W r; memcpy(&r, p, sizeof(r)); return r; }
+  static void storeW(int32_t *p, W a) { memcpy(p, &a, sizeof(a)); }
+  static W bitsW(const float *p) { W r; memcpy(&r, p, sizeof(r)); return r; }
+  static void storeBitsW(float *p, W a) { memcpy(p, &a, sizeof(a)); }
+  static W splatW(int32_t x) { return W{x, x, x, x}; }
+  static int32_t laneW(W a, int i) { return a[i]; }
+  static W minW(W a, W b) { return a < b ? a : b; }
+  static W maxW(W a, W b) { return a > b ? a : b; }
+
+  static H loadH(const uint16_t *p) { H r; memcpy(&r, p, sizeof(r)); return r; }
+  static void storeH(int16_t *p, H a) { memcpy(p, &a, sizeof(a)); }
+  static H splatH(int16_t x) { return H{x, x, x, x, x, x, x, x}; }
+  static H addH(H a, H b) {
+    H32 s = __builtin_convertvector(a, H32) + __builtin_convertvector(b, H32);
+    const H32 lo = H32{} + INT16_MIN;
+    const H32 hi = H32{} + INT16_MAX;
+    return __builtin_convertvector(s < lo ? lo : (s > hi ? hi : s), H);
+  }
+  static H minH(H a, H b) { return a < b ? a : b; }
+  static H maxH(H a, H b) { return a > b ? a : b; }
+};
+
+#endif
+
+#if defined(ARDUINO) && defined(CONFIG_IDF_TARGET_ESP32S3) && SIMD_BACKEND == SIMD_PIE
+
+// Each op loads its operands into q0 / q1, computes into q2 and stores it;
+// W and H are 16-byte aligned, which EE.VLD.128 / EE.VST.128 require.
+// GCC never allocates the q registers (they are not in the Xtensa port's
+// register file), so a clobber list cannot protect them, and the FreeRTOS
+// port is not relied on to save them on a context switch (the acquisition
+// task and the render worker share core 0). The sequence therefore runs with interrupts masked to XCHAL_EXCM_LEVEL: the
+// q registers are only live inside it, so no other task or handler can
+// observe or overwrite them.
+#define SIMD_PIE_OP(insn, r, a, b)                                       \
+  do {                                                                   \
+    uint32_t ps;                                                         \
+    asm volatile("rsil %0, 3\n\t"                                        \
+                 "ee.vld.128.ip q0, %2, 0\n\t"                           \
+                 "ee.vld.128.ip q1, %3, 0\n\t" insn " q2, q0, q1\n\t"    \
+                 "ee.vst.128.ip q2, %1, 0\n\t"                           \
+                 "wsr.ps %0\n\t"                                         \
+                 "rsync"                                                 \
+                 : "=&r"(ps) : "r"(&(r)), "r"(&(a)), "r"(&(b)) : "memory"); \
+  } while (0)
+
+struct SimdPie : SimdScalar {
+  static W minW(W a, W b) { W r; SIMD_PIE_OP("ee.vmin.s32", r, a, b); return r; }
+  static W maxW(W a, W b) { W r; SIMD_PIE_OP("ee.vmax.s32", r, a, b); return r; }
+  static H addH(H a, H b) { H r; SIMD_PIE_OP("ee.vadds.s16", r, a, b); return r; }
+  static H minH(H a, H b) { H r; SIMD_PIE_OP("ee.vmin.s16", r, a, b); return r; }
+  static H maxH(H a, H b) { H r; SIMD_PIE_OP("ee.vmax.s16", r, a, b); return r; }
+};
+
+#endif
+
+#if SIMD_BACKEND == SIMD_GCC
+using Simd = SimdGcc;
+#elif SIMD_BACKEND == SIMD_PIE
+using Simd = SimdPie;
+#else
+using Simd = SimdScalar;
+#endif
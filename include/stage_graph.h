@@ -0,0 +1,73 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+#include <tuple>
+#include <utility>
+#include "main.h"
+#include "simd.h"
+
+// ==========================================
+// STAGE GRAPH (fused per-pixel frame passes)
+// ==========================================
+
+// A stage is a plain type:
+//
+//   struct MyStage {
+//     static constexpr size_t bufferBytes = ...;  // persistent state, 0 for none
+//     void bind(uint8_t *buffer);                 // once, with bufferBytes of storage
+//     template <typename V> struct Pass {         // one per run, lives in registers
+//       explicit Pass(MyStage &stage);
+//       typename V::F apply(typename V::F x, int i);  // i = first pixel of the lane block
+//       void finish();                            // fold lane state back into the stage
+//     };
+//   };
+//
+// StageGraph chains the passes of its stages inside one loop over the frame,
+// four pixels at a time. Each stage sees the previous stage's output while
+// it is still in registers. The whole chain is visible to the compiler, so
+// adding or reordering a stage changes the loop body without adding a pass
+// over memory or an indirect call. The same definition builds for the
+// device and the native tools; only the Simd backend differs.
+
+constexpr size_t stageAlign(size_t bytes) {
+  return (bytes + ARENA_ALIGN - 1) & ~(size_t)(ARENA_ALIGN - 1);
+}
+
+template <typename G, typename... Stages>
+struct StageGraph {
+  static_assert(G::pixels % 4 == 0, "stage graphs process four pixels at a time");
+
+  // Storage the graph needs in total, each stage's share ARENA_ALIGN aligned
+  static constexpr size_t bufferBytes = (stageAlign(Stages::bufferBytes) + ... + 0);
+
+  std::tuple<Stages...> stages;
+
+  // buffer holds bufferBytes (may be null when the graph needs none)
+  void bind(uint8_t *buffer) {
+    std::apply([&](Stages &...s) {
+      ((s.bind(buffer), buffer += buffer ? stageAlign(Stages::bufferBytes) : 0), ...);
+    }, stages);
+  }
+
+  template <size_t I>
+  auto &stage() { return std::get<I>(stages); }
+
+  template <size_t I>
+  const auto &stage() const { return std::get<I>(stages); }
+
+  template <typename V = Simd>
+  void run(const float *in) {
+    runPasses<V>(in, std::index_sequence_for<Stages...>{});
+  }
+
+  template <typename V, size_t... I>
+  void runPasses(const float *in, std::index_sequence<I...>) {
+    std::tuple<typename Stages::template Pass<V>...> passes(std::get<I>(stages)...);
+    for (int i = 0; i < G::pixels; i += 4) {
+      typename V::F x = V::load(&in[i]);
+      ((x = std::get<I>(passes).apply(x, i)), ...);
+      (void)x;
+    }
+    (std::get<I>(passes).finish(), ...);
+  }
+};
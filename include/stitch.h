@@ -0,0 +1,6 @@
+#pragma once
+#include "geometry.h"
+
+void stitchFrames(const float *const *frames, int count, float *out);
+// Output pixels that no delivering sensor covers (NaN after stitching)
+int stitchUncoveredPixels(const bool *delivered, int count);
@@ -0,0 +1,62 @@
+#pragma once
+#include <stdint.h>
+#include "main.h"
+
+// ==========================================
+// TRACE EVENTS (id, name)
+// ==========================================
+
+#define TRACE_EVENTS(X) \
+  X(TRACE_FRAME,        "frame") \
+  X(TRACE_SENSOR_READ,  "sensor_read") \
+  X(TRACE_SENSOR_READY, "sensor_ready") \
+  X(TRACE_BURST,        "burst_subpage") \
+  X(TRACE_HOTSPOT,      "hotspot") \
+  X(TRACE_ISOTHERM,     "isotherm") \
+  X(TRACE_RENDER,       "render") \
+  X(TRACE_RENDER_STRIP, "render_strip") \
+  X(TRACE_FOVEA,        "fovea_tiles") \
+  X(TRACE_QUALITY,      "quality_level") \
+  X(TRACE_SPI_PUSH,     "spi_push") \
+  X(TRACE_UI,           "ui_redraw") \
+  X(TRACE_BUTTON_ISR,   "button_isr") \
+  X(TRACE_LOG,          "log")
+
+enum TraceEvent : uint8_t {
+#define TRACE_EVENT_ID(id, name) id,
+  TRACE_EVENTS(TRACE_EVENT_ID)
+#undef TRACE_EVENT_ID
+  TRACE_EVENT_COUNT
+};
+
+enum TracePhase : uint8_t {
+  TRACE_BEGIN = 'B',
+  TRACE_END = 'E',
+  TRACE_INSTANT = 'i'
+};
+
+struct TraceRecord {
+  uint32_t timestampUs;
+  uint8_t phase;
+  uint8_t event;
+  uint16_t arg;
+};
+
+static_assert(sizeof(TraceRecord) == TRACE_RECORD_BYTES, "TRACE_RECORD_BYTES out of sync");
+static_assert((TRACE_RING_SIZE & (TRACE_RING_SIZE - 1)) == 0, "TRACE_RING_SIZE must be a power of two");
+
+void initTrace();
+void traceRecord(TracePhase phase, TraceEvent event, uint16_t arg);
+void traceDump();
+
+inline void traceBegin(TraceEvent event) {
+  if (TRACE_ENABLED) traceRecord(TRACE_BEGIN, event, 0);
+}
+
+inline void traceEnd(TraceEvent event) {
+  if (TRACE_ENABLED) traceRecord(TRACE_END, event, 0);
+}
+
+inline void traceInstant(TraceEvent event, uint16_t arg = 0) {
+  if (TRACE_ENABLED) traceRecord(TRACE_INSTANT, event, arg);
+}
@@ -0,0 +1,50 @@
+#pragma once
+#include <stdint.h>
+#include "geometry.h"
+
+// ==========================================
+// VIEW WINDOW (digital zoom + pan)
+// ==========================================
+
+constexpr int ZOOM_FACTORS[ZOOM_LEVEL_COUNT] = ZOOM_LEVELS;
+static_assert(ZOOM_FACTORS[0] == 1, "the first zoom level must be the full view");
+
+// Visible part of the conditioned frame: zoom level index and the sensor
+// pixel at the window's top-left corner. At zoom z the window spans
+// (SRC - 1) / z sensor pixels per axis, so 1x is exactly the full view.
+struct ViewWindow {
+  uint8_t level;
+  uint8_t originX;
+  uint8_t originY;
+};
+
+constexpr ViewWindow FULL_VIEW = {0, 0, 0};
+
+// Largest origin that keeps the window (and the bilinear x0 + 1 read)
+// inside the frame
+constexpr int viewMaxOrigin(int src, int zoom) {
+  return (src - 1) - ((src - 1) + zoom - 1) / zoom;
+}
+
+// Sensor position in 1/256 pixel to framebuffer pixel; false when it falls
+// outside the window. The far edge maps to Dst::width / Dst::height and still
+// counts as visible, so at 1x every sensor position is.
+template <typename Src, typename Dst>
+inline bool viewToFbFixed(const ViewWindow &v, int32_t sx8, int32_t sy8, int &px, int &py) {
+  const int32_t zoom = ZOOM_FACTORS[v.level];
+  px = (int)(((sx8 - ((int32_t)v.originX << 8)) * Dst::width * zoom) / ((int32_t)(Src::width - 1) << 8));
+  py = (int)(((sy8 - ((int32_t)v.originY << 8)) * Dst::height * zoom) / ((int32_t)(Src::height - 1) << 8));
+  return sx8 >= ((int32_t)v.originX << 8) && sy8 >= ((int32_t)v.originY << 8) &&
+         px <= Dst::width && py <= Dst::height;
+}
+
+template <typename Src, typename Dst>
+inline bool viewToFb(const ViewWindow &v, int sx, int sy, int &px, int &py) {
+  return viewToFbFixed<Src, Dst>(v, sx << 8, sy << 8, px, py);
+}
+
+// Current view of the display; changed from the button handler
+const ViewWindow &currentView();
+int currentZoom();
+void viewCycleZoom();
+void viewPanNext();
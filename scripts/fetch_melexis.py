@@ -0,0 +1,93 @@
+#!/usr/bin/env python3
+
+"""
+Fetches the Melexis sensor API into lib/<name>/src before a build
+(extra_scripts = pre:scripts/fetch_melexis.py).
+
+Only the API is taken (functions/*_API.cpp and headers/*.h); the I2C
+driver is implemented on top of Wire in src/. The fetched sources are not
+committed. Delete lib/<name>/src to fetch them again.
+
+Each library is pinned to a commit, and the archive of that commit must
+match the recorded SHA-256; the build stops otherwise. To move a pin, run
+the script outside PlatformIO and copy the printed values into LIBRARIES:
+
+    python3 scripts/fetch_melexis.py --pin MLX90640 <commit sha>
+"""
+
+import hashlib
+import io
+import os
+import re
+import sys
+import urllib.request
+import zipfile
+
+ARCHIVE_URL = "https://github.com/%s/archive/%s.zip"
+
+# name: (repository, commit, SHA-256 of the commit archive)
+LIBRARIES = {
+    "MLX90640": ("melexis/mlx90640-library", "", ""),
+    "MLX90641": ("melexis/mlx90641-library", "", ""),
+}
+
+
+def wanted(path, name):
+    parts = path.split("/")
+    if len(parts) != 3 or not parts[2]:
+        return False
+    return (parts[1] == "headers" and parts[2].endswith(".h")) or parts[2] == name + "_API.cpp"
+
+
+def download(repo, commit):
+    url = ARCHIVE_URL % (repo, commit)
+    print("fetching %s" % url)
+    with urllib.request.urlopen(url, timeout=60) as response:
+        return response.read()
+
+
+def fetch(name, lib_dir):
+    src_dir = os.path.join(lib_dir, name, "src")
+    if os.path.isfile(os.path.join(src_dir, name + "_API.cpp")):
+        return
+
+    repo, commit, sha256 = LIBRARIES[name]
+    if not re.fullmatch(r"[0-9a-f]{40}", commit) or not re.fullmatch(r"[0-9a-f]{64}", sha256):
+        sys.exit("%s is not pinned: run scripts/fetch_melexis.py --pin %s <commit sha>, or place the API "
+                 "sources in %s" % (name, name, src_dir))
+
+    data = download(repo, commit)
+    digest = hashlib.sha256(data).hexdigest()
+    if digest != sha256:
+        sys.exit("%s archive %s has SHA-256 %s, expected %s" % (name, commit, digest, sha256))
+
+    archive = zipfile.ZipFile(io.BytesIO(data))
+    os.makedirs(src_dir, exist_ok=True)
+    for path in archive.namelist():
+        if wanted(path, name):
+            with open(os.path.join(src_dir, os.path.basename(path)), "wb") as f:
+                f.write(archive.read(path))
+
+
+def pin(name, commit):
+    if name not in LIBRARIES or not re.fullmatch(r"[0-9a-f]{40}", commit):
+        sys.exit("usage: fetch_melexis.py --pin {%s} <40 hex digit commit sha>" % ",".join(LIBRARIES))
+    repo = LIBRARIES[name][0]
+    digest = hashlib.sha256(download(repo, commit)).hexdigest()
+    print('    "%s": ("%s", "%s",\n                 "%s"),' % (name, repo, commit, digest))
+
+
+try:
+    Import("env")
+except NameError:
+    env = None
+
+if env is None:
+    if len(sys.argv) != 4 or sys.argv[1] != "--pin":
+        sys.exit("usage: fetch_melexis.py --pin NAME COMMIT")
+    pin(sys.argv[2], sys.argv[3])
+else:
+    lib_dir = env.subst("$PROJECT_DIR/lib")
+    for name in LIBRARIES:
+        if name not in env.GetProjectOption("lib_ignore", []):
+            fetch(name, lib_dir)
@@ -0,0 +1,166 @@
+#!/usr/bin/env python3
+
+"""
+Replay a radiometric recording (.trf, see include/recording.h) through the
+thermal camera over serial (INJECT_ENABLED 1, text log drain).
+
+The camera must be in LIVE mode. After INJECT_CMD it prompts "inj>" for each
+frame and answers with one line per frame:
+
+    inj,index,ok,condition_us,render_us,work_us,frame_crc,fb_crc
+
+frame_crc is the conditioned frame, fb_crc the framebuffer after rendering.
+Two runs of one recording on one build match exactly; --compare shows which
+frames a firmware change altered and how the timings moved.
+
+Replay:   python3 inject_frames.py --port /dev/ttyACM0 rec.trf -o run.csv
+Compare:  python3 inject_frames.py --port /dev/ttyACM0 rec.trf -o new.csv --compare run.csv
+"""
+
+import argparse
+import csv
+import struct
+import sys
+import time
+
+HEADER = struct.Struct("<IHHHHI")
+FRAME_HEADER = struct.Struct("<Ii")
+MAGIC = 0x31465254
+VERSION = 1
+INJECT_CMD = b"i"
+PROMPT = b"inj>"
+STOP = ("inject: done", "inject: rejected", "inject: only", "inject: no")
+FIELDS = ["index", "ok", "condition_us", "render_us", "work_us", "frame_crc", "fb_crc"]
+
+
+def load_recording(path, limit):
+    with open(path, "rb") as f:
+        data = f.read()
+    magic, version, _, width, height, count = HEADER.unpack_from(data)
+    if magic != MAGIC or version != VERSION:
+        raise SystemExit("%s: not a version %d recording" % (path, VERSION))
+
+    frame_bytes = FRAME_HEADER.size + width * height * 4
+    available = (len(data) - HEADER.size) // frame_bytes
+    count = min(count or available, available)
+    if limit:
+        count = min(count, limit)
+    frames = [data[HEADER.size + k * frame_bytes:HEADER.size + (k + 1) * frame_bytes] for k in range(count)]
+    return HEADER.pack(magic, version, 0, width, height, count), frames
+
+
+def parse_report(line):
+    values = line.split(",")[1:]
+    if len(values) != len(FIELDS):
+        return None
+    row = dict(zip(FIELDS, values))
+    for key in FIELDS[:5]:
+        row[key] = int(row[key])
+    return row
+
+
+def inject(port, baud, header, frames, fps, timeout):
+    import serial  # pyserial
+
+    rows = []
+    sent = 0
+    period = 1.0 / fps if fps else 0.0
+    next_send = time.time()
+
+    with serial.Serial(port, baud, timeout=timeout) as link:
+        link.reset_input_buffer()
+        link.write(INJECT_CMD + header)
+        while True:
+            line = link.readline()
+            if not line:
+                raise SystemExit("no answer from the camera after %d frames" % sent)
+            # The prompt may share a line with other output, so it is
+            # matched anywhere and the rest of the line handled as usual
+            prompts = line.count(PROMPT)
+            line = line.replace(PROMPT, b"").decode("ascii", "replace").strip()
+
+            for _ in range(prompts):
+                if sent >= len(frames):
+                    break
+                if period:
+                    time.sleep(max(0.0, next_send - time.time()))
+                    next_send = max(next_send + period, time.time())
+                link.write(frames[sent])
+                sent += 1
+
+            if not line:
+                continue
+            if line.startswith("inj,"):
+                row = parse_report(line)
+                if row:
+                    rows.append(row)
+            else:
+                print(line, file=sys.stderr)
+                if line.startswith(STOP):
+                    break
+    return rows
+
+
+def load_csv(path):
+    with open(path, newline="") as f:
+        return [{k: (int(v) if k in FIELDS[:5] else v) for k, v in row.items()} for row in csv.DictReader(f)]
+
+
+def mean(values):
+    return sum(values) / len(values) if values else 0.0
+
+
+def summarize(rows):
+    ok = [r for r in rows if r["ok"]]
+    for key in ("condition_us", "render_us", "work_us"):
+        values = sorted(r[key] for r in ok)
+        if values:
+            print("%-13s mean %8.1f us | p50 %7d | max %7d" %
+                  (key, mean(values), values[len(values) // 2], values[-1]))
+    print("%d frames, %d rejected" % (len(rows), len(rows) - len(ok)))
+
+
+def compare(rows, baseline):
+    base = {r["index"]: r for r in baseline}
+    frame_diffs = [r["index"] for r in rows if r["index"] in base and r["frame_crc"] != base[r["index"]]["frame_crc"]]
+    fb_diffs = [r["index"] for r in rows if r["index"] in base and r["fb_crc"] != base[r["index"]]["fb_crc"]]
+    print("compared %d frames: %d conditioned frames differ, %d framebuffers differ" %
+          (sum(1 for r in rows if r["index"] in base), len(frame_diffs), len(fb_diffs)))
+    if frame_diffs or fb_diffs:
+        print("  first difference at frame %d" % min(frame_diffs + fb_diffs))
+
+    for key in ("condition_us", "render_us", "work_us"):
+        now = mean([r[key] for r in rows if r["ok"]])
+        before = mean([r[key] for r in baseline if r["ok"]])
+        if before:
+            print("%-13s %8.1f -> %8.1f us (%+.1f%%)" % (key, before, now, 100.0 * (now - before) / before))
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("recording", help=".trf recording to inject")
+    parser.add_argument("--port", required=True)
+    parser.add_argument("--baud", type=int, default=115200)
+    parser.add_argument("-o", "--output", default="inject.csv")
+    parser.add_argument("--frames", type=int, default=0, help="inject only the first N frames")
+    parser.add_argument("--fps", type=float, default=0.0, help="pace frames at this rate (default: as fast as acked)")
+    parser.add_argument("--timeout", type=float, default=5.0)
+    parser.add_argument("--compare", help="CSV from an earlier run to check checksums and timings against")
+    args = parser.parse_args()
+
+    header, frames = load_recording(args.recording, args.frames)
+    rows = inject(args.port, args.baud, header, frames, args.fps, args.timeout)
+
+    with open(args.output, "w", newline="") as f:
+        writer = csv.DictWriter(f, fieldnames=FIELDS)
+        writer.writeheader()
+        writer.writerows(rows)
+
+    summarize(rows)
+    if args.compare:
+        compare(rows, load_csv(args.compare))
+    return 0 if len(rows) == len(frames) else 1
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,130 @@
+#!/usr/bin/env python3
+
+"""
+Decode binary log records from the thermal camera (LOG_DRAIN_BINARY 1).
+
+Format strings are read from include/binlog.h, so the decoder always matches
+the firmware it sits next to. Text between records (boot messages, memory
+report) is passed through unchanged.
+
+Live:     python3 log_decode.py --port /dev/ttyACM0
+Capture:  python3 log_decode.py capture.bin
+"""
+
+import argparse
+import os
+import re
+import struct
+import sys
+
+FRAME = b"\x1eL"
+RECORD = struct.Struct("<IIHBB6I")
+HEADER = os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", "include", "binlog.h")
+CONVERSION = re.compile(r"%([-+ #0-9.]*)[hlLqjzt]*([diouxXcfFeEgG%])")
+
+
+def load_formats(path):
+    with open(path) as f:
+        text = f.read()
+    block = text[text.index("#define LOG_FORMATS(X)"):text.index("enum LogFormat")]
+    formats = []
+    for match in re.finditer(r'X\(\s*(\w+),\s*"((?:[^"\\]|\\.)*)"\s*\)', block):
+        fmt = match.group(2).encode().decode("unicode_escape")
+        formats.append((match.group(1), fmt))
+    return formats
+
+
+def format_record(fmt, words):
+    values = []
+    index = 0
+    for spec in CONVERSION.finditer(fmt):
+        conv = spec.group(2)
+        if conv == "%":
+            continue
+        word = words[index] if index < len(words) else 0
+        index += 1
+        if conv in "fFeEgG":
+            values.append(struct.unpack("<f", struct.pack("<I", word))[0])
+        elif conv in "di":
+            values.append(struct.unpack("<i", struct.pack("<I", word))[0])
+        elif conv == "c":
+            values.append(chr(word & 0xFF))
+        else:
+            values.append(word)
+    return CONVERSION.sub(lambda m: "%" + m.group(1) + m.group(2), fmt) % tuple(values)
+
+
+class Decoder:
+    def __init__(self, formats, out):
+        self.formats = formats
+        self.out = out
+        self.buffer = b""
+        self.last_seq = None
+
+    def feed(self, data):
+        self.buffer += data
+        while True:
+            start = self.buffer.find(FRAME)
+            if start < 0:
+                keep = 1 if self.buffer.endswith(FRAME[:1]) else 0
+                self.text(self.buffer[:len(self.buffer) - keep])
+                self.buffer = self.buffer[len(self.buffer) - keep:]
+                return
+            if len(self.buffer) < start + len(FRAME) + RECORD.size:
+                self.text(self.buffer[:start])
+                self.buffer = self.buffer[start:]
+                return
+            self.text(self.buffer[:start])
+            body = self.buffer[start + len(FRAME):start + len(FRAME) + RECORD.size]
+            self.buffer = self.buffer[start + len(FRAME) + RECORD.size:]
+            self.record(RECORD.unpack(body))
+
+    def text(self, data):
+        if data:
+            self.out.write(data.decode("utf-8", "replace"))
+
+    def record(self, fields):
+        seq, timestamp, fmt_id, argc, core = fields[:5]
+        words = fields[5:5 + argc]
+        if self.last_seq is not None and seq and seq != self.last_seq + 1:
+            self.out.write("[%d records dropped]\n" % ((seq - self.last_seq - 1) & 0xFFFFFFFF))
+        if seq:
+            self.last_seq = seq
+
+        if fmt_id < len(self.formats):
+            line = format_record(self.formats[fmt_id][1], words)
+        else:
+            line = "unknown format %d %s\n" % (fmt_id, list(words))
+        self.out.write("%10.3f ms c%d  %s" % (timestamp / 1000.0, core, line))
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("input", nargs="?", help="raw serial capture")
+    parser.add_argument("--port", help="decode live from this serial port instead of a file")
+    parser.add_argument("--baud", type=int, default=115200)
+    parser.add_argument("--header", default=HEADER, help="binlog.h with the LOG_FORMATS table")
+    args = parser.parse_args()
+
+    decoder = Decoder(load_formats(args.header), sys.stdout)
+
+    if args.port:
+        import serial  # pyserial, only needed for live decoding
+
+        with serial.Serial(args.port, args.baud, timeout=0.2) as link:
+            try:
+                while True:
+                    decoder.feed(link.read(4096))
+                    sys.stdout.flush()
+            except KeyboardInterrupt:
+                return 0
+    elif args.input:
+        with open(args.input, "rb") as f:
+            decoder.feed(f.read())
+    else:
+        parser.error("give an input file or --port")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
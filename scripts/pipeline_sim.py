@@ -0,0 +1,376 @@
+#!/usr/bin/env python3
+
+"""
+Discrete-event timing model of the thermal camera acquisition/render pipeline.
+
+Predicts display FPS, sensor frame rate, photon-to-display latency and bus /
+core utilisation for a configuration, without flashing the board.
+
+Defaults are read from include/main.h; any of them can be overridden:
+
+    python3 scripts/pipeline_sim.py
+    python3 scripts/pipeline_sim.py --i2c-hz 400000 --refresh 32
+    python3 scripts/pipeline_sim.py --spi-hz 40000000 --no-parallel-render
+    python3 scripts/pipeline_sim.py --calibration my_board.json --seconds 30
+
+Model:
+  - MLX90640 produces one subpage every 1/refresh s; getFrame() reads two
+    subpages (wait for data-ready, I2C burst, CalculateTo on the CPU).
+    ADC resolution changes noise, not conversion timing.
+  - I2C cost = 9 bit times per byte plus per-chunk addressing overhead.
+  - SPI push = FB pixels x 3 bytes (ILI9488 18-bit) x 8 bits / SPI clock,
+    blocking the loop core (draw16bitRGBBitmap).
+  - Loop structure follows main.cpp: sequential read/condition/render/push,
+    or with FRAME_INTERPOLATION an acquisition task on core 0 and a display
+    loop paced at TARGET_FPS on core 1. PARALLEL_RENDER splits rows across
+    both cores.
+
+CPU costs are per-stage estimates; replace them with measured values (stats
+line, trace dump) via --calibration, a JSON object with any CALIBRATION key.
+"""
+
+import argparse
+import heapq
+import json
+import math
+import os
+import random
+import re
+import sys
+
+ROOT = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+MAIN_H = os.path.join(ROOT, "include", "main.h")
+
+# Per-stage CPU costs on the ESP32-S3 @ 240 MHz (seconds unless noted)
+CALIBRATION = {
+    "calculate_to_s": 0.0090,       # MLX90640_CalculateTo per subpage
+    "condition_s": 0.00015,         # temporal median + bad-pixel repair
+    "ema_minmax_s": 0.00005,        # applySmoothing + findMinMax
+    "synth_blend_s": 0.00005,       # synthesizeFrame, linear blend
+    "synth_motion_s": 0.0004,       # synthesizeFrame, block motion
+    "edge_ns_per_px": 60.0,         # calculateEdgeMaskRows
+    "render_ns_per_px": 70.0,       # renderThermalRows
+    "parallel_efficiency": 0.92,    # 2-core render speed-up / 2
+    "markers_s": 0.0003,            # drawTempMarkers
+    "ui_s": 0.0040,                 # drawMenu + drawLegend
+    "ui_interval_s": 0.100,         # UI_UPDATE_INTERVAL
+    "spi_overhead_s": 0.0002,       # address window + CS per push
+    "i2c_chunk_bytes": 128,         # bytes per I2C read transaction
+    "i2c_chunk_overhead_bytes": 4,  # addr + 16-bit register + addr(read)
+    "subpage_words": 834,           # RAM + control words read per subpage
+    "jitter_frac": 0.01,            # sensor clock jitter (fraction of period)
+}
+
+
+# ==========================================
+# CONFIG FROM main.h
+# ==========================================
+
+def read_main_h(path=MAIN_H):
+    values = {}
+    if not os.path.exists(path):
+        return values
+    pattern = re.compile(r"^\s*#define\s+(\w+)\s+(.+?)\s*(//.*)?$")
+    with open(path, encoding="utf-8", errors="replace") as f:
+        for line in f:
+            m = pattern.match(line)
+            if not m:
+                continue
+            expr = re.sub(r"(\d+(?:\.\d+)?)(?:UL|U|L|f)\b", r"\1", m.group(2))
+            expr = expr.replace("true", "1").replace("false", "0")
+            try:
+                values[m.group(1)] = eval(expr, {"__builtins__": {}}, dict(values))
+            except Exception:
+                pass
+    return values
+
+
+# ==========================================
+# DISCRETE-EVENT KERNEL
+# ==========================================
+
+class Resource:
+    def __init__(self, sim, name):
+        self.sim = sim
+        self.name = name
+        self.owner = None
+        self.waiters = []
+        self.busy = 0.0
+        self.since = 0.0
+
+    def request(self, proc):
+        if self.owner is None:
+            self.owner = proc
+            self.since = self.sim.now
+            self.sim.schedule(self.sim.now, proc)
+        else:
+            self.waiters.append(proc)
+
+    def release(self):
+        self.busy += self.sim.now - self.since
+        self.owner = None
+        if self.waiters:
+            self.request(self.waiters.pop(0))
+
+
+class Sim:
+    def __init__(self):
+        self.now = 0.0
+        self.queue = []
+        self.seq = 0
+
+    def schedule(self, t, proc, value=None):
+        heapq.heappush(self.queue, (t, self.seq, proc, value))
+        self.seq += 1
+
+    def start(self, gen):
+        self.schedule(self.now, gen)
+
+    def run(self, until):
+        while self.queue and self.queue[0][0] <= until:
+            t, _, proc, value = heapq.heappop(self.queue)
+            self.now = t
+            try:
+                cmd = proc.send(value)
+            except StopIteration:
+                continue
+            kind, arg = cmd
+            if kind == "delay":
+                self.schedule(self.now + arg, proc)
+            elif kind == "until":
+                self.schedule(max(arg, self.now), proc)
+            elif kind == "acquire":
+                arg.request(proc)
+            elif kind == "release":
+                arg.release()
+                self.schedule(self.now, proc)
+        self.now = until
+
+
+def use(res, duration):
+    yield ("acquire", res)
+    yield ("delay", duration)
+    yield ("release", res)
+
+
+# ==========================================
+# PIPELINE MODEL
+# ==========================================
+
+class Pipeline:
+    def __init__(self, cfg, cal, seed=1):
+        self.cfg = cfg
+        self.cal = cal
+        self.rng = random.Random(seed)
+        self.sim = Sim()
+        self.i2c = Resource(self.sim, "i2c")
+        self.spi = Resource(self.sim, "spi")
+        self.core = [Resource(self.sim, "core0"), Resource(self.sim, "core1")]
+
+        self.subpage_period = 1.0 / cfg["refresh"]
+        self.phase = self.rng.random() * self.subpage_period
+        self.last_subpage = -1
+
+        self.sensor_frames = 0
+        self.display_frames = 0
+        self.latencies = []
+        self.published = []          # capture times of conditioned frames
+
+    # --- costs ---------------------------------------------------------
+
+    def i2c_subpage_s(self):
+        data = self.cal["subpage_words"] * 2
+        chunks = math.ceil(data / self.cal["i2c_chunk_bytes"])
+        total = data + chunks * self.cal["i2c_chunk_overhead_bytes"]
+        return total * 9.0 / self.cfg["i2c_hz"]
+
+    def spi_push_s(self):
+        px = self.cfg["fb_w"] * self.cfg["fb_h"]
+        return px * 3 * 8.0 / self.cfg["spi_hz"] + self.cal["spi_overhead_s"]
+
+    def render_s(self):
+        px = self.cfg["fb_w"] * self.cfg["fb_h"]
+        per_px = self.cal["render_ns_per_px"] + (self.cal["edge_ns_per_px"] if self.cfg["edges"] else 0.0)
+        return px * per_px * 1e-9
+
+    def subpage_ready_time(self, k):
+        jitter = self.rng.uniform(-1, 1) * self.cal["jitter_frac"] * self.subpage_period
+        return self.phase + k * self.subpage_period + jitter
+
+    # --- stages --------------------------------------------------------
+
+    def get_frame(self, core):
+        """Adafruit getFrame(): two subpages, each wait + burst + CalculateTo."""
+        capture = 0.0
+        for _ in range(2):
+            available = math.floor((self.sim.now - self.phase) / self.subpage_period)
+            k = max(self.last_subpage + 1, available)
+            ready = self.subpage_ready_time(k)
+            yield ("until", ready)
+            self.last_subpage = k
+            capture = ready
+            yield from use(self.i2c, self.i2c_subpage_s())
+            yield from use(core, self.cal["calculate_to_s"])
+        yield from use(core, self.cal["condition_s"] + self.cal["ema_minmax_s"])
+        self.sensor_frames += 1
+        return capture
+
+    def render_and_push(self, content_time):
+        main = self.core[1]
+        render = self.render_s()
+        if self.cfg["parallel_render"]:
+            half = render / 2.0 / self.cal["parallel_efficiency"]
+            helper = self.sim_helper(self.core[0], half)
+            self.sim.start(helper)
+            yield from use(main, half)
+            while not self.helper_done:
+                yield ("delay", 1e-5)
+        else:
+            yield from use(main, render)
+
+        yield ("acquire", main)
+        yield from use(self.spi, self.spi_push_s())
+        yield ("delay", self.cal["markers_s"])
+        yield ("release", main)
+
+        self.display_frames += 1
+        self.latencies.append(self.sim.now - content_time)
+
+    def sim_helper(self, core, duration):
+        self.helper_done = False
+        yield from use(core, duration)
+        self.helper_done = True
+
+    def ui(self):
+        if self.sim.now - self.last_ui >= self.cal["ui_interval_s"]:
+            self.last_ui = self.sim.now
+            yield from use(self.core[1], self.cal["ui_s"])
+
+    # --- loops ---------------------------------------------------------
+
+    def sequential_loop(self):
+        self.last_ui = -1.0
+        while True:
+            capture = yield from self.get_frame(self.core[1])
+            yield from self.render_and_push(capture)
+            yield from self.ui()
+
+    def acquisition_task(self):
+        while True:
+            capture = yield from self.get_frame(self.core[0])
+            self.published.append(capture)
+
+    def display_loop(self):
+        self.last_ui = -1.0
+        period = 1.0 / self.cfg["target_fps"]
+        synth = self.cal["synth_motion_s"] if self.cfg["motion"] else self.cal["synth_blend_s"]
+        next_frame = 0.0
+        while True:
+            yield ("until", next_frame)
+            if len(self.published) < 2:
+                yield ("delay", 0.001)
+                next_frame = self.sim.now
+                continue
+            next_frame = self.sim.now + period
+            t_prev, t_latest = self.published[-2], self.published[-1]
+            sensor_period = max(t_latest - t_prev, 1e-6)
+            alpha = min(max((self.sim.now - t_latest) / sensor_period, 0.0), 1.0)
+            content = t_prev + alpha * sensor_period
+            yield from use(self.core[1], synth + self.cal["ema_minmax_s"])
+            yield from self.render_and_push(content)
+            yield from self.ui()
+
+    def run(self, seconds):
+        if self.cfg["interpolation"]:
+            self.sim.start(self.acquisition_task())
+            self.sim.start(self.display_loop())
+        else:
+            self.sim.start(self.sequential_loop())
+        self.sim.run(seconds)
+        for res in [self.i2c, self.spi] + self.core:
+            if res.owner is not None:
+                res.busy += self.sim.now - res.since
+                res.since = self.sim.now
+
+
+# ==========================================
+# REPORT
+# ==========================================
+
+def percentile(values, p):
+    if not values:
+        return float("nan")
+    ordered = sorted(values)
+    idx = min(len(ordered) - 1, int(round(p / 100.0 * (len(ordered) - 1))))
+    return ordered[idx]
+
+
+def report(pipe, seconds, cfg):
+    lat_ms = [v * 1000.0 for v in pipe.latencies[2:]]
+    print("configuration:")
+    print("  i2c %.0f kHz | spi %.0f MHz | refresh %g Hz | adc %d-bit | target %d fps"
+          % (cfg["i2c_hz"] / 1e3, cfg["spi_hz"] / 1e6, cfg["refresh"], cfg["adc_bits"], cfg["target_fps"]))
+    print("  interpolation %s%s | parallel render %s | edges %s"
+          % ("on" if cfg["interpolation"] else "off", " (motion)" if cfg["motion"] else "",
+             "on" if cfg["parallel_render"] else "off", "on" if cfg["edges"] else "off"))
+    print("per-frame costs:")
+    print("  i2c subpage %.2f ms | spi push %.2f ms | render %.2f ms"
+          % (pipe.i2c_subpage_s() * 1e3, pipe.spi_push_s() * 1e3, pipe.render_s() * 1e3))
+    print("predicted:")
+    print("  display fps %.1f | sensor frames/s %.1f"
+          % (pipe.display_frames / seconds, pipe.sensor_frames / seconds))
+    print("  latency ms: min %.1f | p50 %.1f | p90 %.1f | p99 %.1f | max %.1f"
+          % (min(lat_ms or [float("nan")]), percentile(lat_ms, 50), percentile(lat_ms, 90),
+             percentile(lat_ms, 99), max(lat_ms or [float("nan")])))
+    print("  utilisation: i2c %.0f%% (data only) | spi %.0f%% | core0 %.0f%% | core1 %.0f%%"
+          % tuple(100.0 * r.busy / seconds for r in [pipe.i2c, pipe.spi] + pipe.core))
+
+
+def main():
+    h = read_main_h()
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--i2c-hz", type=float, default=h.get("I2C_FREQ_HZ", 1000000))
+    parser.add_argument("--spi-hz", type=float, default=h.get("TFT_SPI_HZ", 80000000))
+    parser.add_argument("--refresh", type=float, default=h.get("SENSOR_FPS", 16), help="MLX90640 refresh (subpages/s)")
+    parser.add_argument("--adc-bits", type=int, default=18, choices=[16, 17, 18, 19])
+    parser.add_argument("--target-fps", type=int, default=h.get("TARGET_FPS", 32))
+    parser.add_argument("--fb", default="%dx%d" % (h.get("FB_WIDTH", 336), h.get("FB_HEIGHT", 320)))
+    parser.add_argument("--interpolation", dest="interpolation", action="store_true",
+                        default=bool(h.get("FRAME_INTERPOLATION", 0)))
+    parser.add_argument("--no-interpolation", dest="interpolation", action="store_false")
+    parser.add_argument("--motion", action="store_true",
+                        default=h.get("INTERP_MODE", 0) == h.get("INTERP_MOTION", 1))
+    parser.add_argument("--parallel-render", dest="parallel_render", action="store_true",
+                        default=bool(h.get("PARALLEL_RENDER", 0)))
+    parser.add_argument("--no-parallel-render", dest="parallel_render", action="store_false")
+    parser.add_argument("--no-edges", dest="edges", action="store_false",
+                        default=bool(h.get("EDGE_DETECTION_ENABLED", 1)))
+    parser.add_argument("--calibration", help="JSON file overriding CALIBRATION keys")
+    parser.add_argument("--seconds", type=float, default=20.0)
+    parser.add_argument("--seed", type=int, default=1)
+    args = parser.parse_args()
+
+    cal = dict(CALIBRATION)
+    if args.calibration:
+        with open(args.calibration) as f:
+            overrides = json.load(f)
+        unknown = set(overrides) - set(cal)
+        if unknown:
+            parser.error("unknown calibration keys: %s" % ", ".join(sorted(unknown)))
+        cal.update(overrides)
+
+    fb_w, fb_h = (int(v) for v in args.fb.lower().split("x"))
+    cfg = {
+        "i2c_hz": args.i2c_hz, "spi_hz": args.spi_hz, "refresh": args.refresh,
+        "adc_bits": args.adc_bits, "target_fps": args.target_fps, "fb_w": fb_w, "fb_h": fb_h,
+        "interpolation": args.interpolation, "motion": args.motion and args.interpolation,
+        "parallel_render": args.parallel_render, "edges": args.edges,
+    }
+
+    pipe = Pipeline(cfg, cal, args.seed)
+    pipe.run(args.seconds)
+    report(pipe, args.seconds, cfg)
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,158 @@
+#!/usr/bin/env python3
+
+"""
+Convert a binary trace dump from the thermal camera into Chrome / Perfetto
+trace JSON (open in chrome://tracing or https://ui.perfetto.dev).
+
+Capture:  send 't' to the device and save the raw serial output, e.g.
+          python3 trace_to_chrome.py --port /dev/ttyACM0 -o trace.json
+Convert:  python3 trace_to_chrome.py capture.bin -o trace.json
+
+The dump may be surrounded by normal log text; only the bytes between the
+"TRC1" and "TEND" markers are decoded.
+"""
+
+import argparse
+import json
+import struct
+import sys
+import time
+
+MAGIC = b"TRC1"
+END = b"TEND"
+RECORD = struct.Struct("<IBBH")
+
+
+def parse_at(data, start):
+    """Dump whose TRC1 header is at start: (names, per_core, end), or None
+    when the sizes in the header do not lead to a TEND trailer."""
+    pos = start + len(MAGIC)
+    if pos + 6 > len(data):
+        return None
+    cores, ring_size, event_count = struct.unpack_from("<HHH", data, pos)
+    pos += 6
+    if cores == 0 or ring_size == 0:
+        return None
+
+    names = []
+    for _ in range(event_count):
+        if pos >= len(data) or pos + 1 + data[pos] > len(data):
+            return None
+        length = data[pos]
+        try:
+            names.append(data[pos + 1:pos + 1 + length].decode("ascii"))
+        except UnicodeDecodeError:
+            return None
+        pos += 1 + length
+
+    end = pos + cores * (4 + ring_size * RECORD.size)
+    if data[end:end + len(END)] != END:
+        return None
+
+    per_core = []
+    for _ in range(cores):
+        (head,) = struct.unpack_from("<I", data, pos)
+        pos += 4
+        ring = [RECORD.unpack_from(data, pos + i * RECORD.size) for i in range(ring_size)]
+        pos += ring_size * RECORD.size
+
+        count = min(head, ring_size)
+        first = head - count
+        per_core.append([ring[(first + i) % ring_size] for i in range(count)])
+
+    return names, per_core, end + len(END)
+
+
+def parse_dump(data):
+    """Last complete dump in data. Markers are scanned forward, so a "TRC1"
+    inside a dump's records or inside log text is never taken for a header."""
+    found = None
+    pos = data.find(MAGIC)
+    if pos < 0:
+        raise ValueError("no TRC1 marker in input")
+    while pos >= 0:
+        dump = parse_at(data, pos)
+        if dump:
+            found = dump
+            pos = data.find(MAGIC, dump[2])
+        else:
+            pos = data.find(MAGIC, pos + 1)
+    if not found:
+        raise ValueError("no complete dump (no TRC1 header leads to a TEND trailer)")
+    return found[0], found[1]
+
+
+def to_chrome(names, per_core):
+    events = []
+    for core, records in enumerate(per_core):
+        last = None
+        offset = 0
+        for timestamp, phase, event, arg in records:
+            if last is not None and timestamp < last and last - timestamp > 0x80000000:
+                offset += 1 << 32
+            last = timestamp
+
+            name = names[event] if event < len(names) else "event_%d" % event
+            entry = {
+                "name": name,
+                "ph": chr(phase),
+                "ts": timestamp + offset,
+                "pid": 0,
+                "tid": core,
+            }
+            if entry["ph"] == "i":
+                entry["s"] = "t"
+                entry["args"] = {"arg": arg}
+            events.append(entry)
+
+    meta = [{"name": "thread_name", "ph": "M", "pid": 0, "tid": c, "args": {"name": "core %d" % c}}
+            for c in range(len(per_core))]
+    return {"traceEvents": meta + events, "displayTimeUnit": "ms"}
+
+
+def capture_serial(port, baud, timeout):
+    import serial  # pyserial, only needed for live capture
+
+    with serial.Serial(port, baud, timeout=0.2) as link:
+        link.reset_input_buffer()
+        link.write(b"t")
+        data = bytearray()
+        deadline = time.time() + timeout
+        while time.time() < deadline:
+            data += link.read(4096)
+            if END in data:
+                try:
+                    parse_dump(bytes(data))
+                    break
+                except ValueError:
+                    pass
+        return bytes(data)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("input", nargs="?", help="raw serial capture containing a trace dump")
+    parser.add_argument("-o", "--output", default="trace.json")
+    parser.add_argument("--port", help="capture live from this serial port instead of a file")
+    parser.add_argument("--baud", type=int, default=115200)
+    parser.add_argument("--timeout", type=float, default=10.0)
+    args = parser.parse_args()
+
+    if args.port:
+        data = capture_serial(args.port, args.baud, args.timeout)
+    elif args.input:
+        with open(args.input, "rb") as f:
+            data = f.read()
+    else:
+        parser.error("give an input file or --port")
+
+    names, per_core = parse_dump(data)
+    with open(args.output, "w") as f:
+        json.dump(to_chrome(names, per_core), f)
+
+    total = sum(len(r) for r in per_core)
+    print("wrote %d events from %d cores to %s" % (total, len(per_core), args.output))
+
+
+if __name__ == "__main__":
+    sys.exit(main())
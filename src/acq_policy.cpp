@@ -0,0 +1,100 @@
+#include "acq_policy.h"
+#include <math.h>
+#include <string.h>
+
+// Motion is the fraction of pixels whose change since the previous frame,
+// over the time between the two, exceeds ACQ_MOTION_RATE: the same scene
+// reads as the same motion at every refresh rate, and frames dropped in
+// between do not inflate it. Noise is the rms of the
+// remaining (static) differences divided by sqrt(2), i.e. per-frame temporal
+// noise. Any burst of motion jumps straight to the fastest level so panning
+// never smears; a long steady run walks one level slower at a time.
+
+using G = FrameGeom;
+
+static const AcqLevel levels[ACQ_LEVEL_COUNT] = ACQ_LEVELS;
+
+const AcqLevel &acqLevel(int level) {
+  return levels[level];
+}
+
+void initAcqPolicy(AcqPolicy &p, float *prevFrame, int level) {
+  p.prevFrame = prevFrame;
+  p.havePrev = false;
+  p.prevTimeMs = 0;
+  p.level = level;
+  p.dwell = ACQ_MIN_DWELL;
+  p.steadyFrames = 0;
+  p.motion = 0.0f;
+  p.noise = 0.0f;
+  for (int i = 0; i < ACQ_LEVEL_COUNT; i++) p.levelNoise[i] = 0.0f;
+}
+
+static void measure(AcqPolicy &p, const float *frame, uint32_t nowMs, float &moving, float &noise) {
+  // Two frames stamped alike (clock granularity) count as one period apart
+  uint32_t intervalMs = nowMs - p.prevTimeMs;
+  float seconds = intervalMs ? intervalMs * 0.001f : acqLevelLatencyMs(p.level) * 0.001f;
+  float delta = fmaxf(ACQ_MOTION_RATE * seconds, ACQ_MOTION_MIN_DELTA);
+
+  int movingCount = 0;
+  int staticCount = 0;
+  float sumSq = 0.0f;
+
+  for (int i = 0; i < G::pixels; i++) {
+    float d = frame[i] - p.prevFrame[i];
+    if (fabsf(d) > delta) {
+      movingCount++;
+    } else {
+      sumSq += d * d;
+      staticCount++;
+    }
+  }
+
+  moving = (float)movingCount / G::pixels;
+  noise = staticCount ? sqrtf(sumSq / staticCount * 0.5f) : 0.0f;
+}
+
+AcqDecision acqPolicyUpdate(AcqPolicy &p, const float *frame, uint32_t nowMs) {
+  AcqDecision d = {false, p.level, p.level, p.motion, p.levelNoise[p.level]};
+
+  bool measured = p.havePrev && p.dwell == 0;
+  if (measured) {
+    float moving, noise;
+    measure(p, frame, nowMs, moving, noise);
+    p.motion = p.motion * ACQ_MOTION_SMOOTH + moving * (1.0f - ACQ_MOTION_SMOOTH);
+    p.noise = noise;
+
+    float &ln = p.levelNoise[p.level];
+    ln = (ln == 0.0f) ? noise : ln * 0.9f + noise * 0.1f;
+  }
+
+  memcpy(p.prevFrame, frame, G::pixels * sizeof(float));
+  p.havePrev = true;
+  p.prevTimeMs = nowMs;
+  if (p.dwell > 0) p.dwell--;
+  if (!measured) return d;
+
+  int target = p.level;
+  if (p.motion > ACQ_MOTION_HIGH) {
+    target = ACQ_LEVEL_COUNT - 1;
+    p.steadyFrames = 0;
+  } else if (p.motion < ACQ_MOTION_LOW) {
+    if (++p.steadyFrames >= ACQ_STEADY_FRAMES && p.level > 0) {
+      target = p.level - 1;
+      p.steadyFrames = 0;
+    }
+  } else {
+    p.steadyFrames = 0;
+  }
+
+  if (target != p.level) {
+    d.changed = true;
+    d.to = target;
+    d.motion = p.motion;
+    d.noiseBefore = p.levelNoise[p.level];
+    p.level = target;
+    p.dwell = ACQ_MIN_DWELL;
+    p.havePrev = false;
+  }
+  return d;
+}
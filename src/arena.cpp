@@ -0,0 +1,104 @@
+#include "arena.h"
+#include <Arduino.h>
+
+static const char *arenaNames[ARENA_COUNT] = {"dma", "fast", "psram"};
+
+alignas(ARENA_ALIGN) static uint8_t arenaDmaStorage[memArenaSize(ARENA_DMA) + ARENA_ALIGN];
+alignas(ARENA_ALIGN) static uint8_t arenaFastStorage[memFastStorageSize() + ARENA_ALIGN];
+static uint8_t *arenaPsramStorage = nullptr;
+
+static uint8_t *arenaBase(MemArena arena) {
+  switch (arena) {
+    case ARENA_DMA:   return arenaDmaStorage;
+    case ARENA_FAST:  return arenaFastStorage;
+    case ARENA_PSRAM: return arenaPsramStorage;
+    default:          return nullptr;
+  }
+}
+
+static int fallbackSlot(MemBuffer id) {
+  for (int k = 0; k < MEM_FALLBACK_COUNT; k++) {
+    if (MEM_FALLBACK_SPECS[k].id == id) return k;
+  }
+  return -1;
+}
+
+// ==========================================
+// INITIALIZATION
+// ==========================================
+
+// A missing or failed PSRAM is not fatal: the fallback slots take over and
+// consumers size themselves from memBufferBytes()
+void initMemory() {
+  if (memArenaSize(ARENA_PSRAM) == 0 || arenaPsramStorage || !psramFound()) return;
+
+  void *block = heap_caps_calloc(1, memArenaSize(ARENA_PSRAM) + ARENA_ALIGN, MALLOC_CAP_SPIRAM);
+  if (!block) {
+    Serial.println("psram arena allocation error, using internal fallbacks");
+    return;
+  }
+  arenaPsramStorage = (uint8_t *)(((uintptr_t)block + ARENA_ALIGN - 1) & ~(uintptr_t)(ARENA_ALIGN - 1));
+}
+
+bool memHasPsram() {
+  return arenaPsramStorage != nullptr;
+}
+
+void *memBuffer(MemBuffer id) {
+  if (id < 0 || id >= BUF_COUNT) return nullptr;
+  if (MEM_BUFFER_SPECS[id].arena == ARENA_PSRAM && !arenaPsramStorage) {
+    int k = fallbackSlot(id);
+    return k >= 0 && MEM_FALLBACK_SPECS[k].bytes > 0 ? arenaFastStorage + memFallbackOffset(k) : nullptr;
+  }
+  uint8_t *base = arenaBase(MEM_BUFFER_SPECS[id].arena);
+  return base ? base + memOffset(id) : nullptr;
+}
+
+size_t memBufferBytes(MemBuffer id) {
+  if (id < 0 || id >= BUF_COUNT) return 0;
+  if (MEM_BUFFER_SPECS[id].arena == ARENA_PSRAM && !arenaPsramStorage) {
+    int k = fallbackSlot(id);
+    return k >= 0 ? MEM_FALLBACK_SPECS[k].bytes : 0;
+  }
+  return MEM_BUFFER_SPECS[id].bytes;
+}
+
+// ==========================================
+// BOOT REPORT
+// ==========================================
+
+void reportMemory() {
+  for (int a = 0; a < ARENA_COUNT; a++) {
+    if (a == ARENA_PSRAM && !arenaPsramStorage) {
+      Serial.printf("arena %-5s: not allocated (%u bytes wanted)\n", arenaNames[a],
+                    (unsigned)memArenaSize(ARENA_PSRAM));
+      continue;
+    }
+    Serial.printf("arena %-5s: %u bytes\n", arenaNames[a], (unsigned)memArenaSize((MemArena)a));
+
+    for (int i = 0; i < BUF_COUNT; i++) {
+      if (MEM_BUFFER_SPECS[i].arena != a) continue;
+      Serial.printf("  %-20s %7u bytes @ +%u\n", MEM_BUFFER_SPECS[i].name,
+                    (unsigned)MEM_BUFFER_SPECS[i].bytes, (unsigned)memOffset((MemBuffer)i));
+    }
+  }
+  for (int k = 0; k < MEM_FALLBACK_COUNT; k++) {
+    Serial.printf("  %-20s %7u bytes @ fast +%u (psram fallback%s)\n", MEM_BUFFER_SPECS[MEM_FALLBACK_SPECS[k].id].name,
+                  (unsigned)MEM_FALLBACK_SPECS[k].bytes, (unsigned)memFallbackOffset(k),
+                  arenaPsramStorage ? ", unused" : "");
+  }
+
+  size_t internalUsed = memArenaSize(ARENA_DMA) + memFastStorageSize();
+  Serial.printf("internal budget: %u / %u bytes (%.1f%%)\n", (unsigned)internalUsed,
+                (unsigned)INTERNAL_RAM_BUDGET, 100.0f * internalUsed / INTERNAL_RAM_BUDGET);
+  Serial.printf("heap internal: %u free, %u min free, %u largest block\n",
+                (unsigned)heap_caps_get_free_size(MALLOC_CAP_INTERNAL),
+                (unsigned)heap_caps_get_minimum_free_size(MALLOC_CAP_INTERNAL),
+                (unsigned)heap_caps_get_largest_free_block(MALLOC_CAP_INTERNAL));
+  if (arenaPsramStorage) {
+    Serial.printf("heap psram: %u free, %u min free\n",
+                  (unsigned)heap_caps_get_free_size(MALLOC_CAP_SPIRAM),
+                  (unsigned)heap_caps_get_minimum_free_size(MALLOC_CAP_SPIRAM));
+  }
+  Serial.printf("stack high-water (loop task): %u bytes free\n", (unsigned)uxTaskGetStackHighWaterMark(NULL));
+}
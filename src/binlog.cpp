@@ -0,0 +1,267 @@
+#include "binlog.h"
+#include <stdio.h>
+
+// Multi-producer, single-consumer ring of fixed-size records. Producers
+// claim a ticket with a CAS on head (refused when the ring is full, so a
+// slot is never reused before the drain has copied it), fill the slot and
+// publish it by storing seq = ticket + 1. The drain consumes in ticket
+// order and stops at the first slot that is not published yet. logFlush()
+// runs from the drain task and from the loop (before a burst export), so
+// consumers take drainLock: one at a time, records stay in order.
+
+static const char *formatStrings[LOG_FORMAT_COUNT] = {
+#define LOG_FORMAT_STRING(id, fmt) fmt,
+  LOG_FORMATS(LOG_FORMAT_STRING)
+#undef LOG_FORMAT_STRING
+};
+
+static LogRecord *logRing = nullptr;
+static uint32_t logHead = 0;
+static uint32_t logTail = 0;
+static uint32_t logDroppedCount = 0;
+static bool logPaused = false;
+
+static void logOutput(const LogRecord &rec);
+
+#if defined(ARDUINO)
+
+#include <Arduino.h>
+#include <freertos/semphr.h>
+#include "arena.h"
+
+static StaticSemaphore_t drainLockBuf;
+static SemaphoreHandle_t drainLock = nullptr;
+
+static void lockDrain() {
+  if (drainLock) xSemaphoreTake(drainLock, portMAX_DELAY);
+}
+
+static void unlockDrain() {
+  if (drainLock) xSemaphoreGive(drainLock);
+}
+
+static uint32_t logCore() {
+  return xPortGetCoreID();
+}
+
+static uint32_t logNowUs() {
+  return micros();
+}
+
+// Writes only what the TX buffer can take right now and sleeps in between,
+// so the drain never sits blocked inside Serial holding its lock
+static void serialWriteWhenFree(const uint8_t *data, size_t len) {
+  while (len > 0) {
+    int room = Serial.availableForWrite();
+    if (room <= 0) {
+      vTaskDelay(1);
+      continue;
+    }
+    size_t chunk = (size_t)room < len ? (size_t)room : len;
+    Serial.write(data, chunk);
+    data += chunk;
+    len -= chunk;
+  }
+}
+
+static void logDrainTask(void *param) {
+  for (;;) {
+    logFlush();
+    vTaskDelay(pdMS_TO_TICKS(LOG_DRAIN_PERIOD_MS));
+  }
+}
+
+void initLog() {
+  if (!LOG_DEFERRED || logRing) return;
+  logRing = memBufferAs<LogRecord>(BUF_LOG_RING);
+  drainLock = xSemaphoreCreateMutexStatic(&drainLockBuf);
+  static StaticTask_t drainTcb;
+  if (!xTaskCreateStaticPinnedToCore(logDrainTask, "logDrain", LOG_TASK_STACK, nullptr, LOG_TASK_PRIORITY,
+                                     memBufferAs<StackType_t>(BUF_STACK_LOG), &drainTcb, LOG_TASK_CORE)) {
+    logRing = nullptr;
+    Serial.println("log drain start failed, logging synchronously");
+  }
+}
+
+#else
+
+#include <chrono>
+#include <mutex>
+
+static LogRecord hostRing[LOG_RING_SIZE];
+static std::mutex drainLock;
+
+static void lockDrain() {
+  drainLock.lock();
+}
+
+static void unlockDrain() {
+  drainLock.unlock();
+}
+
+static uint32_t logCore() {
+  return 0;
+}
+
+static uint32_t logNowUs() {
+  using namespace std::chrono;
+  return (uint32_t)duration_cast<microseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+static void serialWriteWhenFree(const uint8_t *data, size_t len) {
+  fwrite(data, 1, len, stdout);
+}
+
+// Host tools call logFlush() themselves
+void initLog() {
+  if (LOG_DEFERRED) logRing = hostRing;
+}
+
+#endif
+
+// ==========================================
+// PRODUCERS
+// ==========================================
+
+static void fillRecord(LogRecord &rec, LogFormat format, const uint32_t *args, int argc) {
+  rec.timestampUs = logNowUs();
+  rec.format = format;
+  rec.argc = (uint8_t)argc;
+  rec.core = (uint8_t)logCore();
+  memcpy(rec.args, args, argc * sizeof(uint32_t));
+}
+
+void logPush(LogFormat format, const uint32_t *args, int argc) {
+  if (!logRing) {
+    if (__atomic_load_n(&logPaused, __ATOMIC_RELAXED)) {
+      __atomic_fetch_add(&logDroppedCount, 1, __ATOMIC_RELAXED);
+      return;
+    }
+    LogRecord rec;
+    rec.seq = 0;
+    fillRecord(rec, format, args, argc);
+    logOutput(rec);
+    return;
+  }
+
+  uint32_t ticket = __atomic_load_n(&logHead, __ATOMIC_RELAXED);
+  do {
+    if (ticket - __atomic_load_n(&logTail, __ATOMIC_ACQUIRE) >= LOG_RING_SIZE) {
+      __atomic_fetch_add(&logDroppedCount, 1, __ATOMIC_RELAXED);
+      return;
+    }
+  } while (!__atomic_compare_exchange_n(&logHead, &ticket, ticket + 1, true,
+                                        __ATOMIC_ACQ_REL, __ATOMIC_RELAXED));
+
+  LogRecord &slot = logRing[ticket & (LOG_RING_SIZE - 1)];
+  fillRecord(slot, format, args, argc);
+  __atomic_store_n(&slot.seq, ticket + 1, __ATOMIC_RELEASE);
+}
+
+// ==========================================
+// DRAIN
+// ==========================================
+
+// Callers hold drainLock
+static bool logPop(LogRecord &rec) {
+  if (!logRing) return false;
+  uint32_t tail = logTail;
+  LogRecord &slot = logRing[tail & (LOG_RING_SIZE - 1)];
+  if (__atomic_load_n(&slot.seq, __ATOMIC_ACQUIRE) != tail + 1) return false;
+
+  rec = slot;
+  __atomic_store_n(&logTail, tail + 1, __ATOMIC_RELEASE);
+  return true;
+}
+
+void logFlush() {
+  LogRecord rec;
+  lockDrain();
+  while (!logPaused && logPop(rec)) logOutput(rec);
+  unlockDrain();
+}
+
+// Taking drainLock waits out a drain that is mid-record, so nothing from
+// the log reaches the serial port after logPause(true) returns
+void logPause(bool pause) {
+  lockDrain();
+  __atomic_store_n(&logPaused, pause, __ATOMIC_RELAXED);
+  unlockDrain();
+}
+
+static void logOutput(const LogRecord &rec) {
+  if (LOG_DRAIN_BINARY) {
+    // Framed for scripts/log_decode.py: RS, 'L', record
+    uint8_t frame[2 + sizeof(LogRecord)] = {0x1E, 'L'};
+    memcpy(frame + 2, &rec, sizeof(rec));
+    serialWriteWhenFree(frame, sizeof(frame));
+    return;
+  }
+
+  char line[160];
+  int len = logFormat(rec, line, sizeof(line));
+  if (len > 0) serialWriteWhenFree((const uint8_t*)line, len);
+}
+
+// ==========================================
+// FORMATTING
+// ==========================================
+
+const char *logFormatString(uint16_t format) {
+  return format < LOG_FORMAT_COUNT ? formatStrings[format] : nullptr;
+}
+
+uint32_t logDropped() {
+  return __atomic_load_n(&logDroppedCount, __ATOMIC_RELAXED);
+}
+
+// printf, one conversion at a time, with the argument type taken from the
+// conversion character
+int logFormat(const LogRecord &rec, char *out, size_t size) {
+  const char *fmt = logFormatString(rec.format);
+  if (!fmt || size == 0) return 0;
+
+  size_t pos = 0;
+  int arg = 0;
+  out[0] = '\0';
+
+  while (*fmt && pos + 1 < size) {
+    if (*fmt != '%') {
+      out[pos++] = *fmt++;
+      continue;
+    }
+    if (fmt[1] == '%') {
+      out[pos++] = '%';
+      fmt += 2;
+      continue;
+    }
+
+    char spec[16];
+    size_t n = 0;
+    spec[n++] = *fmt++;
+    while (*fmt && strchr("-+ #0123456789.", *fmt) && n < sizeof(spec) - 2) spec[n++] = *fmt++;
+    while (*fmt && strchr("hlLqjzt", *fmt)) fmt++;
+    char conv = *fmt ? *fmt++ : 'd';
+    spec[n++] = conv;
+    spec[n] = '\0';
+
+    uint32_t word = arg < rec.argc ? rec.args[arg] : 0;
+    arg++;
+
+    int written;
+    if (strchr("fFeEgG", conv)) {
+      float f;
+      memcpy(&f, &word, sizeof(f));
+      written = snprintf(out + pos, size - pos, spec, (double)f);
+    } else if (conv == 'd' || conv == 'i') {
+      written = snprintf(out + pos, size - pos, spec, (int)(int32_t)word);
+    } else {
+      written = snprintf(out + pos, size - pos, spec, (unsigned)word);
+    }
+    if (written < 0) break;
+    pos += (size_t)written < size - pos ? (size_t)written : size - pos - 1;
+  }
+
+  out[pos] = '\0';
+  return (int)pos;
+}
@@ -0,0 +1,40 @@
+#include "burst.h"
+
+void initBurst(BurstRing &b, BurstSample *samples, int capacity) {
+  b.samples = samples;
+  b.capacity = capacity;
+  burstReset(b);
+}
+
+void burstReset(BurstRing &b) {
+  b.head = 0;
+  b.count = 0;
+  b.captured = 0;
+  b.errors = 0;
+}
+
+BurstSample &burstNext(BurstRing &b) {
+  return b.samples[b.head];
+}
+
+void burstCommit(BurstRing &b, const BurstSample &s) {
+  b.head = (b.head + 1) % b.capacity;
+  if (b.count < b.capacity) b.count++;
+  b.captured++;
+  if (s.status < 0) b.errors++;
+}
+
+BurstSample &burstSample(const BurstRing &b, int k) {
+  int oldest = (b.head - b.count + b.capacity) % b.capacity;
+  return b.samples[(oldest + k) % b.capacity];
+}
+
+uint32_t burstSpanUs(const BurstRing &b) {
+  if (b.count < 2) return 0;
+  return burstSample(b, b.count - 1).timestampUs - burstSample(b, 0).timestampUs;
+}
+
+float burstRateHz(const BurstRing &b) {
+  uint32_t span = burstSpanUs(b);
+  return span > 0 ? (b.count - 1) * 1000000.0f / span : 0.0f;
+}
@@ -0,0 +1,77 @@
+#include "bus_stats.h"
+#include "binlog.h"
+#include <string.h>
+
+// MIPI DCS column / row address set
+#define DCS_CASET 0x2A
+#define DCS_RASET 0x2B
+
+static const char *siteNames[BUS_SITE_COUNT] = {
+#define BUS_SITE_NAME(id, name) name,
+  BUS_SITES(BUS_SITE_NAME)
+#undef BUS_SITE_NAME
+};
+
+BusLedger displayBusLedger;
+
+void initBusLedger(BusLedger &l) {
+  memset(&l, 0, sizeof(l));
+  l.site = BUS_SITE_OTHER;
+}
+
+void busOnBeginWrite(BusLedger &l) {
+  l.current[l.site].transactions++;
+  l.current[l.site].csToggles++;
+}
+
+void busOnEndWrite(BusLedger &l) {
+  l.current[l.site].csToggles++;
+}
+
+void busOnCommand(BusLedger &l, uint8_t cmd) {
+  l.current[l.site].bytes++;
+  if (cmd == DCS_CASET || cmd == DCS_RASET) l.current[l.site].windowChanges++;
+}
+
+void busOnData(BusLedger &l, uint32_t bytes) {
+  l.current[l.site].bytes += bytes;
+}
+
+bool busFrameEnd(BusLedger &l, uint32_t byteBudget) {
+  memcpy(l.lastFrame, l.current, sizeof(l.lastFrame));
+  memset(l.current, 0, sizeof(l.current));
+  l.frames++;
+
+  uint32_t bytes = busLastFrameTotal(l).bytes;
+  if (bytes > l.worstFrameBytes) l.worstFrameBytes = bytes;
+  if (byteBudget && bytes > byteBudget) {
+    l.framesOverBudget++;
+    return false;
+  }
+  return true;
+}
+
+BusCounters busLastFrameTotal(const BusLedger &l) {
+  BusCounters total = {0, 0, 0, 0};
+  for (int s = 0; s < BUS_SITE_COUNT; s++) {
+    total.bytes += l.lastFrame[s].bytes;
+    total.transactions += l.lastFrame[s].transactions;
+    total.windowChanges += l.lastFrame[s].windowChanges;
+    total.csToggles += l.lastFrame[s].csToggles;
+  }
+  return total;
+}
+
+const char *busSiteName(BusSite site) {
+  return site < BUS_SITE_COUNT ? siteNames[site] : "?";
+}
+
+void busReport(const BusLedger &l) {
+  static_assert(BUS_SITE_COUNT == 6, "LOG_BUS_SITES lists one field per site");
+  BusCounters total = busLastFrameTotal(l);
+  logWrite(LOG_BUS_TOTAL, total.bytes, total.transactions, total.windowChanges, total.csToggles,
+           l.worstFrameBytes, l.framesOverBudget);
+  logWrite(LOG_BUS_SITES, l.lastFrame[BUS_SITE_OTHER].bytes, l.lastFrame[BUS_SITE_FRAME].bytes,
+           l.lastFrame[BUS_SITE_MARKERS].bytes, l.lastFrame[BUS_SITE_HOTSPOTS].bytes,
+           l.lastFrame[BUS_SITE_LEGEND].bytes, l.lastFrame[BUS_SITE_MENU].bytes);
+}
@@ -1,35 +1,65 @@
 #include "button.h"
 #include <Arduino.h>
+#include "trace.h"
 
+static inline ButtonEvent releaseEvent(uint32_t heldMs) {
+  return heldMs >= BTN_LONG_PRESS_MS ? BTN_LONG : BTN_SHORT;
+}
 
 #if USE_INTERRUPTS
-static volatile bool pressDetected = false;
+static volatile bool pressing = false;
+static volatile bool holdFired = false;
+static volatile ButtonEvent detected = BTN_NONE;
+static volatile uint32_t pressStartTime = 0;
 static volatile uint32_t lastInterruptTime = 0;
 
 void IRAM_ATTR buttonISR() {
+  traceInstant(TRACE_BUTTON_ISR);
   uint32_t now = millis();
-  if (now - lastInterruptTime > BTN_DEBOUNCE_MS) {
-    pressDetected = true;
-    lastInterruptTime = now;
+  if (now - lastInterruptTime <= BTN_DEBOUNCE_MS) return;
+  lastInterruptTime = now;
+
+  if (digitalRead(BTN_PIN) == LOW) {
+    pressing = true;
+    holdFired = false;
+    pressStartTime = now;
+  } else if (pressing) {
+    pressing = false;
+    if (!holdFired) detected = releaseEvent(now - pressStartTime);
   }
 }
 
 void initButton() {
   pinMode(BTN_PIN, INPUT_PULLUP);
-  delay(DISPLAY_INIT_DELAY);
-  attachInterrupt(digitalPinToInterrupt(BTN_PIN), buttonISR, FALLING);
+  if (!FAST_BOOT) delay(DISPLAY_INIT_DELAY);
+  attachInterrupt(digitalPinToInterrupt(BTN_PIN), buttonISR, CHANGE);
 }
 
 void buttonUpdate() {
+  if (!pressing) return;
+  uint32_t now = millis();
 
-}
+  // A release edge lost inside the debounce window would leave the press open
+  if (digitalRead(BTN_PIN) == HIGH && now - lastInterruptTime > BTN_DEBOUNCE_MS) {
+    noInterrupts();
+    pressing = false;
+    if (!holdFired) detected = releaseEvent(now - pressStartTime);
+    interrupts();
+    return;
+  }
 
-bool buttonPressed() {
-  if (pressDetected) {
-    pressDetected = false;
-    return true;
+  if (!holdFired && now - pressStartTime >= BTN_HOLD_PRESS_MS) {
+    holdFired = true;
+    detected = BTN_HOLD;
   }
-  return false;
+}
+
+ButtonEvent buttonEvent() {
+  noInterrupts();
+  ButtonEvent event = detected;
+  detected = BTN_NONE;
+  interrupts();
+  return event;
 }
 
 #else
@@ -37,11 +67,13 @@ bool buttonPressed() {
 static int lastStableState = HIGH;
 static int currentRawState = HIGH;
 static uint32_t lastChangeTime = 0;
-static bool pressDetected = false;
+static uint32_t pressStartTime = 0;
+static bool holdFired = false;
+static ButtonEvent pendingEvent = BTN_NONE;
 
 void initButton() {
   pinMode(BTN_PIN, INPUT_PULLUP);
-  delay(DISPLAY_INIT_DELAY);
+  if (!FAST_BOOT) delay(DISPLAY_INIT_DELAY);
   lastStableState = digitalRead(BTN_PIN);
   currentRawState = lastStableState;
   lastChangeTime = millis();
@@ -61,17 +93,23 @@ void buttonUpdate() {
   if (rawState != lastStableState && (now - lastChangeTime >= BTN_DEBOUNCE_MS)) {
     lastStableState = rawState;
     if (rawState == LOW) {
-      pressDetected = true;
+      pressStartTime = now;
+      holdFired = false;
+    } else if (!holdFired) {
+      pendingEvent = releaseEvent(now - pressStartTime);
     }
   }
-}
 
-bool buttonPressed() {
-  if (pressDetected) {
-    pressDetected = false;
-    return true;
+  if (lastStableState == LOW && !holdFired && now - pressStartTime >= BTN_HOLD_PRESS_MS) {
+    holdFired = true;
+    pendingEvent = BTN_HOLD;
   }
-  return false;
 }
 
-#endif
\ No newline at end of file
+ButtonEvent buttonEvent() {
+  ButtonEvent event = pendingEvent;
+  pendingEvent = BTN_NONE;
+  return event;
+}
+
+#endif
@@ -0,0 +1,146 @@
+#include "calib_cache.h"
+#include "checksum.h"
+#include <stdio.h>
+#include <string.h>
+
+static const uint32_t CALIB_MAGIC = 0x4C41434DUL;  // "MCAL"
+
+static const uint16_t *deviceIdOf(const uint16_t *probeWords) {
+  return &probeWords[MLX_DEVICE_ID_OFFSET];
+}
+
+// ==========================================
+// RECORD FORMAT
+// ==========================================
+
+void calibMakeHeader(CalibCacheHeader &h, const uint16_t *eeprom, const void *params, size_t paramsBytes) {
+  memset(&h, 0, sizeof(h));
+  h.magic = CALIB_MAGIC;
+  h.version = CALIB_CACHE_VERSION;
+  h.sensorModel = SENSOR_MODEL;
+  memcpy(h.deviceId, deviceIdOf(eeprom), sizeof(h.deviceId));
+  h.eepromCrc = crc32Bytes(eeprom, MLX_EEPROM_WORDS * sizeof(uint16_t));
+  h.probeCrc = crc32Bytes(eeprom, CALIB_PROBE_WORDS * sizeof(uint16_t));
+  h.paramsBytes = paramsBytes;
+  h.paramsCrc = crc32Bytes(params, paramsBytes);
+}
+
+bool calibHeaderMatches(const CalibCacheHeader &h, const uint16_t *probeWords, size_t paramsBytes) {
+  if (h.magic != CALIB_MAGIC || h.version != CALIB_CACHE_VERSION || h.sensorModel != SENSOR_MODEL) return false;
+  if (memcmp(h.deviceId, deviceIdOf(probeWords), sizeof(h.deviceId)) != 0) return false;
+  if (h.probeCrc != crc32Bytes(probeWords, CALIB_PROBE_WORDS * sizeof(uint16_t))) return false;
+  return h.paramsBytes == paramsBytes;
+}
+
+size_t calibPackRecord(uint8_t *out, size_t outBytes, const uint16_t *eeprom,
+                       const void *params, size_t paramsBytes) {
+  const size_t total = sizeof(CalibCacheHeader) + paramsBytes;
+  if (outBytes < total) return 0;
+
+  CalibCacheHeader h;
+  calibMakeHeader(h, eeprom, params, paramsBytes);
+  memcpy(out, &h, sizeof(h));
+  memcpy(out + sizeof(h), params, paramsBytes);
+  return total;
+}
+
+bool calibUnpackRecord(const uint8_t *record, size_t recordBytes, const uint16_t *probeWords,
+                       void *params, size_t paramsBytes) {
+  if (recordBytes != sizeof(CalibCacheHeader) + paramsBytes) return false;
+
+  CalibCacheHeader h;
+  memcpy(&h, record, sizeof(h));
+  if (!calibHeaderMatches(h, probeWords, paramsBytes)) return false;
+
+  const uint8_t *payload = record + sizeof(h);
+  if (h.paramsCrc != crc32Bytes(payload, paramsBytes)) return false;
+
+  memcpy(params, payload, paramsBytes);
+  return true;
+}
+
+// ==========================================
+// STORE (NVS on device, in-memory on host)
+// ==========================================
+
+// NVS keys are limited to 15 characters: prefix + 12 hex digits of the ID
+static void recordKey(char *key, char prefix, const uint16_t *deviceId) {
+  snprintf(key, 16, "%c%04x%04x%04x", prefix, deviceId[0], deviceId[1], deviceId[2]);
+}
+
+#if defined(ARDUINO)
+
+#include <Arduino.h>
+#include <Preferences.h>
+
+static Preferences calibPrefs;
+
+// Header under "h<id>", parameters under "p<id>"; the parameters are read
+// straight into the caller's struct and only trusted once their CRC matches
+bool calibCacheLoad(const uint16_t *probeWords, void *params, size_t paramsBytes) {
+  if (!CALIB_CACHE_ENABLED) return false;
+
+  char headerKey[16], paramsKey[16];
+  recordKey(headerKey, 'h', deviceIdOf(probeWords));
+  recordKey(paramsKey, 'p', deviceIdOf(probeWords));
+  if (!calibPrefs.begin(CALIB_CACHE_NAMESPACE, true)) return false;
+
+  CalibCacheHeader h;
+  bool ok = calibPrefs.getBytes(headerKey, &h, sizeof(h)) == sizeof(h) &&
+            calibHeaderMatches(h, probeWords, paramsBytes) &&
+            calibPrefs.getBytesLength(paramsKey) == paramsBytes &&
+            calibPrefs.getBytes(paramsKey, params, paramsBytes) == paramsBytes &&
+            crc32Bytes(params, paramsBytes) == h.paramsCrc;
+
+  calibPrefs.end();
+  return ok;
+}
+
+bool calibCacheStore(const uint16_t *eeprom, const void *params, size_t paramsBytes) {
+  if (!CALIB_CACHE_ENABLED) return false;
+
+  char headerKey[16], paramsKey[16];
+  recordKey(headerKey, 'h', deviceIdOf(eeprom));
+  recordKey(paramsKey, 'p', deviceIdOf(eeprom));
+  CalibCacheHeader h;
+  calibMakeHeader(h, eeprom, params, paramsBytes);
+
+  // Parameters first: a header is only ever written next to its parameters
+  bool ok = false;
+  if (calibPrefs.begin(CALIB_CACHE_NAMESPACE, false)) {
+    calibPrefs.remove(headerKey);
+    ok = calibPrefs.putBytes(paramsKey, params, paramsBytes) == paramsBytes &&
+         calibPrefs.putBytes(headerKey, &h, sizeof(h)) == sizeof(h);
+    calibPrefs.end();
+  }
+
+  if (!ok) Serial.println("calibration cache write failed");
+  return ok;
+}
+
+#else
+
+#include <map>
+#include <string>
+#include <vector>
+
+static std::map<std::string, std::vector<uint8_t>> calibStore;
+
+bool calibCacheLoad(const uint16_t *probeWords, void *params, size_t paramsBytes) {
+  char key[16];
+  recordKey(key, 'c', deviceIdOf(probeWords));
+  auto it = calibStore.find(key);
+  return it != calibStore.end() &&
+         calibUnpackRecord(it->second.data(), it->second.size(), probeWords, params, paramsBytes);
+}
+
+bool calibCacheStore(const uint16_t *eeprom, const void *params, size_t paramsBytes) {
+  char key[16];
+  recordKey(key, 'c', deviceIdOf(eeprom));
+  std::vector<uint8_t> record(sizeof(CalibCacheHeader) + paramsBytes);
+  calibPackRecord(record.data(), record.size(), eeprom, params, paramsBytes);
+  calibStore[key] = std::move(record);
+  return true;
+}
+
+#endif
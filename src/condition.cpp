@@ -0,0 +1,107 @@
+#include "condition.h"
+#include "pipeline.h"
+#include <math.h>
+#include <string.h>
+
+using G = FrameGeom;
+
+static inline bool isInvalidTemp(float t) {
+  return isnan(t) || t < -40.0f || t > 300.0f;
+}
+
+static float interpolateFromNeighbors(const FrameConditioner &c, const float *buf, int x, int y) {
+  float sum = 0.0f;
+  int count = 0;
+
+  const int dx[] = {-1, 1, 0, 0};
+  const int dy[] = {0, 0, -1, 1};
+  
+  for (int i = 0; i < 4; i++) {
+    int nx = x + dx[i];
+    int ny = y + dy[i];
+
+    if (nx >= 0 && nx < G::width && ny >= 0 && ny < G::height) {
+      int idx = ny * G::width + nx;
+      float val = buf[idx];
+
+      if (!isInvalidTemp(val)) {
+        sum += val;
+        count++;
+      }
+    }
+  }
+  
+  if (count > 0) {
+    return sum / count;
+  }
+  if (c.lastValidInitialized) {
+    int idx = y * G::width + x;
+    return c.lastValid[idx];
+  }
+  return 25.0f;
+}
+
+void initConditioner(FrameConditioner &c, float *temporalBase, float *lastValid) {
+  for (int i = 0; i < TEMPORAL_FILTER_SIZE; i++) {
+    c.temporal[i] = temporalBase + i * G::pixels;
+  }
+  memset(temporalBase, 0, TEMPORAL_FILTER_SIZE * G::pixels * sizeof(float));
+  c.temporalIndex = 0;
+  c.temporalFilled = false;
+  c.lastValid = lastValid;
+  c.lastValidInitialized = false;
+}
+
+int countInvalidPixels(const float *buf, int pixels) {
+  int count = 0;
+  for (int i = 0; i < pixels; i++) {
+    if (isInvalidTemp(buf[i])) count++;
+  }
+  return count;
+}
+
+bool conditionRawFrame(FrameConditioner &c, const float *raw, float *out, int &invalidCount,
+                       int missingPixels) {
+  memcpy(c.temporal[c.temporalIndex], raw, G::pixels * sizeof(float));
+  c.temporalIndex = (c.temporalIndex + 1) % TEMPORAL_FILTER_SIZE;
+  
+  if (c.temporalIndex == 0) {
+    c.temporalFilled = true;
+  }
+  
+  if (c.temporalFilled) {
+    medianOf3Frames<G>(c.temporal[0], c.temporal[1], c.temporal[2], out);
+  } else if (out != raw) {
+    memcpy(out, raw, G::pixels * sizeof(float));
+  }
+  
+  invalidCount = 0;
+  bool pixelFixed[G::pixels] = {false};
+
+  for (int i = 0; i < G::pixels; i++) {
+    if (isInvalidTemp(out[i])) {
+      pixelFixed[i] = true;
+      invalidCount++;
+    }
+  }
+
+  int unexpected = invalidCount > missingPixels ? invalidCount - missingPixels : 0;
+  if (unexpected > (G::pixels - missingPixels) / 4) {
+    return false;
+  }
+  
+  if (invalidCount > 0) {
+    for (int y = 0; y < G::height; y++) {
+      for (int x = 0; x < G::width; x++) {
+        int idx = y * G::width + x;
+        if (pixelFixed[idx]) {
+          out[idx] = interpolateFromNeighbors(c, out, x, y);
+        }
+      }
+    }
+  }
+
+  memcpy(c.lastValid, out, G::pixels * sizeof(float));
+  c.lastValidInitialized = true;
+  return true;
+}
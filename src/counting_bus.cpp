@@ -0,0 +1,88 @@
+#include "counting_bus.h"
+
+bool CountingBus::begin(int32_t speed, int8_t dataMode) {
+  return inner->begin(speed, dataMode);
+}
+
+void CountingBus::beginWrite() {
+  busOnBeginWrite(ledger);
+  inner->beginWrite();
+}
+
+void CountingBus::endWrite() {
+  busOnEndWrite(ledger);
+  inner->endWrite();
+}
+
+void CountingBus::writeCommand(uint8_t c) {
+  busOnCommand(ledger, c);
+  inner->writeCommand(c);
+}
+
+void CountingBus::writeCommand16(uint16_t c) {
+  busOnCommand(ledger, (uint8_t)c);
+  busOnData(ledger, 1);
+  inner->writeCommand16(c);
+}
+
+void CountingBus::write(uint8_t d) {
+  busOnData(ledger, 1);
+  inner->write(d);
+}
+
+void CountingBus::write16(uint16_t d) {
+  busOnData(ledger, 2);
+  inner->write16(d);
+}
+
+void CountingBus::writeC8D8(uint8_t c, uint8_t d) {
+  busOnCommand(ledger, c);
+  busOnData(ledger, 1);
+  inner->writeC8D8(c, d);
+}
+
+
+void CountingBus::writeC8D16(uint8_t c, uint16_t d) {
+  busOnCommand(ledger, c);
+  busOnData(ledger, 2);
+  inner->writeC8D16(c, d);
+}
+
+void CountingBus::writeC8D16D16(uint8_t c, uint16_t d1, uint16_t d2) {
+  busOnCommand(ledger, c);
+  busOnData(ledger, 4);
+  inner->writeC8D16D16(c, d1, d2);
+}
+
+
+void CountingBus::writeRepeat(uint16_t p, uint32_t len) {
+  busOnData(ledger, len * 2);
+  inner->writeRepeat(p, len);
+}
+
+void CountingBus::writePixels(uint16_t *data, uint32_t len) {
+  busOnData(ledger, len * 2);
+  inner->writePixels(data, len);
+}
+
+void CountingBus::writeBytes(uint8_t *data, uint32_t len) {
+  busOnData(ledger, len);
+  inner->writeBytes(data, len);
+}
+
+void CountingBus::writePattern(uint8_t *data, uint8_t len, uint32_t repeat) {
+  busOnData(ledger, (uint32_t)len * repeat);
+  inner->writePattern(data, len, repeat);
+}
+
+void CountingBus::writeIndexedPixels(uint8_t *data, uint16_t *idx, uint32_t len) {
+  busOnData(ledger, len * 2);
+  inner->writeIndexedPixels(data, idx, len);
+}
+
+void CountingBus::writeIndexedPixelsDouble(uint8_t *data, uint16_t *idx, uint32_t len) {
+  busOnData(ledger, len * 4);
+  inner->writeIndexedPixelsDouble(data, idx, len);
+}
+
+
@@ -1,13 +1,39 @@
 #include "display.h"
-#include <malloc.h>
-
-Arduino_DataBus *bus = new Arduino_ESP32SPI(
+#include "arena.h"
+#include "bus_stats.h"
+#include "checksum.h"
+#include "counting_bus.h"
+#include "hotspot.h"
+#include "isotherm.h"
+#include "palette.h"
+#include "panel_push.h"
+#include "quality.h"
+#include "render.h"
+#include "render_parallel.h"
+#include "trace.h"
+
+static Arduino_DataBus *spiBus = new Arduino_ESP32SPI(
   TFT_DC_PIN, TFT_CS_PIN, TFT_SCK_PIN, TFT_MOSI_PIN, TFT_MISO_PIN, (int32_t)TFT_SPI_HZ
 );
 
-Arduino_GFX *gfx = new Arduino_ILI9488_18bit(bus, TFT_RST_PIN, 1);
-static uint16_t *frameBuffer = nullptr;
-static float *gradientBuffer = nullptr;
+#if BUS_STATS_ENABLED
+Arduino_DataBus *bus = new CountingBus(spiBus, displayBusLedger);
+#else
+Arduino_DataBus *bus = spiBus;
+#endif
+
+static Arduino_ILI9488_18bit *panel = new Arduino_ILI9488_18bit(bus, TFT_RST_PIN, 1);
+Arduino_GFX *gfx = panel;
+static FbPixel *frameBuffer = nullptr;
+static uint8_t *pushLines = nullptr;
+static const uint16_t *pushedLUT = nullptr;
+static uint8_t *edgeMask = nullptr;
+static float *renderRows = nullptr;
+static FoveaMap<FbGeom> foveaMap;
+static int lastFoveaPixels = 0;
+static uint32_t lastRenderUs = 0;
+static uint32_t lastPushUs = 0;
+static int renderQuality = QUALITY_FULL;
 static float smoothedMinTemp = 0.0f;
 static float smoothedMaxTemp = 0.0f;
 static bool firstTempUpdate = true;
@@ -17,10 +43,16 @@ static int minTempX = 0;
 static int minTempY = 0;
 static int maxTempX = 0;
 static int maxTempY = 0;
-static float menuItemAlpha[MODE_COUNT] = {1.0f, 0.3f, 0.3f, 0.3f};
-static float menuItemTargetAlpha[MODE_COUNT] = {1.0f, 0.3f, 0.3f, 0.3f};
+static bool minTempVisible = true;
+static bool maxTempVisible = true;
+static float menuItemAlpha[MODE_COUNT] = {1.0f, 0.3f, 0.3f, 0.3f, 0.3f};
+static float menuItemTargetAlpha[MODE_COUNT] = {1.0f, 0.3f, 0.3f, 0.3f, 0.3f};
 static const float MENU_ANIM_SPEED = 0.15f;
 
+static const float isoLevels[ISOTHERM_LEVEL_COUNT] = ISOTHERM_LEVELS;
+static IsoSegment isoSegments[ISOTHERM_ENABLED ? ISOTHERM_MAX_SEGMENTS : 1];
+static int isoSegmentCount = 0;
+
 static uint16_t colorLUT[COLOR_LUT_SIZE];
 static uint16_t colorLUT_RGB[COLOR_LUT_SIZE];
 static bool lutInitialized = false;
@@ -32,106 +64,12 @@ static bool lutInitialized = false;
 static void initColorLUT() {
   if (lutInitialized) return;
   
-  for (int i = 0; i < COLOR_LUT_SIZE; i++) {
-    float n = (float)i / (COLOR_LUT_SIZE - 1);
-    uint8_t r, g, b;
-    
-    if (n < 0.15f) {
-      float f = n / 0.15f;
-      r = (uint8_t)(50 * f);
-      g = 0;
-      b = (uint8_t)(80 + 175 * f);
-    }
-    else if (n < 0.30f) {
-      float f = (n - 0.15f) / 0.15f;
-      r = (uint8_t)(50 + 155 * f);
-      g = 0;
-      b = 255;
-    }
-    else if (n < 0.45f) {
-      float f = (n - 0.30f) / 0.15f;
-      r = 205 + (uint8_t)(50 * f);
-      g = 0;
-      b = (uint8_t)(255 * (1.0f - f));
-    }
-    else if (n < 0.60f) {
-      float f = (n - 0.45f) / 0.15f;
-      r = 255;
-      g = (uint8_t)(80 * f);
-      b = 0;
-    }
-    else if (n < 0.75f) {
-      float f = (n - 0.60f) / 0.15f;
-      r = 255;
-      g = (uint8_t)(80 + 175 * f);
-      b = 0;
-    }
-    else if (n < 0.90f) {
-      float f = (n - 0.75f) / 0.15f;
-      r = 255;
-      g = 255;
-      b = (uint8_t)(255 * f);
-    }
-    else {
-      r = 255;
-      g = 255;
-      b = 255;
-    }
-    
-    colorLUT[i] = ((r & 0xF8) << 8) | ((g & 0xFC) << 3) | (b >> 3);
-
-    if (n < 0.25f) {
-      float f = n / 0.25f;
-      r = 0;
-      g = (uint8_t)(255 * f);
-      b = 255;
-    }
-    else if (n < 0.5f) {
-      float f = (n - 0.25f) / 0.25f;
-      r = 0;
-      g = 255;
-      b = (uint8_t)(255 * (1.0f - f));
-    }
-    else if (n < 0.75f) {
-      float f = (n - 0.5f) / 0.25f;
-      r = (uint8_t)(255 * f);
-      g = 255;
-      b = 0;
-    }
-    else {
-      float f = (n - 0.75f) / 0.25f;
-      r = 255;
-      g = (uint8_t)(255 * (1.0f - f));
-      b = 0;
-    }
-    
-    colorLUT_RGB[i] = ((r & 0xF8) << 8) | ((g & 0xFC) << 3) | (b >> 3);
-  }
+  buildPalette(PALETTE_IRON, colorLUT);
+  buildPalette(PALETTE_RAINBOW, colorLUT_RGB);
   
   lutInitialized = true;
 }
 
-// ==========================================
-// FAST COLOR LOOKUP
-// ==========================================
-
-static inline uint16_t tempToColorFast(float t, float tMin, float tMax, bool useRGB) {
-  if (!AUTO_SCALE) {
-    tMin = TEMP_MIN_CLAMP;
-    tMax = TEMP_MAX_CLAMP;
-  }
-
-  t = constrain(t, tMin, tMax);
-  float range = tMax - tMin;
-  if (range < MIN_RANGE_DEFAULT) range = MIN_RANGE_DEFAULT;
-  float n = (t - tMin) / range;
-  
-  int idx = (int)(n * (COLOR_LUT_SIZE - 1));
-  idx = constrain(idx, 0, COLOR_LUT_SIZE - 1);
-  
-  return useRGB ? colorLUT_RGB[idx] : colorLUT[idx];
-}
-
 uint16_t rgb565(uint8_t r, uint8_t g, uint8_t b) {
   return ((r & 0xF8) << 8) | ((g & 0xFC) << 3) | (b >> 3);
 }
@@ -152,72 +90,8 @@ static inline uint16_t blendColor(uint16_t c1, uint16_t c2, float alpha) {
   return rgb565(r, g, b);
 }
 
-// ==========================================
-// OPTIMIZED GRADIENT CALCULATION
-// ==========================================
-
-static void calculateGradients(const float *tempBuf) {
-  if (!EDGE_DETECTION_ENABLED || !gradientBuffer) return;
-  
-  const uint32_t FIXED_SHIFT = 16;
-  const uint32_t scaleX_fixed = ((MLX_W - 1) << FIXED_SHIFT) / FB_WIDTH;
-  const uint32_t scaleY_fixed = ((MLX_H - 1) << FIXED_SHIFT) / FB_HEIGHT;
-  
-  for (int x = 0; x < FB_WIDTH; x++) {
-    gradientBuffer[x] = 0.0f;
-    gradientBuffer[(FB_HEIGHT - 1) * FB_WIDTH + x] = 0.0f;
-  }
-  for (int y = 1; y < FB_HEIGHT - 1; y++) {
-    gradientBuffer[y * FB_WIDTH] = 0.0f;
-    gradientBuffer[y * FB_WIDTH + FB_WIDTH - 1] = 0.0f;
-  }
-  
-  uint32_t currentY = scaleY_fixed;
-  
-  for (int y = 1; y < FB_HEIGHT - 1; y++) {
-    int y0 = currentY >> FIXED_SHIFT;
-    if (y0 >= MLX_H - 2) y0 = MLX_H - 3;
-    
-    float fy = (float)(currentY & 0xFFFF) / 65536.0f;
-    
-    const float *row_m1 = &tempBuf[(y0 - 1) * MLX_W];
-    const float *row_0 = &tempBuf[y0 * MLX_W];
-    const float *row_p1 = &tempBuf[(y0 + 1) * MLX_W];
-    const float *row_p2 = &tempBuf[(y0 + 2) * MLX_W];
-    
-    int rowOffset = y * FB_WIDTH;
-    uint32_t currentX = scaleX_fixed;
-    
-    for (int x = 1; x < FB_WIDTH - 1; x++) {
-      int x0 = currentX >> FIXED_SHIFT;
-      if (x0 >= MLX_W - 2) x0 = MLX_W - 3;
-      
-      float fx = (float)(currentX & 0xFFFF) / 65536.0f;
-      
-      float tl = row_m1[x0] + (row_m1[x0 + 1] - row_m1[x0]) * fx;
-      float tc = row_m1[x0] + (row_m1[x0 + 1] - row_m1[x0]) * fx;
-      float tr = row_m1[x0 + 1] + (row_m1[x0 + 2] - row_m1[x0 + 1]) * fx;
-      
-      float ml = row_0[x0 - 1] + (row_0[x0] - row_0[x0 - 1]) * fx;
-      float mr = row_0[x0 + 1] + (row_0[x0 + 2] - row_0[x0 + 1]) * fx;
-      
-      float bl = row_p1[x0] + (row_p1[x0 + 1] - row_p1[x0]) * fx;
-      float bc = row_p1[x0] + (row_p1[x0 + 1] - row_p1[x0]) * fx;
-      float br = row_p1[x0 + 1] + (row_p1[x0 + 2] - row_p1[x0 + 1]) * fx;
-      
-      float gx = -tl + tr - 2.0f * ml + 2.0f * mr - bl + br;
-      float gy = -tl - 2.0f * tc - tr + bl + 2.0f * bc + br;
-      
-      gradientBuffer[rowOffset + x] = sqrtf(gx * gx + gy * gy) * 0.125f;
-      
-      currentX += scaleX_fixed;
-    }
-    
-    currentY += scaleY_fixed;
-  }
-}
-
 static void drawTempMarkers(float minTemp, float maxTemp);
+static void drawHotspotMarkers();
 
 // ==========================================
 // INITIALIZATION
@@ -229,45 +103,29 @@ void initDisplay() {
   gfx->begin();
   gfx->fillScreen(COL_BG);
   
-  delay(DISPLAY_INIT_DELAY);
+  if (!FAST_BOOT) delay(DISPLAY_INIT_DELAY);
  
-  if (USE_DMA_ALLOCATION) {
-    frameBuffer = (uint16_t*)heap_caps_malloc(
-      FB_WIDTH * FB_HEIGHT * sizeof(uint16_t), MALLOC_CAP_DMA
-    );
-  } else {
-    frameBuffer = (uint16_t*)malloc(FB_WIDTH * FB_HEIGHT * sizeof(uint16_t));
-  }
-  
-  if (!frameBuffer) {
-    Serial.println("framebuffer allocation error");
-    while (1) delay(SENSOR_ERROR_WAIT);
-  }
-  
-  if (EDGE_DETECTION_ENABLED) {
-    if (USE_DMA_ALLOCATION) {
-      gradientBuffer = (float*)heap_caps_malloc(
-        FB_WIDTH * FB_HEIGHT * sizeof(float), MALLOC_CAP_DMA
-      );
-    } else {
-      gradientBuffer = (float*)malloc(FB_WIDTH * FB_HEIGHT * sizeof(float));
-    }
-    
-    if (gradientBuffer) {
-      memset(gradientBuffer, 0, FB_WIDTH * FB_HEIGHT * sizeof(float));
-    }
-  }
-  
-  memset(frameBuffer, 0, FB_WIDTH * FB_HEIGHT * sizeof(uint16_t));
+  frameBuffer = memBufferAs<FbPixel>(BUF_FRAMEBUFFER);
+  pushLines = memBufferAs<uint8_t>(BUF_PUSH_LINES);
+  edgeMask = memBufferAs<uint8_t>(BUF_EDGE_MASK);
+  renderRows = memBufferAs<float>(BUF_RENDER_ROWS);
   
   initColorLUT();
+  initRenderWorkers();
   
   Serial.printf("display initialized: %dx%d\n", TFT_WIDTH, TFT_HEIGHT);
-  Serial.printf("framebuffer: %dx%d (%d KB)\n", FB_WIDTH, FB_HEIGHT, (FB_WIDTH * FB_HEIGHT * 2) / 1024);
+  Serial.printf("framebuffer: %dx%d %s (%d KB)\n", FB_WIDTH, FB_HEIGHT, FB_INDEXED ? "indexed" : "rgb565",
+                (FB_WIDTH * FB_HEIGHT * FB_PIXEL_BYTES) / 1024);
   Serial.println("color LUT initialized (256 entries)");
 }
 
 void displayStartupScreen() {
+  drawStartupScreen();
+  delay(STARTUP_DELAY_MS);
+  gfx->fillScreen(COL_BG);
+}
+
+void drawStartupScreen() {
   gfx->fillScreen(COL_BG);
   
   gfx->setTextSize(TEXT_SIZE_LARGE);
@@ -287,9 +145,58 @@ void displayStartupScreen() {
   gfx->setTextColor(COL_TEXT, COL_BG);
   gfx->setCursor(centerX + 15 , centerY + 45);
   gfx->println("Thermal Camera by Bielov Danylo");
-  
-  delay(STARTUP_DELAY_MS);
-  gfx->fillScreen(COL_BG);
+}
+
+// ==========================================
+// FRAMEBUFFER PUSH
+// ==========================================
+
+#if FB_INDEXED
+
+// Palette entries pre-expanded to the panel's pixel format
+static uint8_t panelPalette[COLOR_LUT_SIZE][PANEL_PIXEL_BYTES];
+static const uint16_t *panelPaletteSource = nullptr;
+
+static void expandPanelPalette(const uint16_t *lut) {
+  if (lut == panelPaletteSource) return;
+  for (int i = 0; i < COLOR_LUT_SIZE; i++) {
+    expandPanelColor(lut[i], panelPalette[i]);
+  }
+  panelPaletteSource = lut;
+}
+
+static void pushFrameBuffer(const uint16_t *lut) {
+  BusScope scope(BUS_SITE_FRAME);
+  expandPanelPalette(lut);
+
+  gfx->startWrite();
+  panel->writeAddrWindow(FB_X_OFFSET, FB_Y_OFFSET, FB_WIDTH, FB_HEIGHT);
+  streamIndexedRows(*bus, frameBuffer, panelPalette, pushLines);
+  gfx->endWrite();
+  pushedLUT = lut;
+}
+
+#else
+
+static void pushFrameBuffer(const uint16_t *lut) {
+  BusScope scope(BUS_SITE_FRAME);
+  gfx->draw16bitRGBBitmap(FB_X_OFFSET, FB_Y_OFFSET, frameBuffer, FB_WIDTH, FB_HEIGHT);
+  pushedLUT = lut;
+}
+
+#endif
+
+// Re-push the last rendered frame with another palette. Indexed mode only
+// needs the push; RGB565 would need a re-render, so it is a no-op there.
+// Edge and isotherm pixels keep PALETTE_OVERLAY_COLOR in either palette.
+bool repaintFrame(DisplayMode mode) {
+  if (!FB_INDEXED || !pushedLUT) return false;
+
+  const uint16_t *lut = (mode == MODE_RGB) ? colorLUT_RGB : colorLUT;
+  traceBegin(TRACE_SPI_PUSH);
+  pushFrameBuffer(lut);
+  traceEnd(TRACE_SPI_PUSH);
+  return true;
 }
 
 // ==========================================
@@ -303,131 +210,189 @@ void drawThermalImage(const float *buf, float tMin, float tMax, DisplayMode mode
     tMax = tMin + MIN_TEMP_RANGE;
   }
 
-  if ((mode == MODE_LIVE || mode == MODE_PAUSED) && EDGE_DETECTION_ENABLED) {
-    calculateGradients(buf);
-  }
+  const bool useRGB = (mode == MODE_RGB);
+  const bool useIsotherms = (ISOTHERM_ENABLED && !useRGB);
+  const bool useEdges = (EDGE_DETECTION_ENABLED && !ISOTHERM_ENABLED && edgeMask && !useRGB &&
+                         qualityEdges(renderQuality));
 
   float localMin = 999.0f;
   float localMax = -999.0f;
   int minIdx = 0, maxIdx = 0;
   
-  for (int i = 0; i < MLX_W * MLX_H; i++) {
+  for (int i = 0; i < FrameGeom::pixels; i++) {
     float val = buf[i];
     if (val < localMin) { localMin = val; minIdx = i; }
     if (val > localMax) { localMax = val; maxIdx = i; }
   }
 
-  int minSensorX = minIdx % MLX_W;
-  int minSensorY = minIdx / MLX_W;
-  int maxSensorX = maxIdx % MLX_W;
-  int maxSensorY = maxIdx / MLX_W;
-  
-  minTempX = FB_X_OFFSET + (minSensorX * FB_WIDTH) / (MLX_W - 1);
-  minTempY = FB_Y_OFFSET + (minSensorY * FB_HEIGHT) / (MLX_H - 1);
-  maxTempX = FB_X_OFFSET + (maxSensorX * FB_WIDTH) / (MLX_W - 1);
-  maxTempY = FB_Y_OFFSET + (maxSensorY * FB_HEIGHT) / (MLX_H - 1);
-
-  const uint32_t FIXED_SHIFT = 16;
-  const uint32_t scaleX_fixed = ((MLX_W - 1) << FIXED_SHIFT) / FB_WIDTH;
-  const uint32_t scaleY_fixed = ((MLX_H - 1) << FIXED_SHIFT) / FB_HEIGHT;
+  int minSensorX = minIdx % FrameGeom::width;
+  int minSensorY = minIdx / FrameGeom::width;
+  int maxSensorX = maxIdx % FrameGeom::width;
+  int maxSensorY = maxIdx / FrameGeom::width;
+
+  const ViewWindow &view = currentView();
+  minTempVisible = viewToFb<FrameGeom, FbGeom>(view, minSensorX, minSensorY, minTempX, minTempY);
+  maxTempVisible = viewToFb<FrameGeom, FbGeom>(view, maxSensorX, maxSensorY, maxTempX, maxTempY);
+
+  // Fovea around the image centre and, when on screen, the max marker
+  const FoveaMap<FbGeom> *fovea = nullptr;
+  if (FOVEATED_RENDER && qualityFovea(renderQuality)) {
+    int focusX[2] = {FbGeom::width / 2, maxTempX};
+    int focusY[2] = {FbGeom::height / 2, maxTempY};
+    buildFoveaMap(foveaMap, focusX, focusY, maxTempVisible ? 2 : 1);
+    fovea = &foveaMap;
+    traceInstant(TRACE_FOVEA, (uint16_t)foveaMap.tileCount);
+  }
+  lastFoveaPixels = fovea ? fovea->pixels : (FOVEATED_RENDER ? 0 : FbGeom::pixels);
+
+  minTempX += FB_X_OFFSET;
+  minTempY += FB_Y_OFFSET;
+  maxTempX += FB_X_OFFSET;
+  maxTempY += FB_Y_OFFSET;
+
+  RenderJob job = {buf, tMin, tMax, useRGB ? colorLUT_RGB : colorLUT,
+                   useEdges ? edgeMask : nullptr, frameBuffer, renderRows, view, fovea,
+                   qualityFilter(renderQuality)};
+  traceBegin(TRACE_RENDER);
+  uint32_t renderStart = micros();
+  if (PARALLEL_RENDER) {
+    renderParallel(job);
+  } else {
+    renderStrip(job, 0, FbGeom::height);
+  }
+  lastRenderUs = micros() - renderStart;
+  traceEnd(TRACE_RENDER);
+
+  isoSegmentCount = 0;
+  if (useIsotherms) {
+    traceBegin(TRACE_ISOTHERM);
+    isoSegmentCount = extractIsotherms(buf, isoLevels, ISOTHERM_LEVEL_COUNT, isoSegments, ISOTHERM_MAX_SEGMENTS);
+    drawIsotherms<FrameGeom, FbGeom>(isoSegments, isoSegmentCount, frameBuffer,
+                                     (FbPixel)(FB_INDEXED ? EDGE_PALETTE_INDEX : PALETTE_OVERLAY_COLOR), view);
+    traceEnd(TRACE_ISOTHERM);
+  }
+
+  traceBegin(TRACE_SPI_PUSH);
+  uint32_t pushStart = micros();
+  pushFrameBuffer(job.lut);
+  lastPushUs = micros() - pushStart;
+  traceEnd(TRACE_SPI_PUSH);
   
-  const bool useRGB = (mode == MODE_RGB);
-  const bool useEdges = (EDGE_DETECTION_ENABLED && gradientBuffer && !useRGB);
-  const uint16_t edgeColor = 0xFFFF;
+  drawTempMarkers(localMin, localMax);
+  if (HOTSPOT_ENABLED) drawHotspotMarkers();
+}
 
-  uint32_t currentY_fixed = 0;
+int foveaPixels() {
+  return lastFoveaPixels;
+}
 
-  for (int y = 0; y < FB_HEIGHT; y++) {
-    int y0 = currentY_fixed >> FIXED_SHIFT;
-    if (y0 >= MLX_H - 1) y0 = MLX_H - 2;
-    
-    float fy = (float)(currentY_fixed & 0xFFFF) / 65536.0f;
-
-    const float *row0 = &buf[y0 * MLX_W];
-    const float *row1 = &buf[(y0 + 1) * MLX_W];
-
-    int rowOffset = y * FB_WIDTH;
-    uint32_t currentX_fixed = 0;
-
-    for (int x = 0; x < FB_WIDTH; x++) {
-      int x0 = currentX_fixed >> FIXED_SHIFT;
-      if (x0 >= MLX_W - 1) x0 = MLX_W - 2;
-
-      float fx = (float)(currentX_fixed & 0xFFFF) / 65536.0f;
-      float t00 = row0[x0];
-      float t10 = row0[x0 + 1];
-      float t01 = row1[x0];
-      float t11 = row1[x0 + 1];
-      float top = t00 + (t10 - t00) * fx;
-      float bot = t01 + (t11 - t01) * fx;
-      float temp = top + (bot - top) * fy;
-      uint16_t color = tempToColorFast(temp, tMin, tMax, useRGB);
-
-      if (useEdges && gradientBuffer[rowOffset + x] > EDGE_THRESHOLD) {
-        color = edgeColor;
-      }
-      
-      frameBuffer[rowOffset + x] = color;
+uint32_t renderTimeUs() {
+  return lastRenderUs;
+}
 
-      currentX_fixed += scaleX_fixed;
-    }
+uint32_t pushTimeUs() {
+  return lastPushUs;
+}
 
-    currentY_fixed += scaleY_fixed;
-  }
+void setRenderQuality(int level) {
+  renderQuality = level;
+}
 
-  gfx->draw16bitRGBBitmap(FB_X_OFFSET, FB_Y_OFFSET, frameBuffer, FB_WIDTH, FB_HEIGHT);
-  
-  drawTempMarkers(localMin, localMax);
+const IsoSegment *isothermSegments(int &count) {
+  count = isoSegmentCount;
+  return isoSegments;
 }
 
 static void drawTempMarkers(float minTemp, float maxTemp) {
+  BusScope scope(BUS_SITE_MARKERS);
   const int markerSize = 6;
   const int textOffset = 10;
   
-  uint16_t maxColor = rgb565(255, 50, 50);
-  gfx->drawLine(maxTempX - markerSize, maxTempY - markerSize, 
-                maxTempX + markerSize, maxTempY + markerSize, maxColor);
-  gfx->drawLine(maxTempX + markerSize, maxTempY - markerSize, 
-                maxTempX - markerSize, maxTempY + markerSize, maxColor);
-  
-  gfx->setTextSize(1);
-  gfx->setTextColor(maxColor, COL_BG);
-  char maxStr[8];
-  snprintf(maxStr, sizeof(maxStr), "%.1f", maxTemp);
-  
   int16_t x1, y1;
   uint16_t w, h;
-  gfx->getTextBounds(maxStr, 0, 0, &x1, &y1, &w, &h);
-  int maxTextX = maxTempX - w / 2;
-  int maxTextY = maxTempY + textOffset;
-  
-  if (maxTextX < FB_X_OFFSET) maxTextX = FB_X_OFFSET;
-  if (maxTextX + w > FB_X_OFFSET + FB_WIDTH) maxTextX = FB_X_OFFSET + FB_WIDTH - w;
-  if (maxTextY + h > FB_Y_OFFSET + FB_HEIGHT) maxTextY = maxTempY - textOffset - h;
-  
-  gfx->setCursor(maxTextX, maxTextY);
-  gfx->print(maxStr);
-  
-  uint16_t minColor = rgb565(100, 200, 255);
-  gfx->drawLine(minTempX - markerSize, minTempY - markerSize, 
-                minTempX + markerSize, minTempY + markerSize, minColor);
-  gfx->drawLine(minTempX + markerSize, minTempY - markerSize, 
-                minTempX - markerSize, minTempY + markerSize, minColor);
-  
-  gfx->setTextColor(minColor, COL_BG);
-  char minStr[8];
-  snprintf(minStr, sizeof(minStr), "%.1f", minTemp);
-  
-  gfx->getTextBounds(minStr, 0, 0, &x1, &y1, &w, &h);
-  int minTextX = minTempX - w / 2;
-  int minTextY = minTempY + textOffset;
+  gfx->setTextSize(1);
 
-  if (minTextX < FB_X_OFFSET) minTextX = FB_X_OFFSET;
-  if (minTextX + w > FB_X_OFFSET + FB_WIDTH) minTextX = FB_X_OFFSET + FB_WIDTH - w;
-  if (minTextY + h > FB_Y_OFFSET + FB_HEIGHT) minTextY = minTempY - textOffset - h;
+  // Zoomed in, an extreme outside the visible window has no marker
+  if (maxTempVisible) {
+    uint16_t maxColor = rgb565(255, 50, 50);
+    gfx->drawLine(maxTempX - markerSize, maxTempY - markerSize, 
+                  maxTempX + markerSize, maxTempY + markerSize, maxColor);
+    gfx->drawLine(maxTempX + markerSize, maxTempY - markerSize, 
+                  maxTempX - markerSize, maxTempY + markerSize, maxColor);
+    
+    gfx->setTextColor(maxColor, COL_BG);
+    char maxStr[8];
+    snprintf(maxStr, sizeof(maxStr), "%.1f", maxTemp);
+    
+    gfx->getTextBounds(maxStr, 0, 0, &x1, &y1, &w, &h);
+    int maxTextX = maxTempX - w / 2;
+    int maxTextY = maxTempY + textOffset;
+    
+    if (maxTextX < FB_X_OFFSET) maxTextX = FB_X_OFFSET;
+    if (maxTextX + w > FB_X_OFFSET + FB_WIDTH) maxTextX = FB_X_OFFSET + FB_WIDTH - w;
+    if (maxTextY + h > FB_Y_OFFSET + FB_HEIGHT) maxTextY = maxTempY - textOffset - h;
+    
+    gfx->setCursor(maxTextX, maxTextY);
+    gfx->print(maxStr);
+  }
   
-  gfx->setCursor(minTextX, minTextY);
-  gfx->print(minStr);
+  if (minTempVisible) {
+    uint16_t minColor = rgb565(100, 200, 255);
+    gfx->drawLine(minTempX - markerSize, minTempY - markerSize, 
+                  minTempX + markerSize, minTempY + markerSize, minColor);
+    gfx->drawLine(minTempX + markerSize, minTempY - markerSize, 
+                  minTempX - markerSize, minTempY + markerSize, minColor);
+    
+    gfx->setTextColor(minColor, COL_BG);
+    char minStr[8];
+    snprintf(minStr, sizeof(minStr), "%.1f", minTemp);
+    
+    gfx->getTextBounds(minStr, 0, 0, &x1, &y1, &w, &h);
+    int minTextX = minTempX - w / 2;
+    int minTextY = minTempY + textOffset;
+
+    if (minTextX < FB_X_OFFSET) minTextX = FB_X_OFFSET;
+    if (minTextX + w > FB_X_OFFSET + FB_WIDTH) minTextX = FB_X_OFFSET + FB_WIDTH - w;
+    if (minTextY + h > FB_Y_OFFSET + FB_HEIGHT) minTextY = minTempY - textOffset - h;
+    
+    gfx->setCursor(minTextX, minTextY);
+    gfx->print(minStr);
+  }
+}
+
+static void drawHotspotMarkers() {
+  BusScope scope(BUS_SITE_HOTSPOTS);
+  const Hotspot *spots = hotspots();
+  const int count = hotspotCount() < HOTSPOT_TOP_N ? hotspotCount() : HOTSPOT_TOP_N;
+  const uint16_t color = rgb565(255, 200, 0);
+
+  gfx->setTextSize(1);
+  gfx->setTextColor(color, COL_BG);
+
+  const ViewWindow &view = currentView();
+
+  for (int i = 0; i < count; i++) {
+    int x, y;
+    if (!viewToFb<FrameGeom, FbGeom>(view, spots[i].peakX, spots[i].peakY, x, y)) continue;
+    x += FB_X_OFFSET;
+    y += FB_Y_OFFSET;
+    gfx->drawCircle(x, y, HOTSPOT_MARKER_R, color);
+
+    char label[16];
+    snprintf(label, sizeof(label), "#%u %.1f", spots[i].id, spots[i].peak);
+
+    int16_t x1, y1;
+    uint16_t w, h;
+    gfx->getTextBounds(label, 0, 0, &x1, &y1, &w, &h);
+    int textX = x + HOTSPOT_MARKER_R + 2;
+    int textY = y - HOTSPOT_MARKER_R - (int)h;
+
+    if (textX + w > FB_X_OFFSET + FB_WIDTH) textX = x - HOTSPOT_MARKER_R - 2 - w;
+    if (textY < FB_Y_OFFSET) textY = y + HOTSPOT_MARKER_R;
+
+    gfx->setCursor(textX, textY);
+    gfx->print(label);
+  }
 }
 
 // ==========================================
@@ -435,6 +400,7 @@ static void drawTempMarkers(float minTemp, float maxTemp) {
 // ==========================================
 
 void drawLegend(float tMin, float tMax, float fps) {
+  BusScope scope(BUS_SITE_LEGEND);
   if (firstTempUpdate) {
     smoothedMinTemp = tMin;
     smoothedMaxTemp = tMax;
@@ -452,8 +418,8 @@ void drawLegend(float tMin, float tMax, float fps) {
 
   for (int i = 0; i < LEGEND_SCALE_H; i++) {
     float normalized = 1.0f - (float)i / LEGEND_SCALE_H;
-    int lutIdx = (int)(normalized * (COLOR_LUT_SIZE - 1));
-    lutIdx = constrain(lutIdx, 0, COLOR_LUT_SIZE - 1);
+    int lutIdx = (int)(normalized * PALETTE_TOP_INDEX);
+    lutIdx = constrain(lutIdx, 0, PALETTE_TOP_INDEX);
     uint16_t color = colorLUT[lutIdx];
     gfx->drawFastHLine(LEGEND_X + LEGEND_SCALE_X, LEGEND_Y + LEGEND_SCALE_Y + i, LEGEND_SCALE_W, color);
   }
@@ -488,6 +454,31 @@ void drawLegend(float tMin, float tMax, float fps) {
   gfx->setTextColor(COL_RGB_TEXT, COL_PANEL_BG);
   gfx->setCursor(LEGEND_X + 10, LEGEND_Y + 290);
   gfx->print(fps, 1);
+
+  if (currentZoom() > 1) {
+    gfx->setTextColor(COL_TEXT, COL_PANEL_BG);
+    gfx->setCursor(LEGEND_X + 10, LEGEND_Y + 300);
+    gfx->print("ZOOM ");
+    gfx->print(currentZoom());
+    gfx->print("x");
+  }
+}
+
+// Bottom legend row: "BURST" while capturing (index < 0), else the
+// reviewed sample. Drawn after drawLegend(), over the zoom label.
+void drawBurstStatus(int index, int count) {
+  BusScope scope(BUS_SITE_LEGEND);
+  gfx->fillRect(LEGEND_X + 4, LEGEND_Y + 300, LEGEND_WIDTH - 8, 10, COL_PANEL_BG);
+  gfx->setTextSize(LEGEND_LABEL_SIZE);
+  gfx->setTextColor(COL_ACCENT, COL_PANEL_BG);
+  gfx->setCursor(LEGEND_X + 10, LEGEND_Y + 300);
+  if (index < 0) {
+    gfx->print("BURST");
+    return;
+  }
+  gfx->print(index + 1);
+  gfx->print("/");
+  gfx->print(count);
 }
 
 // ==========================================
@@ -495,6 +486,7 @@ void drawLegend(float tMin, float tMax, float fps) {
 // ==========================================
 
 void drawMenu(DisplayMode currentMode) {
+  BusScope scope(BUS_SITE_MENU);
   for (int i = 0; i < MODE_COUNT; i++) {
     menuItemTargetAlpha[i] = (i == currentMode) ? 1.0f : 0.3f;
   }
@@ -513,8 +505,8 @@ void drawMenu(DisplayMode currentMode) {
     gfx->fillRect(MENU_X, MENU_Y, MENU_WIDTH, MENU_HEIGHT, COL_PANEL_BG);
     gfx->drawRect(MENU_X, MENU_Y, MENU_WIDTH, MENU_HEIGHT, COL_TEXT);
     
-    const char* menuLabels[] = {"LIVE", "PAUSE", "RGB", "CHRG"};
-    const char* menuIcons[] = {">", "||", "~", "Z"};
+    const char* menuLabels[] = {"LIVE", "PAUSE", "RGB", "CHRG", "MON"};
+    const char* menuIcons[] = {">", "||", "~", "Z", "^"};
     
     for (int i = 0; i < MODE_COUNT; i++) {
       int y = MENU_Y + i * MENU_ITEM_HEIGHT;
@@ -598,6 +590,11 @@ void resetDisplayState() {
   smoothedMaxTemp = 0.0f;
   
 }
+
+uint32_t frameBufferCrc() {
+  return crc32Bytes(frameBuffer, FB_WIDTH * FB_HEIGHT * sizeof(FbPixel));
+}
+
 void setDisplayBrightness(uint8_t level) {
   analogWrite(TFT_LED_PIN, level);
 }
\ No newline at end of file
@@ -0,0 +1,162 @@
+#include "frame_interp.h"
+#include <math.h>
+#include <string.h>
+
+// The acquisition side publishes each conditioned frame with its capture
+// time. The display side keeps private copies of the last two and renders
+// the scene one sensor period in the past: alpha = (now - tLatest) /
+// (tLatest - tPrev) walks from the previous frame to the latest one, so
+// intermediate frames never extrapolate.
+
+#if defined(ARDUINO)
+#include <Arduino.h>
+static portMUX_TYPE publishLock = portMUX_INITIALIZER_UNLOCKED;
+#define PUBLISH_LOCK()   portENTER_CRITICAL(&publishLock)
+#define PUBLISH_UNLOCK() portEXIT_CRITICAL(&publishLock)
+#else
+#include <mutex>
+static std::mutex publishLock;
+#define PUBLISH_LOCK()   publishLock.lock()
+#define PUBLISH_UNLOCK() publishLock.unlock()
+#endif
+
+using G = FrameGeom;
+
+static constexpr int BLOCKS_X = (G::width + INTERP_BLOCK - 1) / INTERP_BLOCK;
+static constexpr int BLOCKS_Y = (G::height + INTERP_BLOCK - 1) / INTERP_BLOCK;
+
+static float *publishedFrame = nullptr;
+static uint32_t publishedTimeUs = 0;
+static uint32_t publishedSeq = 0;
+
+static float *prevFrame = nullptr;
+static float *latestFrame = nullptr;
+static uint32_t prevTimeUs = 0;
+static uint32_t latestTimeUs = 0;
+static uint32_t consumedSeq = 0;
+
+static int8_t motionX[BLOCKS_Y][BLOCKS_X];
+static int8_t motionY[BLOCKS_Y][BLOCKS_X];
+
+void initFrameInterp(float *published, float *prev, float *latest) {
+  publishedFrame = published;
+  prevFrame = prev;
+  latestFrame = latest;
+  publishedSeq = 0;
+  consumedSeq = 0;
+  memset(motionX, 0, sizeof(motionX));
+  memset(motionY, 0, sizeof(motionY));
+}
+
+void pushConditionedFrame(const float *frame, uint32_t timestampUs) {
+  PUBLISH_LOCK();
+  memcpy(publishedFrame, frame, G::pixels * sizeof(float));
+  publishedTimeUs = timestampUs;
+  publishedSeq++;
+  PUBLISH_UNLOCK();
+}
+
+// ==========================================
+// BLOCK MOTION (sensor resolution)
+// ==========================================
+
+static inline int clampCoord(int v, int hi) {
+  return v < 0 ? 0 : (v >= hi ? hi - 1 : v);
+}
+
+static void estimateMotion() {
+  for (int by = 0; by < BLOCKS_Y; by++) {
+    for (int bx = 0; bx < BLOCKS_X; bx++) {
+      const int x0 = bx * INTERP_BLOCK;
+      const int y0 = by * INTERP_BLOCK;
+      const int x1 = x0 + INTERP_BLOCK < G::width ? x0 + INTERP_BLOCK : G::width;
+      const int y1 = y0 + INTERP_BLOCK < G::height ? y0 + INTERP_BLOCK : G::height;
+
+      float bestSad = 0.0f;
+      int bestX = 0, bestY = 0;
+      bool first = true;
+
+      for (int vy = -INTERP_SEARCH; vy <= INTERP_SEARCH; vy++) {
+        for (int vx = -INTERP_SEARCH; vx <= INTERP_SEARCH; vx++) {
+          float sad = 0.0f;
+          for (int y = y0; y < y1; y++) {
+            const float *cur = &latestFrame[y * G::width];
+            const float *ref = &prevFrame[clampCoord(y - vy, G::height) * G::width];
+            for (int x = x0; x < x1; x++) {
+              sad += fabsf(cur[x] - ref[clampCoord(x - vx, G::width)]);
+            }
+          }
+          // Prefer the zero vector on ties so static scenes stay static
+          if (first || sad < bestSad || (sad == bestSad && vx == 0 && vy == 0)) {
+            bestSad = sad;
+            bestX = vx;
+            bestY = vy;
+            first = false;
+          }
+        }
+      }
+
+      motionX[by][bx] = bestX;
+      motionY[by][bx] = bestY;
+    }
+  }
+}
+
+// ==========================================
+// SYNTHESIS
+// ==========================================
+
+bool synthesizeFrame(float *out, uint32_t nowUs) {
+  PUBLISH_LOCK();
+  if (publishedSeq != consumedSeq) {
+    float *recycled = prevFrame;
+    prevFrame = latestFrame;
+    latestFrame = recycled;
+    memcpy(latestFrame, publishedFrame, G::pixels * sizeof(float));
+    prevTimeUs = latestTimeUs;
+    latestTimeUs = publishedTimeUs;
+    consumedSeq = publishedSeq;
+    PUBLISH_UNLOCK();
+
+    if (INTERP_MODE == INTERP_MOTION && consumedSeq >= 2) estimateMotion();
+  } else {
+    PUBLISH_UNLOCK();
+  }
+
+  if (consumedSeq == 0) return false;
+  if (consumedSeq == 1) {
+    memcpy(out, latestFrame, G::pixels * sizeof(float));
+    return true;
+  }
+
+  uint32_t period = latestTimeUs - prevTimeUs;
+  float alpha = period > 0 ? (float)(nowUs - latestTimeUs) / (float)period : 1.0f;
+  if (alpha > 1.0f) alpha = 1.0f;
+  if (alpha < 0.0f) alpha = 0.0f;
+
+  if (INTERP_MODE != INTERP_MOTION) {
+    for (int i = 0; i < G::pixels; i++) {
+      out[i] = prevFrame[i] + (latestFrame[i] - prevFrame[i]) * alpha;
+    }
+    return true;
+  }
+
+  for (int y = 0; y < G::height; y++) {
+    const int by = y / INTERP_BLOCK;
+    for (int x = 0; x < G::width; x++) {
+      const int bx = x / INTERP_BLOCK;
+      const float vx = motionX[by][bx];
+      const float vy = motionY[by][bx];
+
+      const int px = clampCoord(x - (int)lroundf(alpha * vx), G::width);
+      const int py = clampCoord(y - (int)lroundf(alpha * vy), G::height);
+      const int lx = clampCoord(x + (int)lroundf((1.0f - alpha) * vx), G::width);
+      const int ly = clampCoord(y + (int)lroundf((1.0f - alpha) * vy), G::height);
+
+      const float a = prevFrame[py * G::width + px];
+      const float b = latestFrame[ly * G::width + lx];
+      out[y * G::width + x] = a + (b - a) * alpha;
+    }
+  }
+  return true;
+}
@@ -0,0 +1,95 @@
+#include "frame_sync.h"
+#include "stitch.h"
+#include <math.h>
+#include <string.h>
+
+static void fillNan(float *frame) {
+  for (int i = 0; i < SensorGeom::pixels; i++) frame[i] = NAN;
+}
+
+void initFrameSync(FrameSync &f, int count, float *slotBase, uint32_t nowUs) {
+  f.count = count;
+  for (int s = 0; s < count; s++) {
+    SensorSlot &slot = f.slots[s];
+    slot.back = slotBase + (s * 3 + 0) * SensorGeom::pixels;
+    slot.front = slotBase + (s * 3 + 1) * SensorGeom::pixels;
+    slot.staged = slotBase + (s * 3 + 2) * SensorGeom::pixels;
+    slot.timestampUs = nowUs;
+    slot.sequence = 0;
+    slot.status = 0;
+    f.consumedSeq[s] = 0;
+    f.delivered[s] = false;
+  }
+}
+
+int frameSyncRead(FrameSync &f, int sensor, SensorReadFn read, void *ctx) {
+  float *back = f.slots[sensor].back;
+  int status = read(sensor, back, ctx);
+  if (status != 0) fillNan(back);
+  return status;
+}
+
+void frameSyncPublish(FrameSync &f, int sensor, int status, uint32_t nowUs) {
+  SensorSlot &slot = f.slots[sensor];
+  float *done = slot.back;
+  slot.back = slot.front;
+  slot.front = done;
+  slot.timestampUs = nowUs;
+  slot.status = status;
+  slot.sequence++;
+}
+
+bool frameSyncTake(FrameSync &f, uint32_t nowUs, int &status) {
+  bool fresh[FRAME_SYNC_MAX_SENSORS];
+  int freshCount = 0;
+  int32_t minSkew = 0, maxSkew = 0;
+  int oldest = -1, first = -1;
+
+  for (int s = 0; s < f.count; s++) {
+    const SensorSlot &slot = f.slots[s];
+    fresh[s] = slot.sequence != f.consumedSeq[s];
+    if (!fresh[s]) {
+      if (nowUs - slot.timestampUs <= STITCH_STALE_US) return false;
+      continue;
+    }
+
+    freshCount++;
+    if (first < 0) first = s;
+    int32_t skew = (int32_t)(slot.timestampUs - f.slots[first].timestampUs);
+    if (oldest < 0 || skew < minSkew) { minSkew = skew; oldest = s; }
+    if (skew > maxSkew) maxSkew = skew;
+  }
+  if (freshCount == 0) return false;
+
+  if ((uint32_t)(maxSkew - minSkew) > STITCH_MAX_SKEW_US) {
+    f.consumedSeq[oldest] = f.slots[oldest].sequence;
+    return false;
+  }
+
+  int delivered = 0;
+  status = 0;
+  for (int s = 0; s < f.count; s++) {
+    SensorSlot &slot = f.slots[s];
+    f.delivered[s] = fresh[s] && slot.status == 0;
+    if (!fresh[s]) {
+      fillNan(slot.staged);
+      continue;
+    }
+    memcpy(slot.staged, slot.front, SensorGeom::pixels * sizeof(float));
+    f.consumedSeq[s] = slot.sequence;
+    if (slot.status == 0) delivered++;
+    else if (status == 0) status = slot.status;
+  }
+  if (delivered > 0) status = 0;
+  return true;
+}
+
+void frameSyncStitch(const FrameSync &f, float *out) {
+  const float *frames[FRAME_SYNC_MAX_SENSORS];
+  for (int s = 0; s < f.count; s++) frames[s] = f.slots[s].staged;
+  stitchFrames(frames, f.count, out);
+}
+
+int frameSyncMissingPixels(const FrameSync &f) {
+  return stitchUncoveredPixels(f.delivered, f.count);
+}
@@ -0,0 +1,881 @@
+// Offline batch renderer (native build only).
+//
+// Replays radiometric recordings (see recording.h) through the firmware's own
+// conditioning, EMA, auto-range, bilinear upscale, palette and edge overlay,
+// and writes one PPM per displayed frame plus a CSV of per-frame statistics.
+// Outputs are named after the input's file name without extension; inputs
+// that share one are told apart by their parent directories
+// (day1/rec.trf -> day1_rec, day2/rec.trf -> day2_rec), and names that still
+// clash (the same file given twice) are an error.
+//
+//   pio run -e native
+//   .pio/build/native/program [-j threads] [-o outdir] [--palette iron|rainbow]
+//                             [--chunk frames] [--stats-only] [--simd-check]
+//                             [--bus-budget bytes] [--monitor] [--quality level]
+//                             [--quality-trace load.txt] rec1.trf ...
+//
+// Work is spread over a single FIFO queue. Each recording has one
+// conditioning task that walks its frames in order (the temporal median and
+// EMA are sequential), conditions one chunk, queues a render task for that
+// frame range and re-queues itself behind it, so conditioned data in flight
+// stays bounded. Render tasks (upscale + colour + file output) run on any
+// thread. Input is memory-mapped and read in place.
+//
+// The adaptive acquisition policy (acq_policy.h) is replayed on the
+// conditioned frames too; its level per frame goes into the CSV, so policy
+// changes can be checked against recorded inspections.
+//
+// --simd-check runs the vector kernels (simd.h) on every displayed frame with
+// both the scalar reference and the GCC vector backend and fails on any
+// difference in the output bytes.
+//
+// --bus-budget replays the firmware's framebuffer push for every rendered
+// frame against a recording display bus (recording_bus.h) and fails frames
+// whose bytes on the wire exceed the budget (0 only reports).
+//
+// --monitor feeds every conditioned frame to the long-duration monitor
+// (monitor.h) and writes its per-pixel statistics, the decimated snapshots
+// and the max-hold / delta-from-baseline views of the whole recording.
+//
+// --quality renders at a fixed quality controller level (quality.h).
+// --quality-trace drives the controller with a synthetic load trace instead
+// of the device clock and writes its decisions to quality.csv (recordings
+// are optional then). Trace lines are "frames render_ms ui_ms [push_ms]",
+// '#' starts a comment: for that many frames a full-quality image costs
+// render_ms, the legend / menu refresh ui_ms and the framebuffer push
+// push_ms (default 0). Lower levels scale render_ms by their cost relative
+// to full quality, measured here on a synthetic frame, and ui_ms by the
+// slower refresh; the push costs the same at every level.
+
+// Left out of unit test builds (pio test -e native), which bring their own main()
+#ifndef PIO_UNIT_TESTING
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "acq_policy.h"
+#include "arena.h"
+#include "condition.h"
+#include "monitor.h"
+#include "palette.h"
+#include "panel_push.h"
+#include "pipeline.h"
+#include "quality.h"
+#include "recording.h"
+#include "recording_bus.h"
+#include "render.h"
+
+// ==========================================
+// WORK QUEUE
+// ==========================================
+
+class WorkQueue {
+public:
+  void push(std::function<void()> task) {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      tasks.push_back(std::move(task));
+      outstanding++;
+    }
+    wake.notify_one();
+  }
+
+  void run(int threadCount) {
+    std::vector<std::thread> workers;
+    for (int i = 0; i < threadCount; i++) {
+      workers.emplace_back([this] { workerLoop(); });
+    }
+    for (auto &w : workers) w.join();
+  }
+
+private:
+  void workerLoop() {
+    for (;;) {
+      std::function<void()> task;
+      {
+        std::unique_lock<std::mutex> lock(mutex);
+        wake.wait(lock, [this] { return !tasks.empty() || outstanding == 0; });
+        if (tasks.empty()) return;
+        task = std::move(tasks.front());
+        tasks.pop_front();
+      }
+
+      task();
+
+      std::lock_guard<std::mutex> lock(mutex);
+      if (--outstanding == 0) wake.notify_all();
+    }
+  }
+
+  std::mutex mutex;
+  std::condition_variable wake;
+  std::deque<std::function<void()>> tasks;
+  int outstanding = 0;
+};
+
+// ==========================================
+// RECORDINGS
+// ==========================================
+
+enum FrameStatus { FRAME_OK, FRAME_READ_ERROR, FRAME_REJECTED };
+
+struct FrameStats {
+  uint32_t timestampUs;
+  FrameStatus status;
+  int sensorStatus;
+  int invalidPixels;
+  int acqLevel;
+  float frameMin, frameMax, mean;
+  int minX, minY, maxX, maxY;
+  float rangeMin, rangeMax;
+};
+
+struct Options {
+  std::string outDir = "batch_out";
+  PaletteId palette = PALETTE_IRON;
+  int chunk = 64;
+  int threads = 0;
+  bool writeImages = true;
+  bool simdCheck = false;
+  bool busReplay = false;
+  uint32_t busBudget = BUS_FRAME_BYTE_BUDGET;
+  bool monitor = false;
+  int quality = QUALITY_FULL;
+  std::string qualityTrace;
+};
+
+struct Recording {
+  std::string path;
+  std::string stem;
+  const uint8_t *data = nullptr;
+  size_t size = 0;
+  uint32_t frameCount = 0;
+
+  FrameConditioner conditioner;
+  AcqPolicy acqPolicy;
+  std::vector<float> acqPrev;
+  std::vector<float> temporal;
+  std::vector<float> lastValid;
+  std::vector<float> raw;
+  std::vector<uint8_t> smoothingBuffer;
+  SmoothingPipeline smoothing;
+  std::vector<uint8_t> monitorStats;
+  std::vector<MonitorSnapshot> monitorSnapshots;
+  Monitor monitor;
+  uint32_t nextFrame = 0;
+
+  std::vector<FrameStats> stats;
+  std::atomic<int> pending{1};
+
+  ~Recording() {
+    if (data) munmap((void*)data, size);
+  }
+
+  const RecordingFrameHeader *frameHeader(uint32_t i) const {
+    size_t offset = sizeof(RecordingHeader) + (size_t)i * recordingFrameBytes(FrameGeom::width, FrameGeom::height);
+    return (const RecordingFrameHeader*)(data + offset);
+  }
+
+  const float *framePixels(uint32_t i) const {
+    return (const float*)(frameHeader(i) + 1);
+  }
+};
+
+struct RenderChunk {
+  std::shared_ptr<Recording> rec;
+  uint32_t first;
+  std::vector<float> frames;     // conditioned + smoothed, FRAME_OK only
+  std::vector<uint32_t> indices;
+};
+
+static uint16_t paletteLUT[PALETTE_COUNT][COLOR_LUT_SIZE];
+static std::atomic<uint32_t> framesRendered{0};
+static std::atomic<int> failures{0};
+static std::atomic<uint32_t> simdMismatches{0};
+static std::atomic<uint32_t> busFrameBytes{0};
+static std::atomic<uint32_t> busWorstBytes{0};
+static std::atomic<uint32_t> busOverBudget{0};
+static std::mutex timelineLock;
+static double recordedSeconds = 0.0;
+
+static bool openRecording(Recording &rec) {
+  int fd = open(rec.path.c_str(), O_RDONLY);
+  if (fd < 0) {
+    fprintf(stderr, "%s: cannot open\n", rec.path.c_str());
+    return false;
+  }
+
+  struct stat st;
+  if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(RecordingHeader)) {
+    fprintf(stderr, "%s: not a recording\n", rec.path.c_str());
+    close(fd);
+    return false;
+  }
+
+  rec.size = (size_t)st.st_size;
+  void *map = mmap(nullptr, rec.size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (map == MAP_FAILED) {
+    fprintf(stderr, "%s: mmap failed\n", rec.path.c_str());
+    return false;
+  }
+  rec.data = (const uint8_t*)map;
+  madvise(map, rec.size, MADV_SEQUENTIAL);
+
+  const RecordingHeader *hdr = (const RecordingHeader*)rec.data;
+  if (hdr->magic != RECORDING_MAGIC || hdr->version != RECORDING_VERSION) {
+    fprintf(stderr, "%s: bad magic or version\n", rec.path.c_str());
+    return false;
+  }
+  if (hdr->width != FrameGeom::width || hdr->height != FrameGeom::height) {
+    fprintf(stderr, "%s: recorded at %ux%u, this build expects %dx%d\n", rec.path.c_str(),
+            hdr->width, hdr->height, FrameGeom::width, FrameGeom::height);
+    return false;
+  }
+
+  uint32_t available = (rec.size - sizeof(RecordingHeader)) / recordingFrameBytes(hdr->width, hdr->height);
+  rec.frameCount = (hdr->frameCount && hdr->frameCount < available) ? hdr->frameCount : available;
+
+  rec.temporal.resize(TEMPORAL_FILTER_SIZE * FrameGeom::pixels);
+  rec.lastValid.resize(FrameGeom::pixels);
+  rec.raw.resize(FrameGeom::pixels);
+  rec.smoothingBuffer.resize(SmoothingPipeline::bufferBytes);
+  rec.smoothing.bind(rec.smoothingBuffer.data());
+  rec.monitorStats.resize(MONITOR_STATS_BYTES);
+  rec.monitorSnapshots.resize(MONITOR_SNAPSHOT_COUNT);
+  initMonitor(rec.monitor, rec.monitorStats.data(), rec.monitorSnapshots.data(), MONITOR_SNAPSHOT_COUNT);
+  rec.stats.resize(rec.frameCount);
+  initConditioner(rec.conditioner, rec.temporal.data(), rec.lastValid.data());
+  rec.acqPrev.resize(FrameGeom::pixels);
+  initAcqPolicy(rec.acqPolicy, rec.acqPrev.data(), ACQ_DEFAULT_LEVEL);
+
+  if (rec.frameCount > 1) {
+    uint32_t span = rec.frameHeader(rec.frameCount - 1)->timestampUs - rec.frameHeader(0)->timestampUs;
+    std::lock_guard<std::mutex> lock(timelineLock);
+    recordedSeconds += span / 1e6;
+  }
+  return true;
+}
+
+// ==========================================
+// OUTPUT
+// ==========================================
+
+static inline uint16_t fbColor(FbPixel p, const uint16_t *lut) {
+  return FB_INDEXED ? lut[p] : (uint16_t)p;
+}
+
+// Same byte expansion as Arduino_ILI9488_18bit: what the panel receives
+static bool writePPM(const std::string &path, const FbPixel *fb, const uint16_t *lut) {
+  std::vector<uint8_t> rgb(FbGeom::pixels * PANEL_PIXEL_BYTES);
+  for (int i = 0; i < FbGeom::pixels; i++) {
+    expandPanelColor(fbColor(fb[i], lut), &rgb[i * PANEL_PIXEL_BYTES]);
+  }
+
+  FILE *f = fopen(path.c_str(), "wb");
+  if (!f) return false;
+  fprintf(f, "P6\n%d %d\n255\n", FbGeom::width, FbGeom::height);
+  bool ok = fwrite(rgb.data(), 1, rgb.size(), f) == rgb.size();
+  return fclose(f) == 0 && ok;
+}
+
+static void writeStats(const Recording &rec, const Options &opt) {
+  static const char *statusNames[] = {"ok", "read_error", "rejected"};
+  std::string path = opt.outDir + "/" + rec.stem + ".csv";
+  FILE *f = fopen(path.c_str(), "w");
+  if (!f) {
+    fprintf(stderr, "%s: cannot write\n", path.c_str());
+    failures++;
+    return;
+  }
+
+  fprintf(f, "frame,timestamp_us,status,sensor_status,invalid_pixels,acq_hz,acq_bits,min,max,mean,"
+             "min_x,min_y,max_x,max_y,range_min,range_max\n");
+  for (uint32_t i = 0; i < rec.frameCount; i++) {
+    const FrameStats &s = rec.stats[i];
+    const AcqLevel &acq = acqLevel(s.acqLevel);
+    fprintf(f, "%u,%u,%s,%d,%d,%u,%u", i, s.timestampUs, statusNames[s.status], s.sensorStatus,
+            s.invalidPixels, acq.refreshHz, acq.adcBits);
+    if (s.status == FRAME_OK) {
+      fprintf(f, ",%.3f,%.3f,%.3f,%d,%d,%d,%d,%.3f,%.3f\n", s.frameMin, s.frameMax, s.mean,
+              s.minX, s.minY, s.maxX, s.maxY, s.rangeMin, s.rangeMax);
+    } else {
+      fprintf(f, ",,,,,,,,,\n");
+    }
+  }
+  fclose(f);
+}
+
+// Monitor views go through the same range and render path as live frames
+static bool writeMonitorView(const Recording &rec, const Options &opt, MonitorView view) {
+  const uint16_t *lut = paletteLUT[opt.palette];
+  std::vector<float> frame(FrameGeom::pixels), rowCache(RENDER_CACHE_ROWS * FbGeom::width);
+  std::vector<FbPixel> fb(FbGeom::pixels);
+  monitorRenderView(rec.monitor, view, rec.smoothing.stage<0>().smoothed, frame.data());
+
+  RangePipeline range;
+  range.run(frame.data());
+  renderThermalRows<FrameGeom, FbGeom>(frame.data(), range.stage<0>().tMin, range.stage<0>().tMax, lut, nullptr,
+                                       fb.data(), 0, FbGeom::height, rowCache.data());
+  const char *suffix = view == MONITOR_VIEW_MAX_HOLD ? "_maxhold.ppm" : "_delta.ppm";
+  return writePPM(opt.outDir + "/" + rec.stem + suffix, fb.data(), lut);
+}
+
+static void writeMonitor(const Recording &rec, const Options &opt) {
+  const Monitor &m = rec.monitor;
+  std::string path = opt.outDir + "/" + rec.stem + "_monitor.csv";
+  FILE *f = fopen(path.c_str(), "w");
+  if (!f) {
+    fprintf(stderr, "%s: cannot write\n", path.c_str());
+    failures++;
+    return;
+  }
+  fprintf(f, "x,y,min,max,mean,stddev,exceed,baseline\n");
+  for (int i = 0; i < FrameGeom::pixels; i++) {
+    fprintf(f, "%d,%d,%.2f,%.2f,%.3f,%.3f,%d,%.2f\n", i % FrameGeom::width, i / FrameGeom::width,
+            m.minC[i] / (float)MONITOR_TEMP_SCALE, m.maxC[i] / (float)MONITOR_TEMP_SCALE,
+            m.mean[i] / (float)(1 << MONITOR_MEAN_SHIFT), monitorStdDev(m, i), m.exceed[i],
+            m.baselineC[i] / (float)MONITOR_TEMP_SCALE);
+  }
+  fclose(f);
+
+  path = opt.outDir + "/" + rec.stem + "_snapshots.csv";
+  f = fopen(path.c_str(), "w");
+  if (!f) {
+    fprintf(stderr, "%s: cannot write\n", path.c_str());
+    failures++;
+    return;
+  }
+  fprintf(f, "time_ms,frames,cell,max,mean\n");
+  for (int k = 0; k < m.snapshotCount; k++) {
+    const MonitorSnapshot &s = monitorSnapshot(m, k);
+    for (int c = 0; c < MONITOR_CELLS; c++) {
+      fprintf(f, "%u,%u,%d,%.2f,%.2f\n", s.timeMs, s.frames, c, s.maxC[c] / (float)MONITOR_TEMP_SCALE,
+              s.meanC[c] / (float)MONITOR_TEMP_SCALE);
+    }
+  }
+  fclose(f);
+
+  if (opt.writeImages && m.frames > 0) {
+    for (int v = 0; v < MONITOR_VIEW_COUNT; v++) {
+      if (!writeMonitorView(rec, opt, (MonitorView)v)) {
+        fprintf(stderr, "%s: %s view write failed\n", rec.stem.c_str(), monitorViewName((MonitorView)v));
+        failures++;
+      }
+    }
+  }
+}
+
+static void finishOne(const std::shared_ptr<Recording> &rec, const Options &opt) {
+  if (--rec->pending == 0) {
+    writeStats(*rec, opt);
+    if (opt.monitor) writeMonitor(*rec, opt);
+    printf("%s: %u frames\n", rec->path.c_str(), rec->frameCount);
+  }
+}
+
+// pushFrameBuffer() from display.cpp, against the recording bus
+static void replayPush(RecordingBus &bus, BusLedger &ledger, const FbPixel *fb, const uint16_t *lut,
+                       uint8_t *lines) {
+  ledger.site = BUS_SITE_FRAME;
+  bus.clear();
+  bus.beginWrite();
+  bus.writeAddrWindow(FB_X_OFFSET, FB_Y_OFFSET, FB_WIDTH, FB_HEIGHT);
+#if FB_INDEXED
+  uint8_t palette[COLOR_LUT_SIZE][PANEL_PIXEL_BYTES];
+  for (int i = 0; i < COLOR_LUT_SIZE; i++) expandPanelColor(lut[i], palette[i]);
+  streamIndexedRows(bus, fb, palette, lines);
+#else
+  // draw16bitRGBBitmap on the 18-bit panel: three bytes per pixel
+  for (int y = 0; y < FbGeom::height; y++) {
+    for (int x = 0; x < FbGeom::width; x++) {
+      expandPanelColor(fb[y * FbGeom::width + x], &lines[x * PANEL_PIXEL_BYTES]);
+    }
+    bus.writeBytes(lines, FbGeom::width * PANEL_PIXEL_BYTES);
+  }
+#endif
+  bus.endWrite();
+  ledger.site = BUS_SITE_OTHER;
+}
+
+// ==========================================
+// STAGES
+// ==========================================
+
+// Kernel outputs under both backends, compared bytewise. prev and prev2 are
+// earlier frames of the same chunk (or the frame itself at chunk start).
+static bool simdBackendsAgree(const float *frame, const float *prev, const float *prev2,
+                              const uint16_t *lut, const uint8_t *edgeMask) {
+  float minA, maxA, minB, maxB;
+  findMinMaxOptimized<FrameGeom, SimdScalar>(frame, minA, maxA);
+  findMinMaxOptimized<FrameGeom, SimdGcc>(frame, minB, maxB);
+  bool ok = memcmp(&minA, &minB, sizeof(float)) == 0 && memcmp(&maxA, &maxB, sizeof(float)) == 0;
+
+  std::vector<float> a(prev, prev + FrameGeom::pixels), b(a);
+  applySmoothingOptimized<FrameGeom, SimdScalar>(a.data(), frame);
+  applySmoothingOptimized<FrameGeom, SimdGcc>(b.data(), frame);
+  ok = ok && memcmp(a.data(), b.data(), a.size() * sizeof(float)) == 0;
+
+  medianOf3Frames<FrameGeom, SimdScalar>(prev2, prev, frame, a.data());
+  medianOf3Frames<FrameGeom, SimdGcc>(prev2, prev, frame, b.data());
+  ok = ok && memcmp(a.data(), b.data(), a.size() * sizeof(float)) == 0;
+
+  std::vector<float> rows(RENDER_CACHE_ROWS * FbGeom::width);
+  std::vector<uint16_t> fbA(FbGeom::pixels), fbB(FbGeom::pixels);
+  FoveaMap<FbGeom> foveaMap;
+  const int centreX = FbGeom::width / 2, centreY = FbGeom::height / 2;
+  buildFoveaMap(foveaMap, &centreX, &centreY, 1);
+  const FoveaMap<FbGeom> *fovea = FOVEATED_RENDER ? &foveaMap : nullptr;
+
+  std::vector<uint8_t> maskA(EDGE_MASK_BYTES), maskB(EDGE_MASK_BYTES);
+  calculateEdgeMaskRows<FrameGeom, FbGeom, SimdScalar>(frame, maskA.data(), 0, FbGeom::height, FULL_VIEW, fovea);
+  calculateEdgeMaskRows<FrameGeom, FbGeom, SimdGcc>(frame, maskB.data(), 0, FbGeom::height, FULL_VIEW, fovea);
+  ok = ok && maskA == maskB;
+  renderThermalRows<FrameGeom, FbGeom, uint16_t, SimdScalar>(frame, minA, maxA, lut, edgeMask, fbA.data(),
+                                                             0, FbGeom::height, rows.data(), FULL_VIEW, fovea);
+  renderThermalRows<FrameGeom, FbGeom, uint16_t, SimdGcc>(frame, minA, maxA, lut, edgeMask, fbB.data(),
+                                                          0, FbGeom::height, rows.data(), FULL_VIEW, fovea);
+  return ok && fbA == fbB;
+}
+
+static void renderChunk(RenderChunk &chunk, const Options &opt) {
+  std::vector<FbPixel> fb(FbGeom::pixels);
+  std::vector<uint8_t> edgeMask((FbGeom::pixels + 7) / 8);
+  std::vector<float> rowCache(RENDER_CACHE_ROWS * FbGeom::width);
+  FoveaMap<FbGeom> foveaMap;
+  std::vector<uint8_t> pushLines(FB_PUSH_ROWS * FbGeom::width * PANEL_PIXEL_BYTES);
+  BusLedger ledger;
+  initBusLedger(ledger);
+  RecordingBus bus(ledger);
+  RangePipeline range;
+  const bool useEdges = EDGE_DETECTION_ENABLED && opt.palette == PALETTE_IRON && qualityEdges(opt.quality);
+  const uint16_t *lut = paletteLUT[opt.palette];
+
+  for (size_t k = 0; k < chunk.indices.size(); k++) {
+    const float *frame = &chunk.frames[k * FrameGeom::pixels];
+    FrameStats &s = chunk.rec->stats[chunk.indices[k]];
+
+    // Marker search as in drawThermalImage
+    float localMin = 999.0f, localMax = -999.0f, sum = 0.0f;
+    int minIdx = 0, maxIdx = 0;
+    for (int i = 0; i < FrameGeom::pixels; i++) {
+      float val = frame[i];
+      if (val < localMin) { localMin = val; minIdx = i; }
+      if (val > localMax) { localMax = val; maxIdx = i; }
+      sum += val;
+    }
+    s.frameMin = localMin;
+    s.frameMax = localMax;
+    s.mean = sum / FrameGeom::pixels;
+    s.minX = minIdx % FrameGeom::width;
+    s.minY = minIdx / FrameGeom::width;
+    s.maxX = maxIdx % FrameGeom::width;
+    s.maxY = maxIdx / FrameGeom::width;
+
+    // Same graph as the device display path
+    range.run(frame);
+    float tMin = range.stage<0>().tMin;
+    float tMax = range.stage<0>().tMax;
+    s.rangeMin = tMin;
+    s.rangeMax = tMax;
+
+    if (opt.writeImages || opt.busReplay) {
+      // Fovea as in drawThermalImage: image centre and the max marker
+      const FoveaMap<FbGeom> *fovea = nullptr;
+      if (FOVEATED_RENDER && qualityFovea(opt.quality)) {
+        int focusX[2] = {FbGeom::width / 2, 0};
+        int focusY[2] = {FbGeom::height / 2, 0};
+        viewToFb<FrameGeom, FbGeom>(FULL_VIEW, s.maxX, s.maxY, focusX[1], focusY[1]);
+        buildFoveaMap(foveaMap, focusX, focusY, 2);
+        fovea = &foveaMap;
+      }
+      if (useEdges) calculateEdgeMask<FrameGeom, FbGeom>(frame, edgeMask.data(), FULL_VIEW, fovea);
+      renderThermalRows<FrameGeom, FbGeom>(frame, tMin, tMax, lut, useEdges ? edgeMask.data() : nullptr,
+                                           fb.data(), 0, FbGeom::height, rowCache.data(), FULL_VIEW, fovea,
+                                           qualityFilter(opt.quality));
+    }
+
+    if (opt.writeImages) {
+      char name[32];
+      snprintf(name, sizeof(name), "_%06u.ppm", chunk.indices[k]);
+      if (!writePPM(opt.outDir + "/" + chunk.rec->stem + name, fb.data(), lut)) {
+        fprintf(stderr, "%s%s: write failed\n", chunk.rec->stem.c_str(), name);
+        failures++;
+      }
+    }
+
+    if (opt.busReplay) {
+      replayPush(bus, ledger, fb.data(), lut, pushLines.data());
+      bool withinBudget = busFrameEnd(ledger, opt.busBudget);
+      uint32_t bytes = busLastFrameTotal(ledger).bytes;
+      busFrameBytes = bytes;
+      uint32_t worst = busWorstBytes.load();
+      while (bytes > worst && !busWorstBytes.compare_exchange_weak(worst, bytes)) {
+      }
+      if (!withinBudget) {
+        fprintf(stderr, "%s: frame %u pushes %u bytes, budget %u\n", chunk.rec->path.c_str(),
+                chunk.indices[k], bytes, opt.busBudget);
+        busOverBudget++;
+        failures++;
+      }
+    }
+    if (opt.simdCheck) {
+      const float *prev = k > 0 ? frame - FrameGeom::pixels : frame;
+      const float *prev2 = k > 1 ? frame - 2 * FrameGeom::pixels : prev;
+      if (!simdBackendsAgree(frame, prev, prev2, lut, useEdges && (opt.writeImages || opt.busReplay) ? edgeMask.data() : nullptr)) {
+        fprintf(stderr, "%s: frame %u differs between SIMD backends\n", chunk.rec->path.c_str(), chunk.indices[k]);
+        simdMismatches++;
+        failures++;
+      }
+    }
+    framesRendered++;
+  }
+}
+
+static void conditionChunk(WorkQueue &queue, std::shared_ptr<Recording> rec, const Options &opt) {
+  auto chunk = std::make_shared<RenderChunk>();
+  chunk->rec = rec;
+  chunk->first = rec->nextFrame;
+
+  uint32_t end = rec->nextFrame + opt.chunk;
+  if (end > rec->frameCount) end = rec->frameCount;
+
+  // Mirrors readFrame() + conditionFrame(): errors and rejects leave the
+  // EMA untouched and are not displayed.
+  for (uint32_t i = rec->nextFrame; i < end; i++) {
+    const RecordingFrameHeader *hdr = rec->frameHeader(i);
+    FrameStats &s = rec->stats[i];
+    s.timestampUs = hdr->timestampUs;
+    s.sensorStatus = hdr->status;
+    s.invalidPixels = 0;
+    s.acqLevel = rec->acqPolicy.level;
+
+    if (hdr->status != 0) {
+      s.status = FRAME_READ_ERROR;
+      continue;
+    }
+    if (!conditionRawFrame(rec->conditioner, rec->framePixels(i), rec->raw.data(), s.invalidPixels)) {
+      s.status = FRAME_REJECTED;
+      continue;
+    }
+
+    acqPolicyUpdate(rec->acqPolicy, rec->raw.data(), hdr->timestampUs / 1000);
+    if (opt.monitor) monitorUpdate(rec->monitor, rec->raw.data(), hdr->timestampUs / 1000);
+    rec->smoothing.run(rec->raw.data());
+    s.status = FRAME_OK;
+    const float *smoothed = rec->smoothing.stage<0>().smoothed;
+    chunk->frames.insert(chunk->frames.end(), smoothed, smoothed + FrameGeom::pixels);
+    chunk->indices.push_back(i);
+  }
+  rec->nextFrame = end;
+
+  rec->pending++;
+  queue.push([chunk, &opt] {
+    renderChunk(*chunk, opt);
+    finishOne(chunk->rec, opt);
+  });
+
+  if (rec->nextFrame < rec->frameCount) {
+    queue.push([&queue, rec, &opt] { conditionChunk(queue, rec, opt); });
+  } else {
+    finishOne(rec, opt);
+  }
+}
+
+// ==========================================
+// QUALITY TRACE
+// ==========================================
+
+// Image cost of each level relative to full quality: a synthetic frame
+// (gradient plus a hot spot) rendered the way renderChunk does, best of
+// several interleaved runs so warm-up and scheduling noise do not leak into
+// the simulation
+static void measureLevelCosts(float cost[QUALITY_LEVEL_COUNT]) {
+  std::vector<float> frame(FrameGeom::pixels);
+  for (int y = 0; y < FrameGeom::height; y++) {
+    for (int x = 0; x < FrameGeom::width; x++) {
+      int dx = x - FrameGeom::width / 3, dy = y - FrameGeom::height / 2;
+      frame[y * FrameGeom::width + x] = 20.0f + 0.2f * x + 30.0f / (1.0f + 0.2f * (dx * dx + dy * dy));
+    }
+  }
+  std::vector<FbPixel> fb(FbGeom::pixels);
+  std::vector<uint8_t> edgeMask((FbGeom::pixels + 7) / 8);
+  std::vector<float> rowCache(RENDER_CACHE_ROWS * FbGeom::width);
+  FoveaMap<FbGeom> foveaMap;
+  int focusX[2] = {FbGeom::width / 2, FbGeom::width / 3};
+  int focusY[2] = {FbGeom::height / 2, FbGeom::height / 2};
+  const uint16_t *lut = paletteLUT[PALETTE_IRON];
+
+  double best[QUALITY_LEVEL_COUNT];
+  for (int level = 0; level < QUALITY_LEVEL_COUNT; level++) best[level] = 1e9;
+  for (int run = 0; run < 32; run++) {
+    for (int level = 0; level < QUALITY_LEVEL_COUNT; level++) {
+      auto start = std::chrono::steady_clock::now();
+      const FoveaMap<FbGeom> *fovea = nullptr;
+      if (FOVEATED_RENDER && qualityFovea(level)) {
+        buildFoveaMap(foveaMap, focusX, focusY, 2);
+        fovea = &foveaMap;
+      }
+      const bool edges = EDGE_DETECTION_ENABLED && qualityEdges(level);
+      if (edges) calculateEdgeMask<FrameGeom, FbGeom>(frame.data(), edgeMask.data(), FULL_VIEW, fovea);
+      renderThermalRows<FrameGeom, FbGeom>(frame.data(), 20.0f, 50.0f, lut, edges ? edgeMask.data() : nullptr,
+                                           fb.data(), 0, FbGeom::height, rowCache.data(), FULL_VIEW, fovea,
+                                           qualityFilter(level));
+      double t = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+      if (t < best[level]) best[level] = t;
+    }
+  }
+  for (int level = 0; level < QUALITY_LEVEL_COUNT; level++) cost[level] = (float)(best[level] / best[0]);
+}
+
+static bool runQualityTrace(const Options &opt) {
+  FILE *in = fopen(opt.qualityTrace.c_str(), "r");
+  if (!in) {
+    fprintf(stderr, "%s: cannot open\n", opt.qualityTrace.c_str());
+    return false;
+  }
+  std::string path = opt.outDir + "/quality.csv";
+  FILE *out = fopen(path.c_str(), "w");
+  if (!out) {
+    fprintf(stderr, "%s: cannot write\n", path.c_str());
+    fclose(in);
+    return false;
+  }
+
+  float cost[QUALITY_LEVEL_COUNT];
+  measureLevelCosts(cost);
+  printf("quality: relative image cost");
+  for (int level = 0; level < QUALITY_LEVEL_COUNT; level++) printf(" %s %.2f", qualityLevelName(level), cost[level]);
+  printf("\n");
+
+  QualityController q;
+  initQuality(q);
+  const float budget = qualityBudgetMs();
+  const float slowUi = (float)UI_UPDATE_INTERVAL_MS / QUALITY_UI_INTERVAL_MS;
+  uint32_t frame = 0, overBudget = 0, switches = 0;
+  int deepest = QUALITY_FULL;
+  bool ok = true;
+
+  fprintf(out, "frame,render_ms,ui_ms,push_ms,frame_ms,smoothed_ms,budget_ms,level\n");
+  char line[256];
+  for (int lineNo = 1; fgets(line, sizeof(line), in); lineNo++) {
+    char *hash = strchr(line, '#');
+    if (hash) *hash = 0;
+    unsigned frames;
+    float renderMs, uiMs, pushMs = 0.0f;
+    int fields = sscanf(line, "%u %f %f %f", &frames, &renderMs, &uiMs, &pushMs);
+    if (fields <= 0) continue;
+    if (fields < 3) {
+      fprintf(stderr, "%s:%d: expected \"frames render_ms ui_ms [push_ms]\"\n", opt.qualityTrace.c_str(), lineNo);
+      ok = false;
+      break;
+    }
+
+    for (unsigned i = 0; i < frames; i++, frame++) {
+      float workMs = renderMs * cost[q.level] + uiMs * (q.level >= QUALITY_SLOW_UI ? slowUi : 1.0f);
+      if (workMs + pushMs > budget) overBudget++;
+      int level = q.level;
+      QualityDecision d = qualityUpdate(q, workMs, pushMs);
+      fprintf(out, "%u,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f,%d\n", frame, renderMs, uiMs, pushMs, workMs + pushMs,
+              d.frameMs, d.budgetMs, level);
+      if (d.changed) switches++;
+      if (q.level > deepest) deepest = q.level;
+    }
+  }
+  fclose(in);
+  fclose(out);
+
+  printf("quality: %u frames, %u over the %.2f ms budget (%.1f%%), %u level switches, deepest %s\n",
+         frame, overBudget, budget, frame ? 100.0f * overBudget / frame : 0.0f, switches,
+         qualityLevelName(deepest));
+  return ok;
+}
+
+// ==========================================
+// MAIN
+// ==========================================
+
+static void usage() {
+  fprintf(stderr, "usage: program [-j threads] [-o outdir] [--palette iron|rainbow] [--chunk frames]\n"
+                  "               [--stats-only] [--simd-check] [--bus-budget bytes] [--monitor]\n"
+                  "               [--quality level] [--quality-trace load.txt] recording.trf ...\n");
+}
+
+// Path components, last one without its extension; "." and empty ones dropped
+static std::vector<std::string> nameParts(const std::string &path) {
+  std::vector<std::string> parts;
+  size_t begin = 0;
+  while (begin <= path.size()) {
+    size_t slash = path.find('/', begin);
+    if (slash == std::string::npos) slash = path.size();
+    std::string part = path.substr(begin, slash - begin);
+    if (!part.empty() && part != ".") parts.push_back(part);
+    begin = slash + 1;
+  }
+  if (!parts.empty()) {
+    size_t dot = parts.back().find_last_of('.');
+    if (dot != std::string::npos && dot > 0) parts.back().resize(dot);
+  }
+  return parts;
+}
+
+static std::string joinParts(const std::vector<std::string> &parts, size_t depth) {
+  std::string name;
+  for (size_t k = parts.size() - depth; k < parts.size(); k++) {
+    if (!name.empty()) name += '_';
+    name += parts[k];
+  }
+  return name;
+}
+
+// Output stem per input: the file name, extended by one parent directory at a
+// time for inputs that share it. False (after saying which) if two inputs
+// still map to the same stem or one would overwrite quality.csv.
+static bool outputStems(const std::vector<std::string> &inputs, const Options &opt,
+                        std::vector<std::string> &stems) {
+  std::vector<std::vector<std::string>> parts;
+  std::vector<size_t> depth(inputs.size(), 1);
+  for (const auto &path : inputs) parts.push_back(nameParts(path));
+  stems.assign(inputs.size(), std::string());
+
+  for (bool grown = true; grown;) {
+    grown = false;
+    for (size_t i = 0; i < inputs.size(); i++) stems[i] = joinParts(parts[i], depth[i]);
+    for (size_t i = 0; i < inputs.size(); i++) {
+      for (size_t j = i + 1; j < inputs.size(); j++) {
+        if (stems[i] != stems[j]) continue;
+        for (size_t k : {i, j}) {
+          if (depth[k] < parts[k].size()) {
+            depth[k]++;
+            grown = true;
+          }
+        }
+      }
+    }
+  }
+
+  bool ok = true;
+  for (size_t i = 0; i < inputs.size(); i++) {
+    if (stems[i].empty()) {
+      fprintf(stderr, "%s: no file name to name outputs after\n", inputs[i].c_str());
+      ok = false;
+    }
+    if (!opt.qualityTrace.empty() && stems[i] == "quality") {
+      fprintf(stderr, "%s: outputs would overwrite quality.csv\n", inputs[i].c_str());
+      ok = false;
+    }
+    for (size_t j = i + 1; j < inputs.size(); j++) {
+      if (stems[i] != stems[j]) continue;
+      fprintf(stderr, "%s and %s: both would write %s.csv, rename one\n", inputs[i].c_str(),
+              inputs[j].c_str(), stems[i].c_str());
+      ok = false;
+    }
+  }
+  return ok;
+}
+
+int main(int argc, char **argv) {
+  Options opt;
+  std::vector<std::string> inputs;
+
+  for (int i = 1; i < argc; i++) {
+    std::string arg = argv[i];
+    bool hasValue = i + 1 < argc;
+    if (arg == "-j" && hasValue) opt.threads = atoi(argv[++i]);
+    else if (arg == "-o" && hasValue) opt.outDir = argv[++i];
+    else if (arg == "--chunk" && hasValue) opt.chunk = atoi(argv[++i]);
+    else if (arg == "--palette" && hasValue) {
+      std::string p = argv[++i];
+      if (p == "iron") opt.palette = PALETTE_IRON;
+      else if (p == "rainbow") opt.palette = PALETTE_RAINBOW;
+      else { usage(); return 2; }
+    }
+    else if (arg == "--stats-only") opt.writeImages = false;
+    else if (arg == "--simd-check") opt.simdCheck = true;
+    else if (arg == "--monitor") opt.monitor = true;
+    else if (arg == "--quality" && hasValue) opt.quality = atoi(argv[++i]);
+    else if (arg == "--quality-trace" && hasValue) opt.qualityTrace = argv[++i];
+    else if (arg == "--bus-budget" && hasValue) {
+      opt.busReplay = true;
+      opt.busBudget = (uint32_t)strtoul(argv[++i], nullptr, 0);
+    }
+    else if (arg.size() && arg[0] == '-') { usage(); return 2; }
+    else inputs.push_back(arg);
+  }
+
+  if (inputs.empty() && opt.qualityTrace.empty()) {
+    usage();
+    return 2;
+  }
+  if (opt.quality < 0 || opt.quality >= QUALITY_LEVEL_COUNT) {
+    usage();
+    return 2;
+  }
+  if (opt.threads <= 0) opt.threads = (int)std::thread::hardware_concurrency();
+  if (opt.threads <= 0) opt.threads = 1;
+  if (opt.chunk <= 0) opt.chunk = 1;
+
+  std::vector<std::string> stems;
+  if (!outputStems(inputs, opt, stems)) return 2;
+
+  mkdir(opt.outDir.c_str(), 0755);
+  for (int p = 0; p < PALETTE_COUNT; p++) buildPalette((PaletteId)p, paletteLUT[p]);
+  if (!opt.qualityTrace.empty() && !runQualityTrace(opt)) failures++;
+
+  auto start = std::chrono::steady_clock::now();
+  WorkQueue queue;
+
+  for (size_t i = 0; i < inputs.size(); i++) {
+    queue.push([&queue, path = inputs[i], stem = stems[i], &opt] {
+      auto rec = std::make_shared<Recording>();
+      rec->path = path;
+      rec->stem = stem;
+      if (!openRecording(*rec)) {
+        failures++;
+        return;
+      }
+      if (rec->frameCount == 0) {
+        finishOne(rec, opt);
+        return;
+      }
+      conditionChunk(queue, rec, opt);
+    });
+  }
+
+  queue.run(opt.threads);
+
+  double wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  printf("rendered %u frames in %.2f s on %d threads (%.0f fps", (unsigned)framesRendered.load(),
+         wall, opt.threads, wall > 0 ? framesRendered / wall : 0.0);
+  if (recordedSeconds > 0 && wall > 0) printf(", %.1fx real time", recordedSeconds / wall);
+  printf(")\n");
+  if (opt.busReplay) {
+    printf("bus: %u bytes per frame push, worst %u, budget %u, %u frames over\n",
+           (unsigned)busFrameBytes.load(), (unsigned)busWorstBytes.load(), opt.busBudget,
+           (unsigned)busOverBudget.load());
+  }
+  if (opt.simdCheck) {
+    printf("simd check: %u of %u frames differ\n", (unsigned)simdMismatches.load(), (unsigned)framesRendered.load());
+  }
+
+  return failures ? 1 : 0;
+}
+
+#endif
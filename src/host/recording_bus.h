@@ -0,0 +1,83 @@
+#pragma once
+#include <stdint.h>
+#include <vector>
+#include "bus_stats.h"
+
+// ==========================================
+// RECORDING DISPLAY BUS (host stand-in)
+// ==========================================
+
+// Accepts the subset of the Arduino_DataBus write interface the firmware's
+// push path uses, keeps a log of transfers and a running FNV-1a hash of the
+// bytes on the wire, and accounts everything in a BusLedger like
+// CountingBus does on the device.
+enum BusTransferKind : uint8_t {
+  BUS_XFER_BEGIN,
+  BUS_XFER_END,
+  BUS_XFER_COMMAND,
+  BUS_XFER_DATA
+};
+
+struct BusTransfer {
+  BusTransferKind kind;
+  uint8_t command;
+  uint32_t bytes;
+};
+
+class RecordingBus {
+public:
+  explicit RecordingBus(BusLedger &ledger) : ledger(ledger) {}
+
+  void beginWrite() {
+    busOnBeginWrite(ledger);
+    log.push_back({BUS_XFER_BEGIN, 0, 0});
+  }
+
+  void endWrite() {
+    busOnEndWrite(ledger);
+    log.push_back({BUS_XFER_END, 0, 0});
+  }
+
+  void writeCommand(uint8_t c) {
+    busOnCommand(ledger, c);
+    log.push_back({BUS_XFER_COMMAND, c, 1});
+    hashBytes(&c, 1);
+  }
+
+  void writeBytes(const uint8_t *data, uint32_t len) {
+    busOnData(ledger, len);
+    log.push_back({BUS_XFER_DATA, 0, len});
+    hashBytes(data, len);
+  }
+
+  void writeC8D16D16(uint8_t c, uint16_t d1, uint16_t d2) {
+    uint8_t data[4] = {(uint8_t)(d1 >> 8), (uint8_t)d1, (uint8_t)(d2 >> 8), (uint8_t)d2};
+    writeCommand(c);
+    writeBytes(data, sizeof(data));
+  }
+
+  // What Arduino_TFT::writeAddrWindow sends to an ILI9488 when both
+  // ranges change: CASET, RASET, RAMWR
+  void writeAddrWindow(uint16_t x, uint16_t y, uint16_t w, uint16_t h) {
+    writeC8D16D16(0x2A, x, x + w - 1);
+    writeC8D16D16(0x2B, y, y + h - 1);
+    writeCommand(0x2C);
+  }
+
+  void clear() {
+    log.clear();
+    hash = FNV_OFFSET;
+  }
+
+  std::vector<BusTransfer> log;
+  uint32_t hash = FNV_OFFSET;
+
+private:
+  static const uint32_t FNV_OFFSET = 2166136261u;
+
+  void hashBytes(const uint8_t *data, uint32_t len) {
+    for (uint32_t i = 0; i < len; i++) hash = (hash ^ data[i]) * 16777619u;
+  }
+
+  BusLedger &ledger;
+};
@@ -0,0 +1,191 @@
+#include "hotspot.h"
+
+// Two-pass connected-component labelling with union-find over provisional
+// labels, all at sensor resolution. Blobs are matched greedily to the
+// previous frame's tracks by centroid distance; unmatched blobs open new
+// tracks and tracks unmatched for HOTSPOT_MAX_AGE frames are dropped.
+
+using G = FrameGeom;
+
+// Worst case for 8-connectivity is isolated pixels on every other row/column
+static constexpr int MAX_LABELS = ((G::width + 1) / 2) * ((G::height + 1) / 2) + 1;
+
+static uint16_t labels[G::pixels];
+static uint16_t parent[MAX_LABELS];
+
+struct BlobAccum {
+  uint16_t area;
+  float sum;
+  float peak;
+  uint16_t peakIdx;
+  uint32_t sumX, sumY;
+};
+
+static BlobAccum accum[MAX_LABELS];
+static Hotspot blobs[HOTSPOT_MAX_BLOBS];
+static Hotspot tracks[HOTSPOT_MAX_BLOBS];
+static int trackCount = 0;
+static int visibleCount = 0;
+static uint16_t nextTrackId = 1;
+
+static uint16_t findRoot(uint16_t l) {
+  while (parent[l] != l) {
+    parent[l] = parent[parent[l]];
+    l = parent[l];
+  }
+  return l;
+}
+
+static void unite(uint16_t a, uint16_t b) {
+  a = findRoot(a);
+  b = findRoot(b);
+  if (a < b) parent[b] = a;
+  else if (b < a) parent[a] = b;
+}
+
+// ==========================================
+// LABELLING
+// ==========================================
+
+static int labelComponents(const float *frame, float threshold) {
+  uint16_t next = 1;
+  parent[0] = 0;
+
+  for (int y = 0; y < G::height; y++) {
+    for (int x = 0; x < G::width; x++) {
+      const int idx = y * G::width + x;
+      if (!(frame[idx] >= threshold)) {
+        labels[idx] = 0;
+        continue;
+      }
+
+      // Already-visited 8-neighbours: W, NW, N, NE
+      uint16_t w = x > 0 ? labels[idx - 1] : 0;
+      uint16_t nw = (x > 0 && y > 0) ? labels[idx - G::width - 1] : 0;
+      uint16_t n = y > 0 ? labels[idx - G::width] : 0;
+      uint16_t ne = (x < G::width - 1 && y > 0) ? labels[idx - G::width + 1] : 0;
+
+      uint16_t l = w ? w : (nw ? nw : (n ? n : ne));
+      if (!l) {
+        l = next++;
+        parent[l] = l;
+      }
+      if (nw && nw != l) unite(l, nw);
+      if (n && n != l) unite(l, n);
+      if (ne && ne != l) unite(l, ne);
+      labels[idx] = l;
+    }
+  }
+
+  for (uint16_t l = 1; l < next; l++) {
+    accum[l] = {0, 0.0f, -1e9f, 0, 0, 0};
+  }
+
+  for (int idx = 0; idx < G::pixels; idx++) {
+    if (!labels[idx]) continue;
+    BlobAccum &a = accum[findRoot(labels[idx])];
+    const float t = frame[idx];
+    a.area++;
+    a.sum += t;
+    a.sumX += idx % G::width;
+    a.sumY += idx / G::width;
+    if (t > a.peak) {
+      a.peak = t;
+      a.peakIdx = idx;
+    }
+  }
+
+  // Keep the hottest HOTSPOT_MAX_BLOBS components (insertion by peak)
+  int count = 0;
+  for (uint16_t l = 1; l < next; l++) {
+    if (parent[l] != l || accum[l].area < HOTSPOT_MIN_AREA) continue;
+
+    const BlobAccum &a = accum[l];
+    Hotspot b;
+    b.id = 0;
+    b.area = a.area;
+    b.peak = a.peak;
+    b.mean = a.sum / a.area;
+    b.cx = (float)a.sumX / a.area;
+    b.cy = (float)a.sumY / a.area;
+    b.peakX = a.peakIdx % G::width;
+    b.peakY = a.peakIdx / G::width;
+    b.missed = 0;
+
+    int pos = count < HOTSPOT_MAX_BLOBS ? count++ : HOTSPOT_MAX_BLOBS;
+    while (pos > 0 && blobs[pos - 1].peak < b.peak) {
+      if (pos < HOTSPOT_MAX_BLOBS) blobs[pos] = blobs[pos - 1];
+      pos--;
+    }
+    if (pos < HOTSPOT_MAX_BLOBS) blobs[pos] = b;
+  }
+  return count;
+}
+
+// ==========================================
+// TRACKING
+// ==========================================
+
+static void updateTracks(int blobCount) {
+  constexpr float maxDistSq = HOTSPOT_TRACK_DIST * HOTSPOT_TRACK_DIST;
+  bool trackMatched[HOTSPOT_MAX_BLOBS] = {false};
+  Hotspot updated[HOTSPOT_MAX_BLOBS];
+  int updatedCount = 0;
+
+  // Hottest blobs pick first
+  for (int b = 0; b < blobCount; b++) {
+    int best = -1;
+    float bestDistSq = maxDistSq;
+    for (int t = 0; t < trackCount; t++) {
+      if (trackMatched[t]) continue;
+      float dx = blobs[b].cx - tracks[t].cx;
+      float dy = blobs[b].cy - tracks[t].cy;
+      float d = dx * dx + dy * dy;
+      if (d <= bestDistSq) {
+        bestDistSq = d;
+        best = t;
+      }
+    }
+
+    Hotspot h = blobs[b];
+    if (best >= 0) {
+      trackMatched[best] = true;
+      h.id = tracks[best].id;
+    } else {
+      h.id = nextTrackId++;
+      if (nextTrackId == 0) nextTrackId = 1;
+    }
+    updated[updatedCount++] = h;
+  }
+
+  visibleCount = updatedCount;
+
+  for (int t = 0; t < trackCount && updatedCount < HOTSPOT_MAX_BLOBS; t++) {
+    if (trackMatched[t] || tracks[t].missed >= HOTSPOT_MAX_AGE) continue;
+    updated[updatedCount] = tracks[t];
+    updated[updatedCount].missed++;
+    updatedCount++;
+  }
+
+  for (int i = 0; i < updatedCount; i++) tracks[i] = updated[i];
+  trackCount = updatedCount;
+}
+
+int detectHotspots(const float *frame, float threshold) {
+  updateTracks(labelComponents(frame, threshold));
+  return visibleCount;
+}
+
+const Hotspot *hotspots() {
+  return tracks;
+}
+
+int hotspotCount() {
+  return visibleCount;
+}
+
+void resetHotspots() {
+  trackCount = 0;
+  visibleCount = 0;
+  nextTrackId = 1;
+}
@@ -0,0 +1,107 @@
+#include "i2c_health.h"
+#include <string.h>
+
+// Counts link errors per window of I2C_HEALTH_WINDOW frames and walks the
+// bus clock through I2C_CLOCK_LEVELS. A level that failed needs twice as many
+// clean windows before it is tried again, so a marginal harness settles on
+// the fastest clock it can actually sustain instead of oscillating.
+
+static const uint32_t clockLevels[I2C_CLOCK_LEVEL_COUNT] = I2C_CLOCK_LEVELS;
+
+static void resetWindow(I2cHealth &h) {
+  h.stats.frames = 0;
+  h.stats.nacks = 0;
+  h.stats.timeouts = 0;
+  h.stats.sanityFailures = 0;
+  h.stats.corruptFrames = 0;
+  h.stats.corruptPixels = 0;
+  h.windowTransferUs = 0;
+}
+
+void i2cHealthInit(I2cHealth &h, uint32_t startHz) {
+  memset(&h.stats, 0, sizeof(h.stats));
+
+  uint8_t level = 0;
+  for (int i = 0; i < I2C_CLOCK_LEVEL_COUNT; i++) {
+    h.stepUpBackoff[i] = I2C_STEP_UP_WINDOWS;
+    if (clockLevels[i] <= startHz) level = i;
+  }
+
+  h.stats.level = level;
+  h.stats.clockHz = clockLevels[level];
+  h.cleanWindows = 0;
+  h.consecutiveErrors = 0;
+  resetWindow(h);
+}
+
+// Melexis driver: -1 NACK / bus error, -8 frame data (aux/control) check failed.
+I2cFrameResult i2cClassifyFrame(int status, uint32_t transferUs) {
+  if (status == -8) return I2C_FRAME_SANITY;
+  if (status == -1) return I2C_FRAME_NACK;
+  if (status != 0 || transferUs > I2C_FRAME_TIMEOUT_US) return I2C_FRAME_TIMEOUT;
+  return I2C_FRAME_OK;
+}
+
+bool i2cHealthRecord(I2cHealth &h, int status, int corruptPixels, uint32_t transferUs) {
+  h.stats.frames++;
+  h.stats.lastTransferUs = transferUs;
+  h.windowTransferUs += transferUs;
+
+  bool failed = true;
+  switch (i2cClassifyFrame(status, transferUs)) {
+    case I2C_FRAME_NACK:    h.stats.nacks++; break;
+    case I2C_FRAME_TIMEOUT: h.stats.timeouts++; break;
+    case I2C_FRAME_SANITY:  h.stats.sanityFailures++; break;
+    default:                failed = false; break;
+  }
+
+  if (corruptPixels > 0) {
+    h.stats.corruptPixels += corruptPixels;
+    if (corruptPixels > (int)(SensorGeom::pixels * I2C_CORRUPT_PIXEL_RATIO)) {
+      h.stats.corruptFrames++;
+      failed = true;
+    }
+  }
+
+  if (failed) {
+    h.stats.totalErrors++;
+    h.consecutiveErrors++;
+  } else {
+    h.consecutiveErrors = 0;
+  }
+
+  bool fastFail = h.consecutiveErrors >= I2C_FAST_FAIL_ERRORS;
+  if (h.stats.frames < I2C_HEALTH_WINDOW && !fastFail) return false;
+
+  uint32_t errors = h.stats.nacks + h.stats.timeouts + h.stats.sanityFailures + h.stats.corruptFrames;
+  h.stats.lastWindowErrors = errors;
+  h.stats.avgTransferUs = (uint32_t)(h.windowTransferUs / h.stats.frames);
+
+  uint8_t next = h.stats.level;
+  if (errors >= I2C_STEP_DOWN_ERRORS || fastFail) {
+    h.cleanWindows = 0;
+    if (h.stats.level > 0) {
+      uint32_t backoff = h.stepUpBackoff[h.stats.level] * 2;
+      h.stepUpBackoff[h.stats.level] = backoff > I2C_STEP_UP_MAX_WINDOWS ? I2C_STEP_UP_MAX_WINDOWS : backoff;
+      next = h.stats.level - 1;
+    }
+  } else if (errors == 0) {
+    h.cleanWindows++;
+    if (h.stats.level + 1 < I2C_CLOCK_LEVEL_COUNT && h.cleanWindows >= h.stepUpBackoff[h.stats.level + 1]) {
+      h.cleanWindows = 0;
+      next = h.stats.level + 1;
+    }
+  } else {
+    h.cleanWindows = 0;
+  }
+
+  h.consecutiveErrors = 0;
+  resetWindow(h);
+
+  if (!I2C_ADAPTIVE_CLOCK || next == h.stats.level) return false;
+
+  h.stats.level = next;
+  h.stats.clockHz = clockLevels[next];
+  h.stats.clockChanges++;
+  return true;
+}
@@ -0,0 +1,69 @@
+#include "inject.h"
+#include <Arduino.h>
+#include "geometry.h"
+#include "recording.h"
+
+static bool active = false;
+static uint32_t frameTotal = 0;     // 0: until the host goes silent
+static uint32_t framesRead = 0;
+static uint32_t lastTransferUs = 0;
+
+static bool readExact(void *dst, size_t bytes) {
+  return Serial.readBytes(static_cast<uint8_t *>(dst), bytes) == bytes;
+}
+
+bool injectBegin() {
+  Serial.setTimeout(INJECT_TIMEOUT_MS);
+
+  RecordingHeader h;
+  if (!readExact(&h, sizeof(h))) {
+    Serial.println("inject: no recording header");
+    return false;
+  }
+  if (h.magic != RECORDING_MAGIC || h.version != RECORDING_VERSION ||
+      h.width != FrameGeom::width || h.height != FrameGeom::height) {
+    Serial.printf("inject: rejected %ux%u recording (v%u), this build takes %dx%d\n",
+                  h.width, h.height, h.version, FrameGeom::width, FrameGeom::height);
+    return false;
+  }
+
+  frameTotal = h.frameCount;
+  framesRead = 0;
+  active = true;
+  Serial.printf("inject: %lu frames\n", (unsigned long)frameTotal);
+  return true;
+}
+
+void injectEnd() {
+  active = false;
+}
+
+bool injectActive() {
+  return active;
+}
+
+int injectReadFrame(float *buf) {
+  uint32_t start = micros();
+  Serial.write((const uint8_t *)"inj>\n", 5);
+
+  RecordingFrameHeader h;
+  bool ok = readExact(&h, sizeof(h)) && readExact(buf, FrameGeom::pixels * sizeof(float));
+  lastTransferUs = micros() - start;
+  if (!ok) {
+    Serial.println("inject: host timed out");
+    injectEnd();
+    return INJECT_STATUS_TIMEOUT;
+  }
+
+  framesRead++;
+  if (frameTotal && framesRead >= frameTotal) injectEnd();
+  return h.status;
+}
+
+uint32_t injectFrameCount() {
+  return framesRead;
+}
+
+uint32_t injectTransferUs() {
+  return lastTransferUs;
+}
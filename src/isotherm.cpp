@@ -0,0 +1,78 @@
+#include "isotherm.h"
+#include <math.h>
+
+// Cell corners: tl = 8, tr = 4, br = 2, bl = 1. Edges: 0 top, 1 right,
+// 2 bottom, 3 left. Saddles (5, 10) are resolved with the cell centre.
+
+using G = FrameGeom;
+
+static const int8_t CASE_EDGES[16][4] = {
+  {-1, -1, -1, -1}, {3, 2, -1, -1}, {2, 1, -1, -1}, {3, 1, -1, -1},
+  {0, 1, -1, -1},   {-1, -1, -1, -1}, {0, 2, -1, -1}, {0, 3, -1, -1},
+  {0, 3, -1, -1},   {0, 2, -1, -1}, {-1, -1, -1, -1}, {0, 1, -1, -1},
+  {3, 1, -1, -1},   {1, 2, -1, -1}, {3, 2, -1, -1}, {-1, -1, -1, -1}
+};
+
+static inline uint16_t toFixed(float v) {
+  return (uint16_t)(v * 256.0f + 0.5f);
+}
+
+static inline float crossing(float a, float b, float level) {
+  float d = b - a;
+  return d != 0.0f ? (level - a) / d : 0.5f;
+}
+
+int extractIsotherms(const float *frame, const float *levels, int levelCount,
+                     IsoSegment *out, int maxSegments) {
+  int count = 0;
+
+  for (int l = 0; l < levelCount; l++) {
+    const float level = levels[l];
+
+    for (int y = 0; y < G::height - 1; y++) {
+      const float *row0 = &frame[y * G::width];
+      const float *row1 = row0 + G::width;
+
+      for (int x = 0; x < G::width - 1; x++) {
+        const float tl = row0[x], tr = row0[x + 1];
+        const float bl = row1[x], br = row1[x + 1];
+
+        const int c = (tl >= level ? 8 : 0) | (tr >= level ? 4 : 0) |
+                      (br >= level ? 2 : 0) | (bl >= level ? 1 : 0);
+        if (c == 0 || c == 15) continue;
+
+        // Crossing point on each edge, sensor coordinates
+        float ex[4], ey[4];
+        ex[0] = x + crossing(tl, tr, level); ey[0] = (float)y;
+        ex[1] = (float)(x + 1);              ey[1] = y + crossing(tr, br, level);
+        ex[2] = x + crossing(bl, br, level); ey[2] = (float)(y + 1);
+        ex[3] = (float)x;                    ey[3] = y + crossing(tl, bl, level);
+
+        int8_t edges[4] = {CASE_EDGES[c][0], CASE_EDGES[c][1], CASE_EDGES[c][2], CASE_EDGES[c][3]};
+        if (c == 5 || c == 10) {
+          const bool centreHigh = (tl + tr + bl + br) * 0.25f >= level;
+          // High centre joins the high corners, so the low ones are cut off
+          const bool cutTopLeft = (c == 5) == centreHigh;
+          if (cutTopLeft) {
+            edges[0] = 0; edges[1] = 3; edges[2] = 1; edges[3] = 2;
+          } else {
+            edges[0] = 0; edges[1] = 1; edges[2] = 3; edges[3] = 2;
+          }
+        }
+
+        for (int s = 0; s < 4 && edges[s] >= 0; s += 2) {
+          if (count >= maxSegments) return count;
+          IsoSegment &seg = out[count++];
+          seg.x0 = toFixed(ex[edges[s]]);
+          seg.y0 = toFixed(ey[edges[s]]);
+          seg.x1 = toFixed(ex[edges[s + 1]]);
+          seg.y1 = toFixed(ey[edges[s + 1]]);
+          seg.level = (uint8_t)l;
+          seg.reserved = 0;
+        }
+      }
+    }
+  }
+
+  return count;
+}
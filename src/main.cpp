@@ -5,7 +5,7 @@
 //   - MLX90640: Melexis official datasheet and application notes (infrared thermal sensor array, I2C communication protocol)
 //   - Display ILI9488: ILI Technology Corp. datasheet (480x320 TFT LCD controller, SPI interface)
 //   - ESP32-S3: Espressif Systems official documentation (ESP-IDF) + (I2C master driver, SPI master driver, GPIO control)
-//   - Libraries: Adafruit MLX90640 (official), Arduino_GFX (official)
+//   - Libraries: Melexis MLX90640 API (official), Arduino_GFX (official)
 //   - Framebuffer technique for real-time video display
 
 
@@ -25,16 +25,31 @@
 
 #include <Arduino.h>
 #include "main.h"
+#include "arena.h"
+#include "binlog.h"
+#include "pipeline.h"
 #include "display.h"
 #include "sensor.h"
 #include "button.h"
+#include "burst.h"
+#include "bus_stats.h"
+#include "checksum.h"
+#include "trace.h"
+#include "frame_interp.h"
+#include "hotspot.h"
+#include "inject.h"
+#include "monitor.h"
+#include "quality.h"
+#include "recording.h"
+#include "view.h"
 
 // ==========================================
 // GLOBAL STATE
 // ==========================================
 
-static float rawFrameBuffer[MLX_W * MLX_H];
-static float smoothedFrameBuffer[MLX_W * MLX_H];
+static float *rawFrameBuffer = nullptr;
+static float *smoothedFrameBuffer = nullptr;
+static float *displayFrameBuffer = nullptr;
 static DisplayMode currentMode = MODE_LIVE;
 static float lastMinTemp = 0.0f;
 static float lastMaxTemp = 0.0f;
@@ -43,75 +58,380 @@ static uint32_t frameCounter = 0;
 static uint32_t lastStatsTime = 0;
 static float currentFPS = 0.0f;
 static uint32_t renderTimeAccum = 0;
+static uint32_t upscaleTimeAccum = 0;
+static uint32_t foveaPixelAccum = 0;
 
 static uint32_t lastUIUpdate = 0;
-static const uint32_t UI_UPDATE_INTERVAL = 100; 
+static const uint32_t UI_UPDATE_INTERVAL = UI_UPDATE_INTERVAL_MS; 
+static QualityController quality;
+static bool firstFrameShown = false;
+static uint32_t lastDisplayUs = 0;
+static const uint32_t DISPLAY_FRAME_US = 1000000UL / TARGET_FPS;
 
 // ==========================================
-// OPTIMIZED MIN/MAX 
+// MONITORING
 // ==========================================
 
-void findMinMaxOptimized(const float *buf, float &tMin, float &tMax) {
-  tMin = MAX_TEMP_RANGE;
-  tMax = MIN_TEMP_INIT;
+// Statistics accumulate from every conditioned frame while a mode that
+// acquires is active; MODE_MONITOR only selects how they are shown. The
+// view is rendered on the UI core from counters the acquisition core may
+// be updating, which at worst mixes two frames for one display frame.
+static Monitor monitor;
+static MonitorView monitorView = MONITOR_VIEW_MAX_HOLD;
+static float *monitorViewBuffer = nullptr;
+
+static void initMonitoring() {
+  if (!MONITOR_ENABLED) return;
+  initMonitor(monitor, memBuffer(BUF_MONITOR_STATS), memBufferAs<MonitorSnapshot>(BUF_MONITOR_SNAPS),
+              (int)(memBufferBytes(BUF_MONITOR_SNAPS) / MONITOR_SNAPSHOT_BYTES));
+  monitorViewBuffer = memBufferAs<float>(BUF_MONITOR_VIEW);
+}
 
-  int i = 0;
-  int limit = (MLX_W * MLX_H) - 3;
-  
-  for (; i < limit; i += 4) {
-    float t0 = buf[i];
-    float t1 = buf[i + 1];
-    float t2 = buf[i + 2];
-    float t3 = buf[i + 3];
-    
-    if (t0 >= -40.0f && t0 <= 300.0f) {
-      if (t0 < tMin) tMin = t0;
-      if (t0 > tMax) tMax = t0;
-    }
-    if (t1 >= -40.0f && t1 <= 300.0f) {
-      if (t1 < tMin) tMin = t1;
-      if (t1 > tMax) tMax = t1;
-    }
-    if (t2 >= -40.0f && t2 <= 300.0f) {
-      if (t2 < tMin) tMin = t2;
-      if (t2 > tMax) tMax = t2;
-    }
-    if (t3 >= -40.0f && t3 <= 300.0f) {
-      if (t3 < tMin) tMin = t3;
-      if (t3 > tMax) tMax = t3;
-    }
+static void dumpMonitor() {
+  Serial.printf("monitor: %lu frames, %d snapshots of %dx%d cells (C x %d)\n", (unsigned long)monitor.frames,
+                monitor.snapshotCount, FrameGeom::width / MONITOR_SNAPSHOT_DECIMATE,
+                FrameGeom::height / MONITOR_SNAPSHOT_DECIMATE, MONITOR_TEMP_SCALE);
+  for (int k = 0; k < monitor.snapshotCount; k++) {
+    const MonitorSnapshot &s = monitorSnapshot(monitor, k);
+    Serial.printf("%lu,%lu,max", (unsigned long)s.timeMs, (unsigned long)s.frames);
+    for (int c = 0; c < MONITOR_CELLS; c++) Serial.printf(",%d", s.maxC[c]);
+    Serial.printf("\n%lu,%lu,mean", (unsigned long)s.timeMs, (unsigned long)s.frames);
+    for (int c = 0; c < MONITOR_CELLS; c++) Serial.printf(",%d", s.meanC[c]);
+    Serial.println();
   }
+}
 
-  for (; i < MLX_W * MLX_H; i++) {
-    float temp = buf[i];
-    if (temp >= -40.0f && temp <= 300.0f) {
-      if (temp < tMin) tMin = temp;
-      if (temp > tMax) tMax = temp;
-    }
+static bool modeAcquires(DisplayMode mode) {
+  return mode == MODE_LIVE || mode == MODE_RGB || mode == MODE_MONITOR;
+}
+
+// ==========================================
+// CONDITIONING
+// ==========================================
+
+// Only one of the smoothing graphs runs (see PIPELINES in pipeline.h), so
+// both are bound to the smoothed frame buffer
+static SmoothingPipeline smoothingPipeline;
+static ConditionPipeline conditionPipeline;
+static RangePipeline rangePipeline;
+
+static_assert(ConditionPipeline::bufferBytes <= MEM_BUFFER_SPECS[BUF_SMOOTHED_FRAME].bytes &&
+              SmoothingPipeline::bufferBytes <= MEM_BUFFER_SPECS[BUF_SMOOTHED_FRAME].bytes,
+              "pipeline stage buffers outgrew BUF_SMOOTHED_FRAME");
+
+static void initPipelines() {
+  uint8_t *stageBuffer = memBufferAs<uint8_t>(BUF_SMOOTHED_FRAME);
+  smoothingPipeline.bind(stageBuffer);
+  conditionPipeline.bind(stageBuffer);
+  rangePipeline.bind(nullptr);
+  smoothedFrameBuffer = conditionPipeline.stage<0>().smoothed;
+}
+
+static volatile bool injecting = false;
+
+static void conditionFrame() {
+  if (MONITOR_ENABLED && !injecting) monitorUpdate(monitor, rawFrameBuffer, millis());
+  if (FRAME_INTERPOLATION) smoothingPipeline.run(rawFrameBuffer);
+  else conditionPipeline.run(rawFrameBuffer);
+}
+
+// Without interpolation the range of the smoothed frame was already taken
+// while conditioning
+static const RangeStage &displayRange(const float *frame) {
+  if (!FRAME_INTERPOLATION && frame == smoothedFrameBuffer) return conditionPipeline.stage<1>();
+  rangePipeline.run(frame);
+  return rangePipeline.stage<0>();
+}
+
+// ==========================================
+// BURST CAPTURE
+// ==========================================
+
+// Hold: the sensor switches to BURST_REFRESH_HZ and the UI core does
+// nothing but read raw subpages into the ring until the next press. Review
+// then shows one sample at a time over the one before it (short press:
+// next, long press: previous, hold: back to live). Samples
+// are only decoded when shown or exported, into rawFrameBuffer, so the
+// acquisition task stays parked until review ends.
+enum BurstState {
+  BURST_IDLE = 0,
+  BURST_CAPTURE = 1,
+  BURST_REVIEW = 2
+};
+
+static BurstRing burst;
+static volatile BurstState burstState = BURST_IDLE;
+static volatile bool acquisitionBusy = false;
+static int burstCursor = 0;
+
+// The ring lives only in the PSRAM arena; without PSRAM at runtime a hold
+// keeps cycling the zoom
+static void initBurstCapture() {
+  if (!BURST_ENABLED) return;
+  if (!memBuffer(BUF_BURST_RING)) {
+    Serial.println("burst: no PSRAM, capture disabled");
+    return;
+  }
+  initBurst(burst, memBufferAs<BurstSample>(BUF_BURST_RING),
+            (int)(memBufferBytes(BUF_BURST_RING) / BURST_SAMPLE_BYTES));
+}
+
+static bool burstAvailable() {
+  return BURST_ENABLED && burst.samples != nullptr;
+}
+
+// In chess mode a subpage carries half the pixels, so sample k is decoded
+// over sample k - 1
+static void decodeBurstFrame(int k, float *out) {
+  for (int j = k > 0 ? k - 1 : 0; j <= k; j++) {
+    BurstSample &s = burstSample(burst, j);
+    if (s.status >= 0) decodeSubpage(s.raw, out);
+  }
+}
+
+static void showBurstSample(int k) {
+  decodeBurstFrame(k, rawFrameBuffer);
+  const RangeStage &range = displayRange(rawFrameBuffer);
+  if (HOTSPOT_ENABLED) detectHotspots(rawFrameBuffer, range.tMin + HOTSPOT_LEVEL * (range.tMax - range.tMin));
+  drawThermalImage(rawFrameBuffer, range.tMin, range.tMax, MODE_LIVE);
+  drawLegend(range.tMin, range.tMax, burstRateHz(burst));
+  drawBurstStatus(k, burst.count);
+
+  const BurstSample &s = burstSample(burst, k);
+  Serial.printf("burst %d/%d: +%.2f ms, subpage %u, status %d\n", k + 1, burst.count,
+                (s.timestampUs - burstSample(burst, 0).timestampUs) / MICRO_TO_MS, s.subpage, s.status);
+}
+
+static void captureBurst() {
+  burstState = BURST_CAPTURE;
+  while (acquisitionBusy) delay(1);
+
+  if (!beginBurstAcquisition()) {
+    Serial.println("burst: calibration read failed, not capturing");
+    burstState = BURST_IDLE;
+    return;
+  }
+
+  drawBurstStatus(-1, 0);
+  burstReset(burst);
+  while (buttonEvent() == BTN_NONE) {
+    BurstSample &s = burstNext(burst);
+    int status = readSubpage(s.raw);
+    s.timestampUs = micros();
+    s.status = status < 0 ? status : 0;
+    s.subpage = status < 0 ? 0 : status;
+    burstCommit(burst, s);
+    traceInstant(TRACE_BURST, s.subpage);
+    buttonUpdate();
+  }
+  endBurstAcquisition();
+
+  logWrite(LOG_BURST, burst.captured, burst.count, burstSpanUs(burst) / MICRO_TO_MS,
+           burstRateHz(burst), burst.errors);
+  if (burst.count == 0) {
+    burstState = BURST_IDLE;
+    return;
+  }
+
+  burstState = BURST_REVIEW;
+  burstCursor = burst.count - 1;
+  showBurstSample(burstCursor);
+}
+
+static void handleBurstReview(ButtonEvent event) {
+  if (event == BTN_SHORT) {
+    burstCursor = (burstCursor + 1) % burst.count;
+    showBurstSample(burstCursor);
+  } else if (event == BTN_LONG) {
+    burstCursor = (burstCursor + burst.count - 1) % burst.count;
+    showBurstSample(burstCursor);
+  } else if (event == BTN_HOLD) {
+    burstState = BURST_IDLE;
+    resetDisplayState();
+    gfx->fillScreen(COL_BG);
   }
 }
 
+// Binary recording (recording.h) right after a text line with its size;
+// frame k is sample k + 1 decoded over sample k
+static void exportBurst() {
+  if (burstState != BURST_REVIEW || burst.count < 2) {
+    Serial.println("burst: nothing to export (export from burst review)");
+    return;
+  }
+
+  RecordingHeader header = {RECORDING_MAGIC, RECORDING_VERSION, 0,
+                            FrameGeom::width, FrameGeom::height, (uint32_t)(burst.count - 1)};
+  uint32_t bytes = sizeof(header) + header.frameCount * recordingFrameBytes(header.width, header.height);
+  logFlush();
+  Serial.printf("burst: %lu bytes follow\n", (unsigned long)bytes);
+  Serial.write((const uint8_t *)&header, sizeof(header));
+
+  uint32_t startUs = burstSample(burst, 0).timestampUs;
+  for (int k = 1; k < burst.count; k++) {
+    decodeBurstFrame(k, rawFrameBuffer);
+    const BurstSample &s = burstSample(burst, k);
+    RecordingFrameHeader frame = {s.timestampUs - startUs, s.status};
+    Serial.write((const uint8_t *)&frame, sizeof(frame));
+    Serial.write((const uint8_t *)rawFrameBuffer, SENSOR_FRAME_BYTES);
+  }
+  showBurstSample(burstCursor);
+}
+
 // ==========================================
-// OPTIMIZED SMOOTHING
+// HIL FRAME INJECTION
 // ==========================================
 
-void applySmoothingOptimized(float *smoothed, const float *raw) {
-  const float alpha = FRAME_SMOOTHING;
-  const float beta = 1.0f - FRAME_SMOOTHING;
+// INJECT_CMD hands the frame source to the host (inject.h, driven by
+// scripts/inject_frames.py). Injected frames are read and conditioned on
+// this core, one per loop pass whatever FRAME_INTERPOLATION says, so each
+// one is rendered exactly once. Conditioning, hotspot tracks and display
+// smoothing start from a clean state and quality stays at QUALITY_FULL, so
+// two runs of one recording on one build report the same checksums.
+static void resetReplayState() {
+  resetConditioning();
+  initPipelines();
+  resetHotspots();
+  resetDisplayState();
+  initQuality(quality);
+  setRenderQuality(QUALITY_FULL);
+}
 
-  int i = 0;
-  int limit = (MLX_W * MLX_H) - 3;
-  
-  for (; i < limit; i += 4) {
-    smoothed[i]     = smoothed[i]     * alpha + raw[i]     * beta;
-    smoothed[i + 1] = smoothed[i + 1] * alpha + raw[i + 1] * beta;
-    smoothed[i + 2] = smoothed[i + 2] * alpha + raw[i + 2] * beta;
-    smoothed[i + 3] = smoothed[i + 3] * alpha + raw[i + 3] * beta;
+static void startInjection() {
+  if (currentMode != MODE_LIVE || burstState != BURST_IDLE) {
+    Serial.println("inject: only from LIVE mode");
+    return;
+  }
+
+  injecting = true;
+  while (acquisitionBusy) delay(1);
+  logPause(true);
+  if (!injectBegin()) {
+    logPause(false);
+    injecting = false;
+    return;
+  }
+  resetReplayState();
+  gfx->fillScreen(COL_BG);
+}
+
+static void finishInjection() {
+  Serial.printf("inject: done after %lu frames\n", (unsigned long)injectFrameCount());
+  resetReplayState();
+  injecting = false;
+  logPause(false);
+}
+
+// Conditioned frame, or nullptr when it was rejected or never arrived;
+// the transfer from the host is not counted as conditioning
+static const float *readInjectedFrame(uint32_t &conditionUs) {
+  uint32_t start = micros();
+  bool frameOk = readFrame(rawFrameBuffer);
+  if (frameOk) conditionFrame();
+  conditionUs = micros() - start - injectTransferUs();
+  return frameOk ? smoothedFrameBuffer : nullptr;
+}
+
+// One line per injected frame, before the next prompt:
+// inj,index,ok,condition_us,render_us,work_us,frame_crc,fb_crc
+static void reportInjectedFrame(const float *frame, uint32_t conditionUs, uint32_t renderUs, uint32_t workUs) {
+  uint32_t frameCrc = frame ? crc32Bytes(frame, SENSOR_FRAME_BYTES) : 0;
+  uint32_t fbCrc = frame ? frameBufferCrc() : 0;
+  Serial.printf("inj,%lu,%d,%lu,%lu,%lu,%08lx,%08lx\n", (unsigned long)injectFrameCount() - 1, frame != nullptr,
+                (unsigned long)conditionUs, (unsigned long)renderUs, (unsigned long)workUs,
+                (unsigned long)frameCrc, (unsigned long)fbCrc);
+}
+
+// ==========================================
+// SERIAL COMMANDS
+// ==========================================
+
+static void pollSerialCommands() {
+  if (Serial.available() <= 0) return;
+  int cmd = Serial.read();
+
+  if (TRACE_ENABLED && cmd == TRACE_DUMP_CMD) {
+    traceDump();
+  } else if (MONITOR_ENABLED && cmd == MONITOR_DUMP_CMD) {
+    dumpMonitor();
+  } else if (MONITOR_ENABLED && cmd == MONITOR_RESET_CMD) {
+    monitorReset(monitor);
+    Serial.println("monitor reset, next frame is the baseline");
+  } else if (burstAvailable() && cmd == BURST_EXPORT_CMD) {
+    exportBurst();
+  } else if (INJECT_ENABLED && cmd == INJECT_CMD) {
+    startInjection();
   }
+}
+
+// ==========================================
+// QUALITY CONTROL
+// ==========================================
+
+// Work per displayed frame (range, hotspots, render, UI) against what the
+// framebuffer push leaves of the TARGET_FPS budget. No level shrinks the
+// push, so it is passed apart; sensor reads and the pacing wait are not
+// counted.
+static void updateQuality(uint32_t frameWorkUs, uint32_t pushUs) {
+  if (!QUALITY_ADAPTIVE) return;
+  QualityDecision d = qualityUpdate(quality, (frameWorkUs - pushUs) / MICRO_TO_MS, pushUs / MICRO_TO_MS);
+  if (!d.changed) return;
+
+  setRenderQuality(d.to);
+  traceInstant(TRACE_QUALITY, (uint16_t)d.to);
+  logWrite(LOG_QUALITY, d.from, d.to, d.frameMs, quality.pushMs, d.budgetMs);
+}
+
+static uint32_t uiUpdateInterval() {
+  return quality.level >= QUALITY_SLOW_UI ? QUALITY_UI_INTERVAL_MS : UI_UPDATE_INTERVAL;
+}
+
+// ==========================================
+// DISPLAY-RATE UPSAMPLING
+// ==========================================
 
-  for (; i < MLX_W * MLX_H; i++) {
-    smoothed[i] = smoothed[i] * alpha + raw[i] * beta;
+static void acquisitionTask(void *param) {
+  for (;;) {
+    // Busy is raised before the state check so captureBurst() and
+    // startInjection() can wait it out
+    acquisitionBusy = true;
+    if (!modeAcquires(currentMode) || burstState != BURST_IDLE || injecting) {
+      acquisitionBusy = false;
+      delay(PAUSE_DELAY_MS);
+      continue;
+    }
+
+    traceBegin(TRACE_SENSOR_READ);
+    bool frameOk = readFrame(rawFrameBuffer);
+    traceEnd(TRACE_SENSOR_READ);
+
+    if (frameOk) {
+      conditionFrame();
+      pushConditionedFrame(smoothedFrameBuffer, micros());
+    }
+    acquisitionBusy = false;
+  }
+}
+
+static void startFrameInterpolation() {
+  float *interpBase = memBufferAs<float>(BUF_INTERP_FRAMES);
+  displayFrameBuffer = interpBase + 3 * FrameGeom::pixels;
+  initFrameInterp(interpBase, interpBase + FrameGeom::pixels, interpBase + 2 * FrameGeom::pixels);
+
+  static StaticTask_t acquireTcb;
+  xTaskCreateStaticPinnedToCore(acquisitionTask, "acquire", ACQUIRE_TASK_STACK, nullptr, ACQUIRE_TASK_PRIORITY,
+                                memBufferAs<StackType_t>(BUF_STACK_ACQUIRE), &acquireTcb, SENSOR_TASK_CORE);
+}
+
+static const float *nextDisplayFrame() {
+  uint32_t now = micros();
+  if (now - lastDisplayUs < DISPLAY_FRAME_US || !synthesizeFrame(displayFrameBuffer, now)) {
+    delay(1);
+    return nullptr;
   }
+
+  lastDisplayUs = now;
+  return displayFrameBuffer;
 }
 
 // ==========================================
@@ -120,17 +440,57 @@ void applySmoothingOptimized(float *smoothed, const float *raw) {
 
 void switchToNextMode() {
   currentMode = (DisplayMode)((currentMode + 1) % MODE_COUNT);
+  if (currentMode == MODE_MONITOR && !MONITOR_ENABLED) currentMode = MODE_LIVE;
+  monitorView = MONITOR_VIEW_MAX_HOLD;
   
-  const char* modeNames[] = {"LIVE", "PAUSED", "RGB", "CHARGING"};
+  const char* modeNames[] = {"LIVE", "PAUSED", "RGB", "CHARGING", "MONITOR"};
   Serial.print("Switched to mode: ");
   Serial.println(modeNames[currentMode]);
   
   if (currentMode == MODE_LIVE) {
     resetDisplayState();
     gfx->fillScreen(COL_BG);
+  } else if (currentMode == MODE_RGB) {
+    repaintFrame(currentMode);
   } else if (currentMode == MODE_CHARGING) {
     gfx->fillRect(FB_X_OFFSET, FB_Y_OFFSET, FB_WIDTH, FB_HEIGHT, rgb565(128, 128, 128));
+  } else if (currentMode == MODE_MONITOR) {
+    Serial.printf("monitor view: %s\n", monitorViewName(monitorView));
+  }
+}
+
+// Monitor views sit between MONITOR and the next mode in the short press cycle
+static void handleShortPress() {
+  if (currentZoom() > 1 && modeAcquires(currentMode)) {
+    viewPanNext();
+  } else if (currentMode == MODE_MONITOR && monitorView + 1 < MONITOR_VIEW_COUNT) {
+    monitorView = (MonitorView)(monitorView + 1);
+    Serial.printf("monitor view: %s\n", monitorViewName(monitorView));
+  } else {
+    switchToNextMode();
+  }
+}
+
+// Takes effect with the next rendered frame; a paused image keeps its view
+static void cycleZoom() {
+  viewCycleZoom();
+  const ViewWindow &view = currentView();
+  Serial.printf("zoom %dx at %u,%u\n", currentZoom(), view.originX, view.originY);
+}
+
+// ==========================================
+// FAST BOOT
+// ==========================================
+
+static bool waitForSensorBoot() {
+  uint32_t splashStart = millis();
+
+  while (sensorBootState() == SENSOR_BOOT_PENDING || millis() - splashStart < FAST_BOOT_SPLASH_MIN_MS) {
+    if (millis() - splashStart > SENSOR_BOOT_TIMEOUT_MS + SENSOR_PROBE_TIMEOUT_MS) return false;
+    delay(5);
   }
+
+  return sensorBootState() == SENSOR_BOOT_READY;
 }
 
 // ==========================================
@@ -139,18 +499,38 @@ void switchToNextMode() {
 
 void setup() {
   Serial.begin(SERIAL_BAUD);
-  delay(SETUP_DELAY_MS);
+  if (!FAST_BOOT) delay(SETUP_DELAY_MS);
   
   Serial.println("=================================");
   Serial.println("  THERMAL CAMERA v3.2");
   Serial.println("  by Danylo Bielov");
   Serial.println("=================================");
   
-  initDisplay();
-  displayStartupScreen();
-  initButton();
+  initMemory();
+  initTrace();
+  initLog();
+  rawFrameBuffer = memBufferAs<float>(BUF_RAW_FRAME);
+  initPipelines();
+  initMonitoring();
+  initBurstCapture();
+  initQuality(quality);
   
-  if (!initSensor()) {
+  bool sensorOk;
+  if (FAST_BOOT) {
+    beginSensorAsync(rawFrameBuffer);
+    initDisplay();
+    drawStartupScreen();
+    initButton();
+    sensorOk = waitForSensorBoot();
+    gfx->fillScreen(COL_BG);
+  } else {
+    initDisplay();
+    displayStartupScreen();
+    initButton();
+    sensorOk = initSensor();
+  }
+  
+  if (!sensorOk) {
     gfx->fillScreen(COL_BG);
     gfx->setCursor(UI_ERROR_X, UI_ERROR_Y_MAIN);
     gfx->setTextSize(UI_ERROR_TEXT_SIZE);
@@ -163,8 +543,12 @@ void setup() {
     while (1) delay(SENSOR_ERROR_WAIT);
   }
 
-// memset(rawFrameBuffer, 0, sizeof(rawFrameBuffer));
-// memset(smoothedFrameBuffer, 0, sizeof(smoothedFrameBuffer));
+  if (FRAME_INTERPOLATION) startFrameInterpolation();
+
+  reportMemory();
+
+// memset(rawFrameBuffer, 0, SENSOR_FRAME_BYTES);
+// memset(smoothedFrameBuffer, 0, SENSOR_FRAME_BYTES);
 // gfx->fillScreen(COL_BG);
 // resetDisplayState();
 // lastStatsTime = millis();
@@ -176,10 +560,25 @@ void setup() {
 // ==========================================
 
 void loop() {
+  // While injecting, serial input is frame data and the buttons are ignored
+  if (!injecting) pollSerialCommands();
   buttonUpdate();
   
-  if (buttonPressed()) {
-    switchToNextMode();
+  ButtonEvent event = buttonEvent();
+  if (injecting) event = BTN_NONE;
+  if (burstState == BURST_REVIEW) {
+    handleBurstReview(event);
+    delay(PAUSE_DELAY_MS);
+    return;
+  }
+
+  if (burstAvailable() && event == BTN_HOLD && modeAcquires(currentMode)) {
+    captureBurst();
+    return;
+  } else if (event == BTN_LONG || event == BTN_HOLD) {
+    cycleZoom();
+  } else if (event == BTN_SHORT) {
+    handleShortPress();
   }
   
   if (currentMode == MODE_CHARGING) {
@@ -195,52 +594,104 @@ void loop() {
     return;
   }
 
-  if (currentMode == MODE_LIVE || currentMode == MODE_RGB) {
+  if (modeAcquires(currentMode)) {
+
+    const float *frame = nullptr;
+    uint32_t injectedFrames = injectFrameCount();
+    uint32_t conditionUs = 0;
+    uint32_t renderTime = 0;
+    uint32_t frameWorkUs = 0;
+
+    if (injecting) {
+      frame = readInjectedFrame(conditionUs);
+    } else if (FRAME_INTERPOLATION) {
+      frame = nextDisplayFrame();
+    } else {
+      traceBegin(TRACE_SENSOR_READ);
+      bool frameOk = readFrame(rawFrameBuffer);
+      traceEnd(TRACE_SENSOR_READ);
+
+      if (frameOk) {
+        conditionFrame();
+        frame = smoothedFrameBuffer;
+      }
+    }
 
-    if (readFrame(rawFrameBuffer)) {
+    if (frame && currentMode == MODE_MONITOR) {
+      monitorRenderView(monitor, monitorView, frame, monitorViewBuffer);
+      frame = monitorViewBuffer;
+    }
 
-      applySmoothingOptimized(smoothedFrameBuffer, rawFrameBuffer);
-      float tMin, tMax;
-      findMinMaxOptimized(smoothedFrameBuffer, tMin, tMax);
-      
-      if (tMax - tMin < MIN_TEMP_RANGE) {
-        tMax = tMin + MIN_TEMP_RANGE;
-      }
-     
-      if (tMax - tMin > 100.0f) {
-        float center = (tMin + tMax) / 2.0f;
-        tMin = center - 50.0f;
-        tMax = center + 50.0f;
+    if (frame) {
+      traceBegin(TRACE_FRAME);
+      uint32_t frameStart = micros();
+
+      const RangeStage &range = displayRange(frame);
+      float tMin = range.tMin;
+      float tMax = range.tMax;
+
+      if (HOTSPOT_ENABLED) {
+        traceBegin(TRACE_HOTSPOT);
+        detectHotspots(frame, tMin + HOTSPOT_LEVEL * (tMax - tMin));
+        traceEnd(TRACE_HOTSPOT);
       }
       
       lastMinTemp = tMin;
       lastMaxTemp = tMax;
       uint32_t renderStart = micros();
-      drawThermalImage(smoothedFrameBuffer, tMin, tMax, currentMode);
-      uint32_t renderTime = micros() - renderStart;
+      drawThermalImage(frame, tMin, tMax, currentMode);
+      renderTime = micros() - renderStart;
+
+      if (!firstFrameShown) {
+        Serial.printf("time to first frame: %lu ms\n", millis());
+        firstFrameShown = true;
+      }
     
       uint32_t now = millis();
-      if (now - lastUIUpdate >= UI_UPDATE_INTERVAL) {
+      if (now - lastUIUpdate >= uiUpdateInterval()) {
+        traceBegin(TRACE_UI);
         drawMenu(currentMode);
         drawLegend(tMin, tMax, currentFPS);
+        traceEnd(TRACE_UI);
         lastUIUpdate = now;
       }
 
+      if (BUS_STATS_ENABLED) busFrameEnd(displayBusLedger);
+      frameWorkUs = micros() - frameStart;
+      if (!injecting) updateQuality(frameWorkUs, pushTimeUs());
+
       frameCounter++;
       renderTimeAccum += renderTime;
+      upscaleTimeAccum += renderTimeUs();
+      foveaPixelAccum += foveaPixels();
       
       if (now - lastStatsTime >= STATS_INTERVAL_MS) {
         float avgRenderMs = renderTimeAccum / (float)frameCounter / MICRO_TO_MS;
         currentFPS = frameCounter * 1000.0f / (now - lastStatsTime);
         
-        Serial.printf("Mode: %s | FPS: %.1f | Render: %.2fms | Temp: %.1f-%.1fC\n", 
-                      currentMode == MODE_RGB ? "RGB" : "LIVE",
-                      currentFPS, avgRenderMs, tMin, tMax);
+        traceBegin(TRACE_LOG);
+        logWrite(currentMode == MODE_RGB ? LOG_STATS_RGB : LOG_STATS_LIVE, currentFPS, avgRenderMs, tMin, tMax);
+        if (FOVEATED_RENDER) {
+          int avgFovea = foveaPixelAccum / frameCounter;
+          logWrite(LOG_FOVEA, avgFovea, 100.0f * avgFovea / FbGeom::pixels,
+                   upscaleTimeAccum / (float)frameCounter / MICRO_TO_MS);
+        }
+        if (BUS_STATS_ENABLED) busReport(displayBusLedger);
+        traceEnd(TRACE_LOG);
         
         frameCounter = 0;
         renderTimeAccum = 0;
+        upscaleTimeAccum = 0;
+        foveaPixelAccum = 0;
         lastStatsTime = now;
       }
+
+      traceEnd(TRACE_FRAME);
+    }
+
+    if (injecting) {
+      if (injectFrameCount() != injectedFrames) reportInjectedFrame(frame, conditionUs, renderTime, frameWorkUs);
+      if (!injectActive()) finishInjection();
     }
   } 
 
@@ -0,0 +1,95 @@
+#include "sensor_backend.h"
+
+#if SENSOR_MODEL == SENSOR_MLX90641
+
+#include <MLX90641_I2C_Driver.h>
+#include "arena.h"
+#include "calib_cache.h"
+#include "mlx_wire.h"
+
+// ==========================================
+// MELEXIS I2C DRIVER
+// ==========================================
+
+static const uint8_t ADC_RESOLUTION_18BIT = 2;
+static const uint8_t REFRESH_RATE_16HZ = 5;
+
+void MLX90641_I2CInit() {
+}
+
+int MLX90641_I2CGeneralReset() {
+  return mlxWireGeneralReset();
+}
+
+int MLX90641_I2CRead(uint8_t slaveAddr, uint16_t startAddress, uint16_t nMemAddressRead, uint16_t *data) {
+  return mlxWireRead(slaveAddr, startAddress, nMemAddressRead, data);
+}
+
+int MLX90641_I2CWrite(uint8_t slaveAddr, uint16_t writeAddress, uint16_t data) {
+  return mlxWireWrite(slaveAddr, writeAddress, data);
+}
+
+void MLX90641_I2CFreqSet(int freq) {
+  mlxWireFreqSet(freq);
+}
+
+// ==========================================
+// BACKEND
+// ==========================================
+
+static int paramsClaimed = 0;
+
+bool Mlx90641Backend::begin(uint8_t addr, TwoWire *wire) {
+  address = mlxWireAddress(addr, wire);
+  if (!params) {
+    if (paramsClaimed >= SENSOR_COUNT) return false;
+    params = memBufferAs<paramsMLX90641>(BUF_SENSOR_PARAMS) + paramsClaimed++;
+  }
+
+  uint32_t start = millis();
+  uint16_t probe[CALIB_PROBE_WORDS];
+  if (MLX90641_I2CRead(address, MLX_EEPROM_ADDR, CALIB_PROBE_WORDS, probe) != 0) return false;
+
+  if (calibCacheLoad(probe, params, sizeof(*params))) {
+    Serial.printf("calibration: cached parameters in %lu ms\n", millis() - start);
+  } else {
+    uint16_t *eeData = memBufferAs<uint16_t>(BUF_CALIB_EEPROM);
+    if (MLX90641_DumpEE(address, eeData) != 0) return false;
+    if (MLX90641_ExtractParameters(eeData, params) != 0) return false;
+    calibCacheStore(eeData, params, sizeof(*params));
+    Serial.printf("calibration: extracted from EEPROM in %lu ms, cached\n", millis() - start);
+  }
+
+  MLX90641_SetResolution(address, ADC_RESOLUTION_18BIT);
+  MLX90641_SetRefreshRate(address, REFRESH_RATE_16HZ);
+  return true;
+}
+
+void Mlx90641Backend::setAcquisition(uint8_t refreshHz, uint8_t adcBits) {
+  MLX90641_SetResolution(address, adcBits - 16);
+  MLX90641_SetRefreshRate(address, mlxRefreshCode(refreshHz));
+}
+
+int Mlx90641Backend::getFrame(float *buf) {
+  uint16_t frameData[MLX41_FRAME_SIZE];
+
+  if (mlxWireWaitReady(address) != 0) return -1;
+  int status = MLX90641_GetFrameData(address, frameData);
+  if (status < 0) return status;
+
+  float ta = MLX90641_GetTa(frameData, params);
+  MLX90641_CalculateTo(frameData, params, MLX_EMISSIVITY, ta - MLX_TA_SHIFT, buf);
+  return 0;
+}
+
+int Mlx90641Backend::getSubpage(uint16_t *raw) {
+  if (mlxWireWaitReady(address) != 0) return -1;
+  return MLX90641_GetFrameData(address, raw);
+}
+
+void Mlx90641Backend::subpageTemps(uint16_t *raw, float *buf) {
+  float ta = MLX90641_GetTa(raw, params);
+  MLX90641_CalculateTo(raw, params, MLX_EMISSIVITY, ta - MLX_TA_SHIFT, buf);
+}
+
+#endif
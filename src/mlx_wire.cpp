@@ -0,0 +1,75 @@
+#include "mlx_wire.h"
+#include "main.h"
+
+static const uint16_t I2C_CHUNK_WORDS = 32;
+
+static TwoWire &wireOf(uint8_t slaveAddr) {
+  return (slaveAddr & MLX_WIRE_PORT1) ? Wire1 : Wire;
+}
+
+int mlxWireRead(uint8_t slaveAddr, uint16_t startAddress, uint16_t words, uint16_t *data) {
+  TwoWire &wire = wireOf(slaveAddr);
+  uint8_t addr7 = slaveAddr & ~MLX_WIRE_PORT1;
+  uint16_t addr = startAddress;
+  uint16_t remaining = words;
+
+  while (remaining > 0) {
+    uint16_t chunk = remaining > I2C_CHUNK_WORDS ? I2C_CHUNK_WORDS : remaining;
+
+    wire.beginTransmission(addr7);
+    wire.write(addr >> 8);
+    wire.write(addr & 0xFF);
+    if (wire.endTransmission(false) != 0) return -1;
+
+    if (wire.requestFrom(addr7, (size_t)(chunk * 2)) != (size_t)(chunk * 2)) return -1;
+    for (uint16_t i = 0; i < chunk; i++) {
+      uint8_t hi = wire.read();
+      uint8_t lo = wire.read();
+      *data++ = ((uint16_t)hi << 8) | lo;
+    }
+
+    addr += chunk;
+    remaining -= chunk;
+  }
+
+  return 0;
+}
+
+int mlxWireWrite(uint8_t slaveAddr, uint16_t writeAddress, uint16_t data) {
+  TwoWire &wire = wireOf(slaveAddr);
+  wire.beginTransmission(slaveAddr & ~MLX_WIRE_PORT1);
+  wire.write(writeAddress >> 8);
+  wire.write(writeAddress & 0xFF);
+  wire.write(data >> 8);
+  wire.write(data & 0xFF);
+  if (wire.endTransmission() != 0) return -1;
+
+  uint16_t check = 0;
+  if (mlxWireRead(slaveAddr, writeAddress, 1, &check) != 0) return -1;
+  return check == data ? 0 : -2;
+}
+
+// Status register and its "new data available" bit, common to both sensors
+static const uint16_t MLX_STATUS_REG = 0x8000;
+static const uint16_t MLX_STATUS_DATA_READY = 0x0008;
+
+int mlxWireWaitReady(uint8_t slaveAddr) {
+  uint32_t start = millis();
+  for (;;) {
+    uint16_t status;
+    if (mlxWireRead(slaveAddr, MLX_STATUS_REG, 1, &status) != 0) return -1;
+    if (status & MLX_STATUS_DATA_READY) return 0;
+    if (millis() - start > SENSOR_ERROR_WAIT) return -1;
+    delay(SENSOR_READY_POLL_MS);
+  }
+}
+
+int mlxWireGeneralReset() {
+  Wire.beginTransmission(0x00);
+  Wire.write(0x06);
+  return Wire.endTransmission() == 0 ? 0 : -1;
+}
+
+void mlxWireFreqSet(int freq) {
+  Wire.setClock((uint32_t)freq * 1000UL);
+}
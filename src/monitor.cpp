@@ -0,0 +1,139 @@
+#include "monitor.h"
+#include <math.h>
+#include <string.h>
+
+// Everything is per pixel and in place: one frame costs a fixed number of
+// integer operations per pixel no matter how long the run, and the only
+// memory is what initMonitor() was handed.
+
+using G = FrameGeom;
+
+static const int CELLS_X = G::width / MONITOR_SNAPSHOT_DECIMATE;
+static const int CELLS_Y = G::height / MONITOR_SNAPSHOT_DECIMATE;
+static_assert(CELLS_X * CELLS_Y == MONITOR_CELLS, "MONITOR_CELLS out of sync with the frame geometry");
+
+static inline int16_t toCenti(float t) {
+  if (t < -40.0f) t = -40.0f;
+  if (t > 300.0f) t = 300.0f;
+  return (int16_t)lrintf(t * MONITOR_TEMP_SCALE);
+}
+
+// Signed division rounded to nearest, so small updates do not drift towards zero
+static inline int32_t divRound(int64_t a, int32_t n) {
+  return (int32_t)((a >= 0 ? a + n / 2 : a - n / 2) / n);
+}
+
+void initMonitor(Monitor &m, void *stats, MonitorSnapshot *snapshots, int snapshotCapacity) {
+  int32_t *words = static_cast<int32_t *>(stats);
+  m.mean = words;
+  m.var = words + G::pixels;
+  m.exceed = words + 2 * G::pixels;
+  int16_t *halves = reinterpret_cast<int16_t *>(words + 3 * G::pixels);
+  m.minC = halves;
+  m.maxC = halves + G::pixels;
+  m.baselineC = halves + 2 * G::pixels;
+  m.snapshots = snapshots;
+  m.snapshotCapacity = snapshotCapacity;
+  monitorReset(m);
+}
+
+void monitorReset(Monitor &m) {
+  m.frames = 0;
+  m.startMs = 0;
+  m.lastSnapshotMs = 0;
+  m.snapshotHead = 0;
+  m.snapshotCount = 0;
+}
+
+static void takeSnapshot(Monitor &m, uint32_t nowMs) {
+  MonitorSnapshot &s = m.snapshots[m.snapshotHead];
+  s.timeMs = nowMs - m.startMs;
+  s.frames = m.frames;
+
+  const int d = MONITOR_SNAPSHOT_DECIMATE;
+  for (int cy = 0; cy < CELLS_Y; cy++) {
+    for (int cx = 0; cx < CELLS_X; cx++) {
+      int16_t hottest = INT16_MIN;
+      int64_t meanSum = 0;
+      for (int y = cy * d; y < cy * d + d; y++) {
+        for (int x = cx * d; x < cx * d + d; x++) {
+          int i = y * G::width + x;
+          if (m.maxC[i] > hottest) hottest = m.maxC[i];
+          meanSum += m.mean[i];
+        }
+      }
+      int32_t meanQ = divRound(meanSum, d * d);
+      s.maxC[cy * CELLS_X + cx] = hottest;
+      s.meanC[cy * CELLS_X + cx] = (int16_t)divRound((int64_t)meanQ * MONITOR_TEMP_SCALE, 1 << MONITOR_MEAN_SHIFT);
+    }
+  }
+
+  m.snapshotHead = (m.snapshotHead + 1) % m.snapshotCapacity;
+  if (m.snapshotCount < m.snapshotCapacity) m.snapshotCount++;
+  m.lastSnapshotMs = nowMs;
+}
+
+void monitorUpdate(Monitor &m, const float *frame, uint32_t nowMs) {
+  const int16_t alarmC = toCenti(MONITOR_ALARM_C);
+
+  if (m.frames == 0) {
+    for (int i = 0; i < G::pixels; i++) {
+      int16_t c = toCenti(frame[i]);
+      m.minC[i] = c;
+      m.maxC[i] = c;
+      m.baselineC[i] = c;
+      m.mean[i] = 0;
+      m.var[i] = 0;
+      m.exceed[i] = 0;
+    }
+    m.startMs = nowMs;
+    m.lastSnapshotMs = nowMs;
+  }
+
+  m.frames++;
+  const int32_t n = m.frames < MONITOR_STATS_WINDOW ? (int32_t)m.frames : MONITOR_STATS_WINDOW;
+
+  for (int i = 0; i < G::pixels; i++) {
+    float t = frame[i];
+    int16_t c = toCenti(t);
+    if (c < m.minC[i]) m.minC[i] = c;
+    if (c > m.maxC[i]) m.maxC[i] = c;
+    if (c >= alarmC) m.exceed[i]++;
+
+    // Welford, variance form: var += (delta * (x - mean') - var) / n
+    int32_t x = (int32_t)lrintf((float)c * ((1 << MONITOR_MEAN_SHIFT) / (float)MONITOR_TEMP_SCALE));
+    int32_t delta = x - m.mean[i];
+    m.mean[i] += divRound(delta, n);
+    int64_t spread = ((int64_t)delta * (x - m.mean[i])) >> (2 * MONITOR_MEAN_SHIFT - MONITOR_VAR_SHIFT);
+    m.var[i] += divRound(spread - m.var[i], n);
+  }
+
+  if (nowMs - m.lastSnapshotMs >= MONITOR_SNAPSHOT_MS) takeSnapshot(m, nowMs);
+}
+
+void monitorRenderView(const Monitor &m, MonitorView view, const float *live, float *out) {
+  const float scale = 1.0f / MONITOR_TEMP_SCALE;
+  if (m.frames == 0) {
+    memcpy(out, live, G::pixels * sizeof(float));
+    return;
+  }
+
+  if (view == MONITOR_VIEW_MAX_HOLD) {
+    for (int i = 0; i < G::pixels; i++) out[i] = m.maxC[i] * scale;
+  } else {
+    for (int i = 0; i < G::pixels; i++) out[i] = live[i] - m.baselineC[i] * scale;
+  }
+}
+
+const MonitorSnapshot &monitorSnapshot(const Monitor &m, int k) {
+  int oldest = (m.snapshotHead - m.snapshotCount + m.snapshotCapacity) % m.snapshotCapacity;
+  return m.snapshots[(oldest + k) % m.snapshotCapacity];
+}
+
+float monitorStdDev(const Monitor &m, int i) {
+  return m.var[i] > 0 ? sqrtf(m.var[i] / (float)(1 << MONITOR_VAR_SHIFT)) : 0.0f;
+}
+
+const char *monitorViewName(MonitorView view) {
+  return view == MONITOR_VIEW_MAX_HOLD ? "MAX HOLD" : "DELTA";
+}
@@ -0,0 +1,92 @@
+#include "palette.h"
+
+static inline uint16_t packRgb565(uint8_t r, uint8_t g, uint8_t b) {
+  return ((r & 0xF8) << 8) | ((g & 0xFC) << 3) | (b >> 3);
+}
+
+static uint16_t ironColor(float n) {
+  uint8_t r, g, b;
+  
+  if (n < 0.15f) {
+    float f = n / 0.15f;
+    r = (uint8_t)(50 * f);
+    g = 0;
+    b = (uint8_t)(80 + 175 * f);
+  }
+  else if (n < 0.30f) {
+    float f = (n - 0.15f) / 0.15f;
+    r = (uint8_t)(50 + 155 * f);
+    g = 0;
+    b = 255;
+  }
+  else if (n < 0.45f) {
+    float f = (n - 0.30f) / 0.15f;
+    r = 205 + (uint8_t)(50 * f);
+    g = 0;
+    b = (uint8_t)(255 * (1.0f - f));
+  }
+  else if (n < 0.60f) {
+    float f = (n - 0.45f) / 0.15f;
+    r = 255;
+    g = (uint8_t)(80 * f);
+    b = 0;
+  }
+  else if (n < 0.75f) {
+    float f = (n - 0.60f) / 0.15f;
+    r = 255;
+    g = (uint8_t)(80 + 175 * f);
+    b = 0;
+  }
+  else if (n < 0.90f) {
+    float f = (n - 0.75f) / 0.15f;
+    r = 255;
+    g = 255;
+    b = (uint8_t)(255 * f);
+  }
+  else {
+    r = 255;
+    g = 255;
+    b = 255;
+  }
+  
+  return packRgb565(r, g, b);
+}
+
+static uint16_t rainbowColor(float n) {
+  uint8_t r, g, b;
+
+  if (n < 0.25f) {
+    float f = n / 0.25f;
+    r = 0;
+    g = (uint8_t)(255 * f);
+    b = 255;
+  }
+  else if (n < 0.5f) {
+    float f = (n - 0.25f) / 0.25f;
+    r = 0;
+    g = 255;
+    b = (uint8_t)(255 * (1.0f - f));
+  }
+  else if (n < 0.75f) {
+    float f = (n - 0.5f) / 0.25f;
+    r = (uint8_t)(255 * f);
+    g = 255;
+    b = 0;
+  }
+  else {
+    float f = (n - 0.75f) / 0.25f;
+    r = 255;
+    g = (uint8_t)(255 * (1.0f - f));
+    b = 0;
+  }
+  
+  return packRgb565(r, g, b);
+}
+
+void buildPalette(PaletteId id, uint16_t *lut) {
+  for (int i = 0; i <= PALETTE_TOP_INDEX; i++) {
+    float n = (float)i / PALETTE_TOP_INDEX;
+    lut[i] = (id == PALETTE_RAINBOW) ? rainbowColor(n) : ironColor(n);
+  }
+  lut[PALETTE_OVERLAY_INDEX] = PALETTE_OVERLAY_COLOR;
+}
@@ -0,0 +1,66 @@
+#include "quality.h"
+
+// The smoothed reducible work is compared against the budget the smoothed
+// push leaves (qualityWorkBudgetMs) on every frame.
+// Going down is quick (QUALITY_DOWN_FRAMES over budget) because every slow
+// frame is visible; going up waits for a long run with QUALITY_HEADROOM to
+// spare, and the dwell after a switch keeps the previous level's times out
+// of the next decision.
+
+static const char *const levelNames[QUALITY_LEVEL_COUNT] = {
+  "full", "slow_ui", "no_edges", "bilinear", "nearest", "half_res"
+};
+
+const char *qualityLevelName(int level) {
+  return (level >= 0 && level < QUALITY_LEVEL_COUNT) ? levelNames[level] : "?";
+}
+
+void initQuality(QualityController &q, int level) {
+  q.level = level;
+  q.frameMs = 0.0f;
+  q.pushMs = 0.0f;
+  q.overFrames = 0;
+  q.underFrames = 0;
+  q.dwell = 0;
+  q.levelFrames = 0;
+  q.backoff = 0;
+  q.steppedUp = false;
+}
+
+QualityDecision qualityUpdate(QualityController &q, float frameMs, float pushMs) {
+  const bool first = q.frameMs == 0.0f && q.pushMs == 0.0f;
+  q.frameMs = first ? frameMs : q.frameMs + (frameMs - q.frameMs) * QUALITY_SMOOTH;
+  q.pushMs = first ? pushMs : q.pushMs + (pushMs - q.pushMs) * QUALITY_SMOOTH;
+  const float budget = qualityWorkBudgetMs(q.pushMs);
+  QualityDecision d = {false, q.level, q.level, q.frameMs, budget};
+
+  q.levelFrames++;
+  if (q.steppedUp && q.levelFrames == QUALITY_UP_FRAMES) q.backoff = 0;
+  if (q.dwell > 0) {
+    q.dwell--;
+    return d;
+  }
+
+  q.overFrames = q.frameMs > budget ? q.overFrames + 1 : 0;
+  q.underFrames = q.frameMs < budget * QUALITY_HEADROOM ? q.underFrames + 1 : 0;
+
+  int target = q.level;
+  if (q.overFrames >= QUALITY_DOWN_FRAMES && q.level < QUALITY_MAX_LEVEL) {
+    target = q.level + 1;
+    if (q.steppedUp && q.levelFrames < QUALITY_UP_FRAMES && q.backoff < QUALITY_MAX_BACKOFF) q.backoff++;
+  } else if (q.underFrames >= (QUALITY_UP_FRAMES << q.backoff) && q.level > QUALITY_FULL) {
+    target = q.level - 1;
+  }
+  if (target == q.level) return d;
+
+  q.steppedUp = target < q.level;
+  q.level = target;
+  q.overFrames = 0;
+  q.underFrames = 0;
+  q.levelFrames = 0;
+  q.dwell = QUALITY_MIN_DWELL;
+
+  d.changed = true;
+  d.to = target;
+  return d;
+}
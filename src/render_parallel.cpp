@@ -0,0 +1,88 @@
+#include "render_parallel.h"
+#include "arena.h"
+#include "render.h"
+#include "trace.h"
+
+// Output rows are split in two fixed halves: the calling core renders the
+// top half while the worker renders the bottom half. Each half computes its
+// own edge-mask rows and colour rows, so the only synchronisation is the
+// barrier before the framebuffer is pushed, and the result is bit-identical
+// to renderStrip(job, 0, FbGeom::height).
+
+static const int SPLIT_ROW = FbGeom::height / 2;
+static_assert(SPLIT_ROW % 2 == 0, "FILTER_NEAREST_HALF blocks must not straddle the split");
+
+// The worker shares a core with the sensor reads; it must never preempt
+// them, or subpages are missed and counted as link faults (i2c_health.h).
+// It runs while they sleep on the data-ready poll (mlxWireWaitReady)
+static_assert(RENDER_WORKER_CORE != SENSOR_TASK_CORE ||
+              (RENDER_WORKER_PRIORITY < ACQUIRE_TASK_PRIORITY && RENDER_WORKER_PRIORITY < SENSOR_TASK_PRIORITY),
+              "render worker must run below the acquisition tasks on their core");
+
+void renderStrip(const RenderJob &job, int yBegin, int yEnd) {
+  if (job.edgeMask) {
+    calculateEdgeMaskRows<FrameGeom, FbGeom>(job.buf, job.edgeMask, yBegin, yEnd, job.view, job.fovea);
+  }
+  float *rowCache = job.rowCache + (yBegin < SPLIT_ROW ? 0 : RENDER_CACHE_ROWS * FbGeom::width);
+  renderThermalRows<FrameGeom, FbGeom>(job.buf, job.tMin, job.tMax, job.lut,
+                                       job.edgeMask, job.out, yBegin, yEnd, rowCache, job.view, job.fovea,
+                                       job.filter);
+}
+
+#if defined(ARDUINO)
+
+#include <Arduino.h>
+
+static StaticTask_t workerTcb;
+static TaskHandle_t workerTask = nullptr;
+static TaskHandle_t callerTask = nullptr;
+static RenderJob pendingJob;
+
+static void renderWorker(void *param) {
+  for (;;) {
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    traceBegin(TRACE_RENDER_STRIP);
+    renderStrip(pendingJob, SPLIT_ROW, FbGeom::height);
+    traceEnd(TRACE_RENDER_STRIP);
+    xTaskNotifyGive(callerTask);
+  }
+}
+
+void initRenderWorkers() {
+  if (!PARALLEL_RENDER || workerTask) return;
+
+  workerTask = xTaskCreateStaticPinnedToCore(renderWorker, "renderWorker", RENDER_WORKER_STACK, nullptr,
+                                             RENDER_WORKER_PRIORITY, memBufferAs<StackType_t>(BUF_STACK_RENDER),
+                                             &workerTcb, RENDER_WORKER_CORE);
+  if (!workerTask) Serial.println("render worker start failed, rendering on one core");
+}
+
+void renderParallel(const RenderJob &job) {
+  if (!workerTask) {
+    renderStrip(job, 0, FbGeom::height);
+    return;
+  }
+
+  pendingJob = job;
+  callerTask = xTaskGetCurrentTaskHandle();
+  xTaskNotifyGive(workerTask);
+
+  renderStrip(job, 0, SPLIT_ROW);
+
+  ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+}
+
+#else
+
+#include <thread>
+
+void initRenderWorkers() {
+}
+
+void renderParallel(const RenderJob &job) {
+  std::thread worker(renderStrip, std::cref(job), SPLIT_ROW, (int)FbGeom::height);
+  renderStrip(job, 0, SPLIT_ROW);
+  worker.join();
+}
+
+#endif
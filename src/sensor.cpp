@@ -1,79 +1,77 @@
 #include "sensor.h"
+#include "acq_policy.h"
+#include "arena.h"
+#include "binlog.h"
+#include "condition.h"
+#include "i2c_health.h"
+#include "inject.h"
+#include "sensor_array.h"
+#include "trace.h"
 #include <Wire.h>
 
-Adafruit_MLX90640 mlx;
+SensorBackend mlx;
 static uint32_t lastFrameTime = 0;
 static uint32_t frameCount = 0;
 static float avgFPS = 0.0f;
 static bool frameReady = false;
 
-static float lastValidFrame[MLX_W * MLX_H];
-static bool lastValidFrameInitialized = false;
+static FrameConditioner conditioner;
+static AcqPolicy acqPolicy;
+static I2cHealth linkHealth;    // single sensor; the array keeps one per sensor
 
-#define TEMPORAL_FILTER_SIZE 3
-static float temporalBuffer[TEMPORAL_FILTER_SIZE][MLX_W * MLX_H];
-static int temporalBufferIndex = 0;
-static bool temporalBufferFilled = false;
-static float interpolateFromNeighbors(const float *buf, int x, int y) {
-  float sum = 0.0f;
-  int count = 0;
+static volatile SensorBootState bootState = SENSOR_BOOT_PENDING;
+static void updateLinkHealth(int status, int corrupt, uint32_t transferUs) {
+  if (!i2cHealthRecord(linkHealth, status, corrupt, transferUs)) return;
 
-  const int dx[] = {-1, 1, 0, 0};
-  const int dy[] = {0, 0, -1, 1};
-  
-  for (int i = 0; i < 4; i++) {
-    int nx = x + dx[i];
-    int ny = y + dy[i];
-
-    if (nx >= 0 && nx < MLX_W && ny >= 0 && ny < MLX_H) {
-      int idx = ny * MLX_W + nx;
-      float val = buf[idx];
-
-      if (!isnan(val) && val >= -40.0f && val <= 300.0f) {
-        sum += val;
-        count++;
-      }
-    }
-  }
-  
-  if (count > 0) {
-    return sum / count;
-  }
-  if (lastValidFrameInitialized) {
-    int idx = y * MLX_W + x;
-    return lastValidFrame[idx];
-  }
-  return 25.0f;
+  const I2cHealthStats &h = linkHealth.stats;
+  Wire.setClock(h.clockHz);
+  logWrite(LOG_I2C_CLOCK, h.clockHz, h.lastWindowErrors, h.avgTransferUs);
 }
 
-static inline float getMedian3(float a, float b, float c) {
-  if (a > b) {
-    if (b > c) return b;      // a > b > c
-    if (a > c) return c;      // a > c > b
-    return a;                 // c > a > b
-  } else {
-    if (a > c) return a;      // b > a > c
-    if (b > c) return c;      // b > c > a
-    return b;                 // c > b > a
-  }
+static void updateAcquisition(const float *buf) {
+  AcqDecision d = acqPolicyUpdate(acqPolicy, buf, millis());
+  if (!d.changed) return;
+
+  const AcqLevel &from = acqLevel(d.from);
+  const AcqLevel &to = acqLevel(d.to);
+  mlx.setAcquisition(to.refreshHz, to.adcBits);
+
+  float noiseAfter = acqPolicy.levelNoise[d.to];
+  logWrite(LOG_ACQ_SWITCH, from.refreshHz, from.adcBits, to.refreshHz, to.adcBits, 100.0f * d.motion);
+  logWrite(LOG_ACQ_COST, d.noiseBefore, noiseAfter, acqLevelLatencyMs(d.from), acqLevelLatencyMs(d.to));
+}
+
+static bool waitForSensorAck(uint32_t timeoutMs) {
+  uint32_t start = millis();
+  do {
+    Wire.beginTransmission(MLX90640_I2C_ADDR);
+    if (Wire.endTransmission() == 0) return true;
+    delay(1);
+  } while (millis() - start < timeoutMs);
+  return false;
 }
 
 bool initSensor() {
-  Wire.begin(I2C_SDA_PIN, I2C_SCL_PIN, I2C_FREQ_HZ);
-  delay(SENSOR_INIT_DELAY);
+  i2cHealthInit(linkHealth, I2C_FREQ_HZ);
+  Wire.begin(I2C_SDA_PIN, I2C_SCL_PIN, i2cHealthClock(linkHealth));
+  if (FAST_BOOT) {
+    waitForSensorAck(SENSOR_PROBE_TIMEOUT_MS);
+  } else {
+    delay(SENSOR_INIT_DELAY);
+  }
   
+#if SENSOR_COUNT > 1
+  if (!initSensorArray(i2cHealthClock(linkHealth))) return false;
+#else
   if (!mlx.begin(MLX90640_I2C_ADDR, &Wire)) {
     Serial.println("mlx not found");
     return false;
   }
-  
-  mlx.setMode(MLX90640_CHESS);           
-  mlx.setResolution(MLX90640_ADC_18BIT); 
-  mlx.setRefreshRate(MLX90640_16_HZ);      
-  delay(SENSOR_INIT_DELAY);
-  memset(temporalBuffer, 0, sizeof(temporalBuffer));
-  temporalBufferIndex = 0;
-  temporalBufferFilled = false;
+#endif
+  if (!FAST_BOOT) delay(SENSOR_INIT_DELAY);
+
+  initConditioner(conditioner, memBufferAs<float>(BUF_TEMPORAL), memBufferAs<float>(BUF_LAST_VALID));
+  if (ACQ_ADAPTIVE) initAcqPolicy(acqPolicy, memBufferAs<float>(BUF_ACQ_PREV), ACQ_DEFAULT_LEVEL);
   
   lastFrameTime = millis();
   frameReady = true;
@@ -84,62 +82,39 @@ bool initSensor() {
 bool readFrame(float *buf) {
   if (!buf) return false;
 
-  int status = mlx.getFrame(buf);
+  // Injected frames stand in for the sensor read, so they skip the link
+  // and acquisition policies that react to the real bus
+  bool injected = INJECT_ENABLED && injectActive();
+  int status;
+  int missingPixels = 0;
+  if (injected) {
+    status = injectReadFrame(buf);
+  } else {
+#if SENSOR_COUNT > 1
+    status = acquireStitchedFrame(buf, missingPixels);
+#else
+    uint32_t transferStart = micros();
+    status = mlx.getFrame(buf);
+    updateLinkHealth(status, status == 0 ? countInvalidPixels(buf) : 0, micros() - transferStart);
+#endif
+  }
+  if (status == 0) traceInstant(TRACE_SENSOR_READY);
   
   if (status != 0) {
-    Serial.printf("sensor read error (status: %d)\n", status);
+    logWrite(LOG_SENSOR_ERROR, status);
     frameReady = false;
     return false;
   }
   
-  memcpy(temporalBuffer[temporalBufferIndex], buf, MLX_W * MLX_H * sizeof(float));
-  temporalBufferIndex = (temporalBufferIndex + 1) % TEMPORAL_FILTER_SIZE;
-  
-  if (temporalBufferIndex == 0) {
-    temporalBufferFilled = true;
-  }
-  
-  if (temporalBufferFilled) {
-    for (int i = 0; i < MLX_W * MLX_H; i++) {
-      buf[i] = getMedian3(
-        temporalBuffer[0][i],
-        temporalBuffer[1][i],
-        temporalBuffer[2][i]
-      );
-    }
-  }
-  
-  int invalidCount = 0;
-  bool pixelFixed[MLX_W * MLX_H] = {false};
-
-  for (int i = 0; i < MLX_W * MLX_H; i++) {
-    if (isnan(buf[i]) || buf[i] < -40.0f || buf[i] > 300.0f) {
-      pixelFixed[i] = true;
-      invalidCount++;
-    }
-  }
-
-  if (invalidCount > (MLX_W * MLX_H / 4)) {
-    Serial.printf("frame rejected: %d/%d crptd pixels (%.1f%%)\n", 
-                  invalidCount, MLX_W * MLX_H, 
-                  100.0f * invalidCount / (MLX_W * MLX_H));
+  int invalidCount;
+  if (!conditionRawFrame(conditioner, buf, buf, invalidCount, missingPixels)) {
+    logWrite(LOG_FRAME_REJECT, invalidCount, FrameGeom::pixels, 100.0f * invalidCount / (FrameGeom::pixels));
     frameReady = false;
     return false;
   }
-  
-  if (invalidCount > 0) {
-    for (int y = 0; y < MLX_H; y++) {
-      for (int x = 0; x < MLX_W; x++) {
-        int idx = y * MLX_W + x;
-        if (pixelFixed[idx]) {
-          buf[idx] = interpolateFromNeighbors(buf, x, y);
-        }
-      }
-    }
-  }
 
-  memcpy(lastValidFrame, buf, MLX_W * MLX_H * sizeof(float));
-  lastValidFrameInitialized = true;
+  if (ACQ_ADAPTIVE && SENSOR_COUNT == 1 && !injected) updateAcquisition(buf);
+
   uint32_t now = millis();
   uint32_t delta = now - lastFrameTime;
   lastFrameTime = now;
@@ -158,4 +133,75 @@ bool readFrame(float *buf) {
 
 bool isFrameReady() {
   return frameReady;
-}
\ No newline at end of file
+}
+
+void resetConditioning() {
+  initConditioner(conditioner, memBufferAs<float>(BUF_TEMPORAL), memBufferAs<float>(BUF_LAST_VALID));
+}
+
+// ==========================================
+// BURST CAPTURE (raw subpages, decoded on demand)
+// ==========================================
+
+static_assert(!BURST_ENABLED || SENSOR_COUNT == 1, "burst capture reads a single sensor");
+
+bool beginBurstAcquisition() {
+  if (!mlx.beginRaw()) return false;
+  mlx.setAcquisition(BURST_REFRESH_HZ, BURST_ADC_BITS);
+  return true;
+}
+
+// Back to whatever the acquisition policy last chose
+void endBurstAcquisition() {
+  const AcqLevel &level = acqLevel(ACQ_ADAPTIVE ? acqPolicy.level : ACQ_DEFAULT_LEVEL);
+  mlx.setAcquisition(level.refreshHz, level.adcBits);
+}
+
+int readSubpage(uint16_t *raw) {
+  uint32_t transferStart = micros();
+  int status = mlx.getSubpage(raw);
+  updateLinkHealth(status < 0 ? status : 0, 0, micros() - transferStart);
+  return status;
+}
+
+void decodeSubpage(uint16_t *raw, float *buf) {
+  mlx.subpageTemps(raw, buf);
+}
+
+// ==========================================
+// FAST BOOT (sensor init + temporal prefill off the UI core)
+// ==========================================
+
+static void sensorBootTask(void *param) {
+  float *primeBuf = (float*)param;
+  uint32_t start = millis();
+
+  if (!initSensor()) {
+    bootState = SENSOR_BOOT_FAILED;
+    vTaskDelete(NULL);
+    return;
+  }
+
+  int primed = 0;
+  while (primed < TEMPORAL_FILTER_SIZE && millis() - start < SENSOR_BOOT_TIMEOUT_MS) {
+    if (readFrame(primeBuf)) primed++;
+  }
+
+  Serial.printf("sensor boot: ready in %lu ms (%d frames primed)\n", millis() - start, primed);
+  bootState = SENSOR_BOOT_READY;
+  vTaskDelete(NULL);
+}
+
+void beginSensorAsync(float *primeBuf) {
+  static StaticTask_t bootTcb;
+  bootState = SENSOR_BOOT_PENDING;
+  if (!xTaskCreateStaticPinnedToCore(sensorBootTask, "sensorBoot", SENSOR_BOOT_STACK, primeBuf, 1,
+                                     memBufferAs<StackType_t>(BUF_STACK_SENSOR_BOOT), &bootTcb,
+                                     SENSOR_BOOT_CORE)) {
+    bootState = initSensor() ? SENSOR_BOOT_READY : SENSOR_BOOT_FAILED;
+  }
+}
+
+SensorBootState sensorBootState() {
+  return bootState;
+}
@@ -0,0 +1,129 @@
+#include "sensor_array.h"
+#include "arena.h"
+#include "binlog.h"
+#include "condition.h"
+#include "frame_sync.h"
+#include "i2c_health.h"
+#include "sensor_backend.h"
+#include <Wire.h>
+#include <freertos/semphr.h>
+
+#if SENSOR_COUNT > 1
+
+static_assert(SENSOR_COUNT <= FRAME_SYNC_MAX_SENSORS, "too many sensors for FrameSync");
+
+// One acquisition task per I2C controller reads its sensors and publishes
+// them to the FrameSync under slotLock; the consumer takes a synchronised
+// set and stitches it (see frame_sync.h).
+
+static const int ACQUIRE_TIMEOUT_STATUS = -100;
+
+static const uint8_t sensorPorts[SENSOR_COUNT] = SENSOR_I2C_PORTS;
+static const uint8_t sensorAddrs[SENSOR_COUNT] = SENSOR_I2C_ADDRS;
+static SensorBackend arrayMlx[SENSOR_COUNT];
+static FrameSync sync;
+static portMUX_TYPE slotLock = portMUX_INITIALIZER_UNLOCKED;
+static SemaphoreHandle_t frameSignal = nullptr;
+static StaticTask_t acquisitionTcb[2];
+static I2cHealth health[SENSOR_COUNT];    // written by the sensor's port task only
+
+static TwoWire *portWire(uint8_t port) {
+  return port == 0 ? &Wire : &Wire1;
+}
+
+static int readSensor(int sensor, float *frame, void *ctx) {
+  return arrayMlx[sensor].getFrame(frame);
+}
+
+// A failed read's NaN frame is not counted as corrupt; its status is
+static void updateSensorHealth(int sensor, int status, uint32_t transferUs) {
+  int corrupt = status == 0 ? countInvalidPixels(sync.slots[sensor].back, SensorGeom::pixels) : 0;
+  if (!i2cHealthRecord(health[sensor], status, corrupt, transferUs)) return;
+
+  const uint8_t port = sensorPorts[sensor];
+  uint32_t clockHz = i2cHealthClock(health[sensor]);
+  for (int s = 0; s < SENSOR_COUNT; s++) {
+    if (sensorPorts[s] == port && i2cHealthClock(health[s]) < clockHz) clockHz = i2cHealthClock(health[s]);
+  }
+  portWire(port)->setClock(clockHz);
+
+  const I2cHealthStats &h = health[sensor].stats;
+  logWrite(LOG_I2C_SENSOR, sensor, port, h.clockHz, h.lastWindowErrors, h.avgTransferUs);
+}
+
+static void acquisitionTask(void *param) {
+  uint8_t port = (uint8_t)(uintptr_t)param;
+
+  for (;;) {
+    for (int s = 0; s < SENSOR_COUNT; s++) {
+      if (sensorPorts[s] != port) continue;
+
+      uint32_t transferStart = micros();
+      int status = frameSyncRead(sync, s, readSensor, nullptr);
+      uint32_t now = micros();
+      updateSensorHealth(s, status, now - transferStart);
+
+      portENTER_CRITICAL(&slotLock);
+      frameSyncPublish(sync, s, status, now);
+      portEXIT_CRITICAL(&slotLock);
+
+      xSemaphoreGive(frameSignal);
+    }
+  }
+}
+
+bool initSensorArray(uint32_t clockHz) {
+  Wire1.begin(I2C1_SDA_PIN, I2C1_SCL_PIN, clockHz);
+
+  for (int s = 0; s < SENSOR_COUNT; s++) {
+    i2cHealthInit(health[s], clockHz);
+    if (!arrayMlx[s].begin(sensorAddrs[s], portWire(sensorPorts[s]))) {
+      Serial.printf("mlx %d not found (port %d, addr 0x%02X)\n", s, sensorPorts[s], sensorAddrs[s]);
+      return false;
+    }
+  }
+  initFrameSync(sync, SENSOR_COUNT, memBufferAs<float>(BUF_SENSOR_SLOTS), micros());
+
+  frameSignal = xSemaphoreCreateBinary();
+
+  for (uint8_t port = 0; port < 2; port++) {
+    bool used = false;
+    for (int s = 0; s < SENSOR_COUNT; s++) used |= (sensorPorts[s] == port);
+    if (!used) continue;
+
+    StackType_t *stack = memBufferAs<StackType_t>(BUF_STACK_SENSORS) + port * SENSOR_TASK_STACK;
+    xTaskCreateStaticPinnedToCore(acquisitionTask, port == 0 ? "sensorAcq0" : "sensorAcq1",
+                                  SENSOR_TASK_STACK, (void*)(uintptr_t)port, SENSOR_TASK_PRIORITY, stack,
+                                  &acquisitionTcb[port], SENSOR_TASK_CORE);
+  }
+
+  Serial.printf("sensor array: %d sensors, stitched %dx%d\n", SENSOR_COUNT, FRAME_W, FRAME_H);
+  return true;
+}
+
+int acquireStitchedFrame(float *buf, int &missingPixels) {
+  uint32_t waitStart = millis();
+  int status = 0;
+  missingPixels = 0;
+
+  for (;;) {
+    portENTER_CRITICAL(&slotLock);
+    bool ready = frameSyncTake(sync, micros(), status);
+    portEXIT_CRITICAL(&slotLock);
+
+    if (ready) break;
+    if (millis() - waitStart > SENSOR_ERROR_WAIT) return ACQUIRE_TIMEOUT_STATUS;
+    xSemaphoreTake(frameSignal, pdMS_TO_TICKS(SENSOR_ERROR_WAIT));
+  }
+
+  frameSyncStitch(sync, buf);
+  missingPixels = frameSyncMissingPixels(sync);
+  return status;
+}
+
+#else
+
+bool initSensorArray(uint32_t clockHz) { return false; }
+int acquireStitchedFrame(float *buf, int &missingPixels) { return -1; }
+
+#endif
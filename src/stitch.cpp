@@ -0,0 +1,54 @@
+#include "stitch.h"
+#include <math.h>
+#include <string.h>
+
+// Sensors sit side by side, each sharing STITCH_OVERLAP columns with its left
+// neighbour. Overlap columns are feathered linearly from the left sensor to
+// the right one; a NaN on either side takes the other sensor's value.
+
+void stitchFrames(const float *const *frames, int count, float *out) {
+  const int step = SensorGeom::width - STITCH_OVERLAP;
+  const int outW = count * SensorGeom::width - (count - 1) * STITCH_OVERLAP;
+
+  float weights[STITCH_OVERLAP > 0 ? STITCH_OVERLAP : 1];
+  for (int j = 0; j < STITCH_OVERLAP; j++) {
+    weights[j] = (float)(j + 1) / (STITCH_OVERLAP + 1);
+  }
+
+  for (int y = 0; y < SensorGeom::height; y++) {
+    float *dst = &out[y * outW];
+
+    for (int s = 0; s < count; s++) {
+      const float *src = &frames[s][y * SensorGeom::width];
+      float *col = &dst[s * step];
+      int start = 0;
+
+      if (s > 0) {
+        for (int j = 0; j < STITCH_OVERLAP; j++) {
+          float a = col[j];
+          float b = src[j];
+          if (isnan(a)) col[j] = b;
+          else if (!isnan(b)) col[j] = a + (b - a) * weights[j];
+        }
+        start = STITCH_OVERLAP;
+      }
+
+      memcpy(&col[start], &src[start], (SensorGeom::width - start) * sizeof(float));
+    }
+  }
+}
+
+int stitchUncoveredPixels(const bool *delivered, int count) {
+  const int step = SensorGeom::width - STITCH_OVERLAP;
+  const int outW = count * SensorGeom::width - (count - 1) * STITCH_OVERLAP;
+
+  int columns = 0;
+  for (int x = 0; x < outW; x++) {
+    bool covered = false;
+    for (int s = 0; s < count && !covered; s++) {
+      covered = delivered[s] && x >= s * step && x < s * step + SensorGeom::width;
+    }
+    if (!covered) columns++;
+  }
+  return columns * SensorGeom::height;
+}
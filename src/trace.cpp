@@ -0,0 +1,67 @@
+#include "trace.h"
+#include "arena.h"
+#include <Arduino.h>
+
+// One ring per core. Writers reserve a slot with an atomic increment of the
+// core's head, so a task and an ISR preempting it on the same core never
+// share a slot and nothing ever blocks. Old events are overwritten.
+
+static const char *eventNames[TRACE_EVENT_COUNT] = {
+#define TRACE_EVENT_NAME(id, name) name,
+  TRACE_EVENTS(TRACE_EVENT_NAME)
+#undef TRACE_EVENT_NAME
+};
+
+static TraceRecord *traceRing = nullptr;
+static uint32_t traceHead[TRACE_CORES];
+static volatile bool tracePaused = false;
+
+void initTrace() {
+  if (!TRACE_ENABLED) return;
+  traceRing = memBufferAs<TraceRecord>(BUF_TRACE_RING);
+  for (int c = 0; c < TRACE_CORES; c++) traceHead[c] = 0;
+}
+
+void IRAM_ATTR traceRecord(TracePhase phase, TraceEvent event, uint16_t arg) {
+  if (!traceRing || tracePaused) return;
+
+  uint32_t core = xPortGetCoreID();
+  uint32_t slot = __atomic_fetch_add(&traceHead[core], 1, __ATOMIC_RELAXED);
+
+  TraceRecord &rec = traceRing[core * TRACE_RING_SIZE + (slot & (TRACE_RING_SIZE - 1))];
+  rec.timestampUs = micros();
+  rec.phase = phase;
+  rec.event = event;
+  rec.arg = arg;
+}
+
+// ==========================================
+// BINARY DUMP
+// ==========================================
+
+// "TRC1" | u16 cores | u16 ringSize | u16 eventCount | names (u8 len + chars)
+// | per core: u32 head + ringSize records | "TEND"   (little endian)
+void traceDump() {
+  if (!traceRing) return;
+  tracePaused = true;
+
+  uint16_t header[3] = {TRACE_CORES, TRACE_RING_SIZE, TRACE_EVENT_COUNT};
+  Serial.write((const uint8_t*)"TRC1", 4);
+  Serial.write((const uint8_t*)header, sizeof(header));
+
+  for (int i = 0; i < TRACE_EVENT_COUNT; i++) {
+    uint8_t len = strlen(eventNames[i]);
+    Serial.write(len);
+    Serial.write((const uint8_t*)eventNames[i], len);
+  }
+
+  for (int c = 0; c < TRACE_CORES; c++) {
+    uint32_t head = __atomic_load_n(&traceHead[c], __ATOMIC_RELAXED);
+    Serial.write((const uint8_t*)&head, sizeof(head));
+    Serial.write((const uint8_t*)&traceRing[c * TRACE_RING_SIZE], TRACE_RING_SIZE * sizeof(TraceRecord));
+  }
+
+  Serial.write((const uint8_t*)"TEND", 4);
+  Serial.flush();
+  tracePaused = false;
+}
@@ -0,0 +1,57 @@
+#include "view.h"
+
+using G = FrameGeom;
+
+static ViewWindow view = FULL_VIEW;
+
+// Pan positions are a raster of windows overlapping by half their span
+static int panStep(int src, int zoom) {
+  int step = (src - 1) / zoom / 2;
+  return step > 0 ? step : 1;
+}
+
+static uint8_t clampOrigin(int origin, int src, int zoom) {
+  int maxOrigin = viewMaxOrigin(src, zoom);
+  if (origin > maxOrigin) origin = maxOrigin;
+  if (origin < 0) origin = 0;
+  return (uint8_t)origin;
+}
+
+const ViewWindow &currentView() {
+  return view;
+}
+
+int currentZoom() {
+  return ZOOM_FACTORS[view.level];
+}
+
+// Next zoom level (wrapping to 1x), keeping the window centre in place
+void viewCycleZoom() {
+  const int oldZoom = ZOOM_FACTORS[view.level];
+  const int level = (view.level + 1) % ZOOM_LEVEL_COUNT;
+  const int zoom = ZOOM_FACTORS[level];
+
+  // Centre in half sensor pixels: origin + span / 2
+  const int cx2 = 2 * view.originX + (G::width - 1) / oldZoom;
+  const int cy2 = 2 * view.originY + (G::height - 1) / oldZoom;
+
+  view.level = (uint8_t)level;
+  view.originX = clampOrigin((cx2 - (G::width - 1) / zoom) / 2, G::width, zoom);
+  view.originY = clampOrigin((cy2 - (G::height - 1) / zoom) / 2, G::height, zoom);
+}
+
+// Left to right, then top to bottom, wrapping to the top-left window
+void viewPanNext() {
+  const int zoom = ZOOM_FACTORS[view.level];
+  if (zoom == 1) return;
+
+  const int maxX = viewMaxOrigin(G::width, zoom);
+  const int maxY = viewMaxOrigin(G::height, zoom);
+
+  if (view.originX < maxX) {
+    view.originX = clampOrigin(view.originX + panStep(G::width, zoom), G::width, zoom);
+    return;
+  }
+  view.originX = 0;
+  view.originY = view.originY < maxY ? clampOrigin(view.originY + panStep(G::height, zoom), G::height, zoom) : 0;
+}
@@ -0,0 +1,183 @@
+// Acquisition policy replaying a scripted scene: frames are captured at the
+// period of whatever level the policy last chose, as on the device, and the
+// test checks the refresh rate / ADC resolution switches it makes. Motion is
+// judged in C per second, so a slow drift at 4 Hz is steady and a pan stays
+// fast at 32 Hz even though each frame changes less.
+
+#include <unity.h>
+#include <math.h>
+#include <vector>
+#include "acq_policy.h"
+
+using G = FrameGeom;
+
+enum SceneKind { SCENE_STILL, SCENE_DRIFT, SCENE_PAN };
+
+// rate: C/s every pixel changes at (uniform drift, or a triangle gradient
+// panned across the array)
+struct Segment {
+  SceneKind kind;
+  uint32_t durationMs;
+  float rate;
+};
+
+struct Switch {
+  uint32_t timeMs;
+  int segment;
+  int from;
+  int to;
+};
+
+static std::vector<float> prevFrame(G::pixels);
+static std::vector<float> frame(G::pixels);
+static uint32_t seed;
+
+// Sensor noise, +-0.05 C
+static float noise() {
+  seed = seed * 1664525u + 1013904223u;
+  return ((seed >> 8) % 1001) * 0.0001f - 0.05f;
+}
+
+static float triangle(float x) {
+  float m = fmodf(x, 2.0f * G::width);
+  if (m < 0.0f) m += 2.0f * G::width;
+  return m < G::width ? m : 2.0f * G::width - m;
+}
+
+static void capture(SceneKind kind, float rate, float sceneSeconds, float drift = 0.0f) {
+  for (int y = 0; y < G::height; y++) {
+    for (int x = 0; x < G::width; x++) {
+      float t = 25.0f + 0.1f * y;
+      if (kind == SCENE_PAN) t += triangle(x - rate * sceneSeconds);   // 1 C per pixel, rate px/s
+      frame[y * G::width + x] = t + drift + noise();
+    }
+  }
+}
+
+// Replays the script, advancing time by the full-frame period of the level
+// in effect; returns every switch with the segment it happened in.
+static std::vector<Switch> replay(const Segment *script, int count, AcqPolicy &p) {
+  std::vector<Switch> switches;
+  seed = 1;
+  uint32_t now = 0;
+  float drift = 0.0f;
+  for (int s = 0; s < count; s++) {
+    const uint32_t end = now + script[s].durationMs;
+    const uint32_t start = now;
+    while (now < end) {
+      capture(script[s].kind, script[s].rate, (now - start) * 0.001f, drift);
+      AcqDecision d = acqPolicyUpdate(p, frame.data(), now);
+      if (d.changed) switches.push_back({now, s, d.from, d.to});
+
+      const uint32_t period = (uint32_t)acqLevelLatencyMs(p.level);
+      if (script[s].kind == SCENE_DRIFT) drift += script[s].rate * period * 0.001f;
+      now += period;
+    }
+  }
+  return switches;
+}
+
+void setUp() {
+}
+
+void tearDown() {
+}
+
+// Still scene: one level slower per ACQ_STEADY_FRAMES measured frames down to
+// the slowest; a pan jumps to the fastest and holds there; once still again
+// it walks back down
+void test_replay_switches_rate_and_resolution() {
+  const Segment script[] = {
+    {SCENE_STILL, 20000, 0.0f},
+    {SCENE_PAN, 4000, 12.0f},      // 0.75 C per frame at 32 Hz
+    {SCENE_STILL, 30000, 0.0f},
+  };
+  AcqPolicy p;
+  initAcqPolicy(p, prevFrame.data(), ACQ_DEFAULT_LEVEL);
+  std::vector<Switch> sw = replay(script, 3, p);
+
+  const int expected[][3] = {
+    // segment, from, to
+    {0, ACQ_DEFAULT_LEVEL, ACQ_DEFAULT_LEVEL - 1},
+    {0, ACQ_DEFAULT_LEVEL - 1, 0},
+    {1, 0, ACQ_LEVEL_COUNT - 1},
+    {2, ACQ_LEVEL_COUNT - 1, ACQ_LEVEL_COUNT - 2},
+    {2, ACQ_LEVEL_COUNT - 2, ACQ_LEVEL_COUNT - 3},
+    {2, ACQ_LEVEL_COUNT - 3, 0},
+  };
+  const int n = sizeof(expected) / sizeof(expected[0]);
+  TEST_ASSERT_EQUAL_INT(n, (int)sw.size());
+  for (int k = 0; k < n; k++) {
+    TEST_ASSERT_EQUAL_INT(expected[k][0], sw[k].segment);
+    TEST_ASSERT_EQUAL_INT(expected[k][1], sw[k].from);
+    TEST_ASSERT_EQUAL_INT(expected[k][2], sw[k].to);
+  }
+
+  // First step down: dwell, one frame to fill prevFrame, then the steady run
+  const uint32_t defaultPeriod = (uint32_t)acqLevelLatencyMs(ACQ_DEFAULT_LEVEL);
+  TEST_ASSERT_EQUAL_UINT32((ACQ_MIN_DWELL + ACQ_STEADY_FRAMES - 1) * defaultPeriod, sw[0].timeMs);
+
+  // The pan is caught within a few frames of the slowest level
+  TEST_ASSERT_TRUE(sw[2].timeMs - 20000 <= 3 * (uint32_t)acqLevelLatencyMs(0));
+
+  // Slower is finer: each switch trades rate against ADC resolution
+  for (const Switch &s : sw) {
+    const AcqLevel &from = acqLevel(s.from);
+    const AcqLevel &to = acqLevel(s.to);
+    TEST_ASSERT_TRUE(to.refreshHz < from.refreshHz ? to.adcBits >= from.adcBits : to.adcBits <= from.adcBits);
+  }
+  TEST_ASSERT_EQUAL_INT(0, p.level);
+  TEST_ASSERT_EQUAL_UINT8(4, acqLevel(p.level).refreshHz);
+  TEST_ASSERT_EQUAL_UINT8(19, acqLevel(p.level).adcBits);
+}
+
+// A uniform drift of 3 C/s is 1.5 C per frame at 4 Hz, well above the
+// per-frame noise, but slower than ACQ_MOTION_RATE: the policy stays slow
+void test_slow_drift_at_slow_rate_is_steady() {
+  const Segment script[] = {
+    {SCENE_STILL, 20000, 0.0f},
+    {SCENE_DRIFT, 20000, ACQ_MOTION_RATE * 0.375f},
+  };
+  AcqPolicy p;
+  initAcqPolicy(p, prevFrame.data(), ACQ_DEFAULT_LEVEL);
+  std::vector<Switch> sw = replay(script, 2, p);
+
+  TEST_ASSERT_EQUAL_INT(0, p.level);
+  for (const Switch &s : sw) TEST_ASSERT_EQUAL_INT(0, s.segment);
+  TEST_ASSERT_TRUE(p.motion < ACQ_MOTION_LOW);
+}
+
+// The same pan measures the same motion whether frames come at 4 Hz or
+// 32 Hz, and a gap from dropped frames does not turn it into motion
+void test_motion_is_per_second() {
+  AcqPolicy p;
+  for (int level : {0, ACQ_LEVEL_COUNT - 1}) {
+    initAcqPolicy(p, prevFrame.data(), level);
+    p.dwell = 0;
+    const uint32_t period = (uint32_t)acqLevelLatencyMs(level);
+    for (int f = 0; f < 8; f++) {
+      capture(SCENE_PAN, 12.0f, f * period * 0.001f);
+      acqPolicyUpdate(p, frame.data(), f * period);
+    }
+    TEST_ASSERT_TRUE(p.motion > ACQ_MOTION_HIGH);
+  }
+
+  // Slow pan (4 C/s), one frame then four periods missing at 32 Hz
+  initAcqPolicy(p, prevFrame.data(), ACQ_LEVEL_COUNT - 1);
+  p.dwell = 0;
+  const uint32_t period = (uint32_t)acqLevelLatencyMs(ACQ_LEVEL_COUNT - 1);
+  for (int f = 0; f < 8; f++) {
+    const uint32_t t = f * 5 * period;
+    capture(SCENE_PAN, 4.0f, t * 0.001f);
+    acqPolicyUpdate(p, frame.data(), t);
+  }
+  TEST_ASSERT_TRUE(p.motion < ACQ_MOTION_LOW);
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_replay_switches_rate_and_resolution);
+  RUN_TEST(test_slow_drift_at_slow_rate_is_steady);
+  RUN_TEST(test_motion_is_per_second);
+  return UNITY_END();
+}
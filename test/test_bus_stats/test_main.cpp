@@ -0,0 +1,159 @@
+// Display bus accounting: per-site attribution and the per-frame byte
+// budget, with the indexed framebuffer push replayed on the recording bus.
+
+#include <unity.h>
+#include <vector>
+#include "arena.h"
+#include "bus_stats.h"
+#include "host/recording_bus.h"
+#include "palette.h"
+#include "panel_push.h"
+
+// CASET + 4 data bytes, RASET + 4 data bytes, RAMWR
+static const uint32_t ADDR_WINDOW_BYTES = 11;
+static const uint32_t PUSH_BYTES = ADDR_WINDOW_BYTES + FB_WIDTH * FB_HEIGHT * PANEL_PIXEL_BYTES;
+
+static BusLedger ledger;
+
+// pushFrameBuffer() as display.cpp sends it in indexed mode
+static void pushFrame(RecordingBus &bus, const uint8_t *fb) {
+  static uint16_t lut[COLOR_LUT_SIZE];
+  static uint8_t palette[COLOR_LUT_SIZE][PANEL_PIXEL_BYTES];
+  static std::vector<uint8_t> lines(FB_PUSH_ROWS * FB_WIDTH * PANEL_PIXEL_BYTES);
+  buildPalette(PALETTE_IRON, lut);
+  for (int i = 0; i < COLOR_LUT_SIZE; i++) expandPanelColor(lut[i], palette[i]);
+
+  ledger.site = BUS_SITE_FRAME;
+  bus.beginWrite();
+  bus.writeAddrWindow(FB_X_OFFSET, FB_Y_OFFSET, FB_WIDTH, FB_HEIGHT);
+  streamIndexedRows(bus, fb, palette, lines.data());
+  bus.endWrite();
+  ledger.site = BUS_SITE_OTHER;
+}
+
+// A marker: two short lines, each its own window and transaction
+static void drawMarker(RecordingBus &bus) {
+  ledger.site = BUS_SITE_MARKERS;
+  for (int i = 0; i < 2; i++) {
+    bus.beginWrite();
+    bus.writeAddrWindow(100 + i, 50, 1, 12);
+    uint8_t px[12 * PANEL_PIXEL_BYTES] = {};
+    bus.writeBytes(px, sizeof(px));
+    bus.endWrite();
+  }
+  ledger.site = BUS_SITE_OTHER;
+}
+
+void setUp() {
+  initBusLedger(ledger);
+}
+
+void tearDown() {
+}
+
+void test_push_is_attributed_to_frame_site() {
+  std::vector<uint8_t> fb(FB_WIDTH * FB_HEIGHT, 0x80);
+  RecordingBus bus(ledger);
+  pushFrame(bus, fb.data());
+  TEST_ASSERT_TRUE(busFrameEnd(ledger, 0));
+
+  const BusCounters &frame = ledger.lastFrame[BUS_SITE_FRAME];
+  TEST_ASSERT_EQUAL_UINT32(PUSH_BYTES, frame.bytes);
+  TEST_ASSERT_EQUAL_UINT32(1, frame.transactions);
+  TEST_ASSERT_EQUAL_UINT32(2, frame.windowChanges);
+  TEST_ASSERT_EQUAL_UINT32(2, frame.csToggles);
+  TEST_ASSERT_EQUAL_UINT32(0, ledger.lastFrame[BUS_SITE_OTHER].bytes);
+
+  // One writeBytes per FB_PUSH_ROWS rows
+  int dataWrites = 0;
+  for (const BusTransfer &t : bus.log) dataWrites += t.kind == BUS_XFER_DATA && t.bytes > 4;
+  TEST_ASSERT_EQUAL((FB_HEIGHT + FB_PUSH_ROWS - 1) / FB_PUSH_ROWS, dataWrites);
+}
+
+void test_sites_and_frames_are_separate() {
+  std::vector<uint8_t> fb(FB_WIDTH * FB_HEIGHT, 3);
+  RecordingBus bus(ledger);
+  pushFrame(bus, fb.data());
+  drawMarker(bus);
+  busFrameEnd(ledger, 0);
+
+  TEST_ASSERT_EQUAL_UINT32(2 * (ADDR_WINDOW_BYTES + 12 * PANEL_PIXEL_BYTES), ledger.lastFrame[BUS_SITE_MARKERS].bytes);
+  TEST_ASSERT_EQUAL_UINT32(2, ledger.lastFrame[BUS_SITE_MARKERS].transactions);
+  TEST_ASSERT_EQUAL_UINT32(4, ledger.lastFrame[BUS_SITE_MARKERS].windowChanges);
+
+  BusCounters total = busLastFrameTotal(ledger);
+  TEST_ASSERT_EQUAL_UINT32(PUSH_BYTES + 2 * (ADDR_WINDOW_BYTES + 12 * PANEL_PIXEL_BYTES), total.bytes);
+  TEST_ASSERT_EQUAL_UINT32(3, total.transactions);
+
+  // The next frame starts from zero
+  drawMarker(bus);
+  busFrameEnd(ledger, 0);
+  TEST_ASSERT_EQUAL_UINT32(0, ledger.lastFrame[BUS_SITE_FRAME].bytes);
+  TEST_ASSERT_EQUAL_UINT32(2, ledger.frames);
+  TEST_ASSERT_EQUAL_UINT32(PUSH_BYTES + 2 * (ADDR_WINDOW_BYTES + 12 * PANEL_PIXEL_BYTES), ledger.worstFrameBytes);
+}
+
+void test_byte_budget() {
+  std::vector<uint8_t> fb(FB_WIDTH * FB_HEIGHT, 200);
+  RecordingBus bus(ledger);
+
+  pushFrame(bus, fb.data());
+  TEST_ASSERT_FALSE(busFrameEnd(ledger, PUSH_BYTES - 1));
+  TEST_ASSERT_EQUAL_UINT32(1, ledger.framesOverBudget);
+
+  pushFrame(bus, fb.data());
+  TEST_ASSERT_TRUE(busFrameEnd(ledger, PUSH_BYTES));
+  TEST_ASSERT_EQUAL_UINT32(1, ledger.framesOverBudget);
+
+  // 0 only reports
+  pushFrame(bus, fb.data());
+  drawMarker(bus);
+  TEST_ASSERT_TRUE(busFrameEnd(ledger, 0));
+  TEST_ASSERT_EQUAL_UINT32(3, ledger.frames);
+}
+
+// Same framebuffer, same bytes on the wire; one repainted pixel changes them
+void test_wire_hash_follows_content() {
+  std::vector<uint8_t> fb(FB_WIDTH * FB_HEIGHT);
+  for (size_t i = 0; i < fb.size(); i++) fb[i] = (uint8_t)(i * 7);
+  RecordingBus a(ledger), b(ledger);
+  pushFrame(a, fb.data());
+  pushFrame(b, fb.data());
+  TEST_ASSERT_EQUAL_UINT32(a.hash, b.hash);
+
+  fb[FB_WIDTH * 100 + 17] += 128;
+  b.clear();
+  pushFrame(b, fb.data());
+  TEST_ASSERT_TRUE(a.hash != b.hash);
+}
+
+void test_scope_restores_site() {
+  initBusLedger(displayBusLedger);
+  RecordingBus bus(displayBusLedger);
+  {
+    BusScope legend(BUS_SITE_LEGEND);
+    bus.beginWrite();
+    {
+      BusScope menu(BUS_SITE_MENU);
+      bus.writeCommand(0x2C);
+    }
+    bus.writeCommand(0x2C);
+    bus.endWrite();
+  }
+  bus.writeCommand(0x2C);
+  TEST_ASSERT_EQUAL(BUS_SITE_OTHER, displayBusLedger.site);
+  busFrameEnd(displayBusLedger, 0);
+  TEST_ASSERT_EQUAL_UINT32(1, displayBusLedger.lastFrame[BUS_SITE_MENU].bytes);
+  TEST_ASSERT_EQUAL_UINT32(1, displayBusLedger.lastFrame[BUS_SITE_LEGEND].bytes);
+  TEST_ASSERT_EQUAL_UINT32(1, displayBusLedger.lastFrame[BUS_SITE_OTHER].bytes);
+}
+
+int main(int argc, char **argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_push_is_attributed_to_frame_site);
+  RUN_TEST(test_sites_and_frames_are_separate);
+  RUN_TEST(test_byte_budget);
+  RUN_TEST(test_wire_hash_follows_content);
+  RUN_TEST(test_scope_restores_site);
+  return UNITY_END();
+}
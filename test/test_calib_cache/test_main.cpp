@@ -0,0 +1,214 @@
+// Calibration cache record format and the host store: a parameter set
+// extracted from a synthetic EEPROM survives pack / store / load byte for
+// byte, and is refused for another sensor or a changed EEPROM. When the
+// Melexis API is in lib/MLX90640 (scripts/fetch_melexis.py), one case runs
+// the real MLX90640_ExtractParameters and caches its paramsMLX90640.
+
+#include <unity.h>
+#include <string.h>
+#include <vector>
+#include "calib_cache.h"
+
+#if __has_include(<MLX90640_API.h>)
+#include <MLX90640_API.h>
+#include <MLX90640_I2C_Driver.h>
+#define HAVE_MELEXIS_API 1
+
+// The API links against an I2C driver; extraction never touches the bus
+void MLX90640_I2CInit() {
+}
+
+int MLX90640_I2CGeneralReset() {
+  return -1;
+}
+
+int MLX90640_I2CRead(uint8_t slaveAddr, uint16_t startAddress, uint16_t nMemAddressRead, uint16_t *data) {
+  return -1;
+}
+
+int MLX90640_I2CWrite(uint8_t slaveAddr, uint16_t writeAddress, uint16_t data) {
+  return -1;
+}
+
+void MLX90640_I2CFreqSet(int freq) {
+}
+
+// A dump read from a sensor (MLX_EEPROM_WORDS words at MLX_EEPROM_ADDR) can
+// be dropped in as RECORDED_EEPROM; otherwise a synthetic image is used
+#if __has_include("mlx90640_eeprom.h")
+#include "mlx90640_eeprom.h"
+#define HAVE_RECORDED_EEPROM 1
+#endif
+#endif
+
+// Stand-in for a Melexis parameter struct: mixed field sizes and padding
+struct FakeParams {
+  int16_t kVdd;
+  float tgc;
+  uint8_t resolutionEE;
+  uint16_t alpha[MLX_W * MLX_H];
+  int16_t offset[MLX_W * MLX_H];
+  int8_t kta[MLX_W * MLX_H];
+  float ksTo[5];
+};
+
+static uint16_t eeprom[MLX_EEPROM_WORDS];
+
+static void makeEeprom(uint16_t *ee, uint32_t seed) {
+  for (int i = 0; i < MLX_EEPROM_WORDS; i++) {
+    seed = seed * 1664525u + 1013904223u;
+    ee[i] = (uint16_t)(seed >> 16);
+  }
+}
+
+// Deterministic "extraction", padding included, like a memset + fill
+static void extractParameters(const uint16_t *ee, FakeParams &p) {
+  memset(&p, 0, sizeof(p));
+  p.kVdd = (int16_t)ee[0x33];
+  p.tgc = ee[0x3C] / 32.0f;
+  p.resolutionEE = ee[0x38] >> 12;
+  for (int i = 0; i < MLX_W * MLX_H; i++) {
+    p.alpha[i] = ee[64 + i % (MLX_EEPROM_WORDS - 64)];
+    p.offset[i] = (int16_t)(ee[64 + (i * 7) % (MLX_EEPROM_WORDS - 64)] >> 2);
+    p.kta[i] = (int8_t)(ee[64 + (i * 13) % (MLX_EEPROM_WORDS - 64)] >> 8);
+  }
+  for (int i = 0; i < 5; i++) p.ksTo[i] = (int16_t)ee[0x3D + i] / 1024.0f;
+}
+
+void setUp() {
+  makeEeprom(eeprom, 1);
+}
+
+void tearDown() {
+}
+
+void test_round_trip() {
+  FakeParams extracted;
+  extractParameters(eeprom, extracted);
+
+  std::vector<uint8_t> record(sizeof(CalibCacheHeader) + sizeof(FakeParams));
+  TEST_ASSERT_EQUAL(record.size(), calibPackRecord(record.data(), record.size(), eeprom, &extracted, sizeof(extracted)));
+  TEST_ASSERT_EQUAL(0, calibPackRecord(record.data(), record.size() - 1, eeprom, &extracted, sizeof(extracted)));
+
+  FakeParams unpacked;
+  memset(&unpacked, 0xA5, sizeof(unpacked));
+  TEST_ASSERT_TRUE(calibUnpackRecord(record.data(), record.size(), eeprom, &unpacked, sizeof(unpacked)));
+  TEST_ASSERT_EQUAL_MEMORY(&extracted, &unpacked, sizeof(extracted));
+
+  // Boot path: only the probe words are read before the load
+  TEST_ASSERT_TRUE(calibCacheStore(eeprom, &extracted, sizeof(extracted)));
+  uint16_t probe[CALIB_PROBE_WORDS];
+  memcpy(probe, eeprom, sizeof(probe));
+  FakeParams loaded;
+  memset(&loaded, 0x5A, sizeof(loaded));
+  TEST_ASSERT_TRUE(calibCacheLoad(probe, &loaded, sizeof(loaded)));
+  TEST_ASSERT_EQUAL_MEMORY(&extracted, &loaded, sizeof(extracted));
+}
+
+void test_other_sensor_misses() {
+  FakeParams params;
+  extractParameters(eeprom, params);
+  calibCacheStore(eeprom, &params, sizeof(params));
+
+  uint16_t other[MLX_EEPROM_WORDS];
+  makeEeprom(other, 2);
+  FakeParams loaded;
+  TEST_ASSERT_FALSE(calibCacheLoad(other, &loaded, sizeof(loaded)));
+
+  // A second sensor gets its own record
+  FakeParams otherParams;
+  extractParameters(other, otherParams);
+  calibCacheStore(other, &otherParams, sizeof(otherParams));
+  TEST_ASSERT_TRUE(calibCacheLoad(other, &loaded, sizeof(loaded)));
+  TEST_ASSERT_EQUAL_MEMORY(&otherParams, &loaded, sizeof(loaded));
+  TEST_ASSERT_TRUE(calibCacheLoad(eeprom, &loaded, sizeof(loaded)));
+  TEST_ASSERT_EQUAL_MEMORY(&params, &loaded, sizeof(loaded));
+}
+
+// Same device ID, different calibration words: the probe CRC catches it
+void test_changed_eeprom_misses() {
+  FakeParams params;
+  extractParameters(eeprom, params);
+  calibCacheStore(eeprom, &params, sizeof(params));
+
+  uint16_t probe[CALIB_PROBE_WORDS];
+  memcpy(probe, eeprom, sizeof(probe));
+  probe[CALIB_PROBE_WORDS - 1] ^= 0x0100;
+  FakeParams loaded;
+  TEST_ASSERT_FALSE(calibCacheLoad(probe, &loaded, sizeof(loaded)));
+}
+
+void test_size_mismatch_misses() {
+  FakeParams params;
+  extractParameters(eeprom, params);
+  calibCacheStore(eeprom, &params, sizeof(params));
+
+  FakeParams loaded;
+  TEST_ASSERT_FALSE(calibCacheLoad(eeprom, &loaded, sizeof(loaded) - 4));
+}
+
+void test_corrupt_record_rejected() {
+  FakeParams params;
+  extractParameters(eeprom, params);
+  std::vector<uint8_t> record(sizeof(CalibCacheHeader) + sizeof(FakeParams));
+  calibPackRecord(record.data(), record.size(), eeprom, &params, sizeof(params));
+
+  FakeParams loaded;
+  record[sizeof(CalibCacheHeader) + 100] ^= 0x01;
+  TEST_ASSERT_FALSE(calibUnpackRecord(record.data(), record.size(), eeprom, &loaded, sizeof(loaded)));
+  record[sizeof(CalibCacheHeader) + 100] ^= 0x01;
+
+  CalibCacheHeader h;
+  memcpy(&h, record.data(), sizeof(h));
+  TEST_ASSERT_TRUE(calibHeaderMatches(h, eeprom, sizeof(params)));
+  h.version++;
+  TEST_ASSERT_FALSE(calibHeaderMatches(h, eeprom, sizeof(params)));
+}
+
+// The real parameter struct, not a stand-in, through extraction, the cache
+// and back: the loaded parameters convert a frame exactly as the extracted
+void test_real_extractor_round_trip() {
+#if HAVE_MELEXIS_API
+  uint16_t ee[MLX_EEPROM_WORDS];
+#if HAVE_RECORDED_EEPROM
+  memcpy(ee, RECORDED_EEPROM, sizeof(ee));
+#else
+  // Device select bit clear, every pixel word non-zero without the outlier
+  // bit: a valid image with no deviating pixels
+  makeEeprom(ee, 3);
+  ee[10] &= ~0x0040;
+  for (int i = 64; i < MLX_EEPROM_WORDS; i++) ee[i] = (ee[i] & ~0x0001) | 0x0010;
+#endif
+
+  static paramsMLX90640 extracted, loaded;
+  TEST_ASSERT_EQUAL(0, MLX90640_ExtractParameters(ee, &extracted));
+  TEST_ASSERT_TRUE(calibCacheStore(ee, &extracted, sizeof(extracted)));
+  memset(&loaded, 0x5A, sizeof(loaded));
+  TEST_ASSERT_TRUE(calibCacheLoad(ee, &loaded, sizeof(loaded)));
+  TEST_ASSERT_EQUAL_MEMORY(&extracted, &loaded, sizeof(extracted));
+
+  // Subpage 0 of a chess-mode, 18-bit frame
+  uint16_t frame[MLX_FRAME_SIZE];
+  makeEeprom(frame, 4);
+  frame[832] = 0x1901;
+  frame[833] = 0;
+  std::vector<float> a(MLX_W * MLX_H), b(MLX_W * MLX_H);
+  float ta = MLX90640_GetTa(frame, &extracted);
+  MLX90640_CalculateTo(frame, &extracted, MLX_EMISSIVITY, ta - MLX_TA_SHIFT, a.data());
+  MLX90640_CalculateTo(frame, &loaded, MLX_EMISSIVITY, MLX90640_GetTa(frame, &loaded) - MLX_TA_SHIFT, b.data());
+  TEST_ASSERT_EQUAL_MEMORY(a.data(), b.data(), a.size() * sizeof(float));
+#else
+  TEST_IGNORE_MESSAGE("Melexis MLX90640 API not in lib/MLX90640/src");
+#endif
+}
+
+int main(int argc, char **argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_round_trip);
+  RUN_TEST(test_other_sensor_misses);
+  RUN_TEST(test_changed_eeprom_misses);
+  RUN_TEST(test_size_mismatch_misses);
+  RUN_TEST(test_corrupt_record_rejected);
+  RUN_TEST(test_real_extractor_round_trip);
+  return UNITY_END();
+}
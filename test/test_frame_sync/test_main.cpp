@@ -0,0 +1,210 @@
+// Two-sensor acquisition against a stub reader: publish / take
+// synchronisation, stitching at the overlap seam and a failing sensor,
+// whose share of the frame the conditioner does not reject.
+
+#include <unity.h>
+#include <math.h>
+#include <vector>
+#include "condition.h"
+#include "frame_sync.h"
+
+static const int SENSORS = 2;
+static const int STEP = SensorGeom::width - STITCH_OVERLAP;
+static const int OUT_W = SENSORS * SensorGeom::width - (SENSORS - 1) * STITCH_OVERLAP;
+static const int OUT_PIXELS = OUT_W * SensorGeom::height;
+
+// Each sensor sees its window of one scene, plus a per-sensor offset
+struct StubSensors {
+  float offset[SENSORS];
+  int status[SENSORS];
+  int reads;
+};
+
+static float scene(int x, int y) {
+  return 20.0f + 0.5f * x + 0.25f * y;
+}
+
+static int stubRead(int sensor, float *frame, void *ctx) {
+  StubSensors &stub = *(StubSensors *)ctx;
+  stub.reads++;
+  for (int y = 0; y < SensorGeom::height; y++) {
+    for (int x = 0; x < SensorGeom::width; x++) {
+      frame[y * SensorGeom::width + x] = scene(sensor * STEP + x, y) + stub.offset[sensor];
+    }
+  }
+  return stub.status[sensor];
+}
+
+static std::vector<float> slotMem(SENSORS * 3 * SensorGeom::pixels);
+static std::vector<float> out(OUT_PIXELS);
+static FrameSync sync;
+static StubSensors stub;
+
+static void publish(int sensor, uint32_t nowUs) {
+  int status = frameSyncRead(sync, sensor, stubRead, &stub);
+  frameSyncPublish(sync, sensor, status, nowUs);
+}
+
+void setUp() {
+  stub = StubSensors();
+  initFrameSync(sync, SENSORS, slotMem.data(), 0);
+}
+
+void tearDown() {
+}
+
+void test_waits_for_every_sensor() {
+  int status = 1;
+  publish(0, 1000);
+  TEST_ASSERT_FALSE(frameSyncTake(sync, 1000, status));
+  publish(1, 2000);
+  TEST_ASSERT_TRUE(frameSyncTake(sync, 2000, status));
+  TEST_ASSERT_EQUAL(0, status);
+
+  // The same set is not taken twice
+  TEST_ASSERT_FALSE(frameSyncTake(sync, 3000, status));
+  publish(0, 60000);
+  publish(1, 61000);
+  TEST_ASSERT_TRUE(frameSyncTake(sync, 61000, status));
+}
+
+void test_skewed_frame_is_dropped() {
+  int status;
+  publish(0, 1000);
+  publish(1, 1000 + STITCH_MAX_SKEW_US + 1);
+  TEST_ASSERT_FALSE(frameSyncTake(sync, 1000 + STITCH_MAX_SKEW_US + 1, status));
+
+  // Sensor 0's old frame was dropped; its next one pairs with sensor 1's
+  TEST_ASSERT_FALSE(frameSyncTake(sync, 1000 + STITCH_MAX_SKEW_US + 2, status));
+  publish(0, 1000 + STITCH_MAX_SKEW_US + 100);
+  TEST_ASSERT_TRUE(frameSyncTake(sync, 1000 + STITCH_MAX_SKEW_US + 100, status));
+}
+
+// Matching sensors reproduce the scene across the seam
+void test_seam_is_continuous() {
+  int status;
+  publish(0, 1000);
+  publish(1, 1000);
+  TEST_ASSERT_TRUE(frameSyncTake(sync, 1000, status));
+  frameSyncStitch(sync, out.data());
+
+  for (int y = 0; y < SensorGeom::height; y++) {
+    for (int x = 0; x < OUT_W; x++) {
+      TEST_ASSERT_FLOAT_WITHIN(1e-4f, scene(x, y), out[y * OUT_W + x]);
+    }
+  }
+}
+
+// An offset between the sensors is feathered across the overlap
+void test_seam_feathers_offset() {
+  stub.offset[1] = 2.0f;
+  int status;
+  publish(0, 1000);
+  publish(1, 1000);
+  TEST_ASSERT_TRUE(frameSyncTake(sync, 1000, status));
+  frameSyncStitch(sync, out.data());
+
+  for (int y = 0; y < SensorGeom::height; y++) {
+    const float *row = &out[y * OUT_W];
+    for (int x = 0; x < STEP; x++) TEST_ASSERT_FLOAT_WITHIN(1e-4f, scene(x, y), row[x]);
+    for (int j = 0; j < STITCH_OVERLAP; j++) {
+      float w = (float)(j + 1) / (STITCH_OVERLAP + 1);
+      TEST_ASSERT_FLOAT_WITHIN(1e-4f, scene(STEP + j, y) + 2.0f * w, row[STEP + j]);
+    }
+    for (int x = STEP + STITCH_OVERLAP; x < OUT_W; x++) {
+      TEST_ASSERT_FLOAT_WITHIN(1e-4f, scene(x, y) + 2.0f, row[x]);
+    }
+  }
+}
+
+// A failed read leaves the other sensor's pixels, the overlap included,
+// and NaN for the rest
+void test_one_sensor_failing() {
+  stub.status[1] = -1;
+  int status = 1;
+  publish(0, 1000);
+  publish(1, 1000);
+  TEST_ASSERT_TRUE(frameSyncTake(sync, 1000, status));
+  TEST_ASSERT_EQUAL(0, status);
+  frameSyncStitch(sync, out.data());
+
+  int invalid = 0;
+  for (int y = 0; y < SensorGeom::height; y++) {
+    const float *row = &out[y * OUT_W];
+    for (int x = 0; x < SensorGeom::width; x++) TEST_ASSERT_FLOAT_WITHIN(1e-4f, scene(x, y), row[x]);
+    for (int x = SensorGeom::width; x < OUT_W; x++) invalid += isnan(row[x]) ? 1 : 0;
+  }
+  TEST_ASSERT_EQUAL(SensorGeom::height * (OUT_W - SensorGeom::width), invalid);
+  TEST_ASSERT_EQUAL(invalid, frameSyncMissingPixels(sync));
+
+  // Both failing is an error for the frame
+  stub.status[0] = -3;
+  publish(0, 60000);
+  publish(1, 60000);
+  TEST_ASSERT_TRUE(frameSyncTake(sync, 60000, status));
+  TEST_ASSERT_EQUAL(-3, status);
+  TEST_ASSERT_EQUAL(OUT_PIXELS, frameSyncMissingPixels(sync));
+}
+
+// A dead sensor's NaN share is far above the quarter the conditioner
+// rejects at; left out of the count, the frame is kept and repaired, and
+// corruption in the live share is still rejected
+void test_missing_share_is_not_rejected() {
+  std::vector<float> temporal(TEMPORAL_FILTER_SIZE * FrameGeom::pixels), lastValid(FrameGeom::pixels);
+  std::vector<float> frame(FrameGeom::pixels), conditioned(FrameGeom::pixels);
+  FrameConditioner c;
+  initConditioner(c, temporal.data(), lastValid.data());
+
+  const int deadFrom = FrameGeom::width / 2;
+  const int missing = (FrameGeom::width - deadFrom) * FrameGeom::height;
+  for (int y = 0; y < FrameGeom::height; y++) {
+    for (int x = 0; x < FrameGeom::width; x++) frame[y * FrameGeom::width + x] = x < deadFrom ? scene(x, y) : NAN;
+  }
+
+  int invalid;
+  TEST_ASSERT_FALSE(conditionRawFrame(c, frame.data(), conditioned.data(), invalid));
+  TEST_ASSERT_TRUE(conditionRawFrame(c, frame.data(), conditioned.data(), invalid, missing));
+  TEST_ASSERT_EQUAL(missing, invalid);
+  for (float t : conditioned) TEST_ASSERT_FALSE(isnan(t));
+
+  const int live = FrameGeom::pixels - missing;
+  for (int i = 0; i <= live / 4; i++) frame[(i / deadFrom) * FrameGeom::width + i % deadFrom] = NAN;
+  initConditioner(c, temporal.data(), lastValid.data());    // no median over the clean frames
+  TEST_ASSERT_FALSE(conditionRawFrame(c, frame.data(), conditioned.data(), invalid, missing));
+}
+
+// A sensor that stops publishing does not stall the array
+void test_silent_sensor_goes_stale() {
+  int status;
+  publish(0, 1000);
+  publish(1, 1000);
+  TEST_ASSERT_TRUE(frameSyncTake(sync, 1000, status));
+
+  publish(0, 1000 + STITCH_STALE_US);
+  TEST_ASSERT_FALSE(frameSyncTake(sync, 1000 + STITCH_STALE_US, status));
+  publish(0, 2000 + STITCH_STALE_US);
+  TEST_ASSERT_TRUE(frameSyncTake(sync, 2000 + STITCH_STALE_US, status));
+  TEST_ASSERT_EQUAL(0, status);
+  frameSyncStitch(sync, out.data());
+  TEST_ASSERT_FLOAT_WITHIN(1e-4f, scene(STEP, 0), out[STEP]);
+  TEST_ASSERT_TRUE(isnan(out[OUT_W - 1]));
+
+  // It rejoins as soon as it publishes again
+  publish(0, 3000 + STITCH_STALE_US);
+  publish(1, 3000 + STITCH_STALE_US);
+  TEST_ASSERT_TRUE(frameSyncTake(sync, 3000 + STITCH_STALE_US, status));
+  frameSyncStitch(sync, out.data());
+  TEST_ASSERT_FLOAT_WITHIN(1e-4f, scene(OUT_W - 1, 0), out[OUT_W - 1]);
+}
+
+int main(int argc, char **argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_waits_for_every_sensor);
+  RUN_TEST(test_skewed_frame_is_dropped);
+  RUN_TEST(test_seam_is_continuous);
+  RUN_TEST(test_seam_feathers_offset);
+  RUN_TEST(test_one_sensor_failing);
+  RUN_TEST(test_silent_sensor_goes_stale);
+  RUN_TEST(test_missing_share_is_not_rejected);
+  return UNITY_END();
+}
@@ -0,0 +1,223 @@
+// Link health state machine against a stub bus that fails reads at set
+// rates: window step-down, fast fail, clean-window recovery and the
+// doubling step-up backoff of a level that failed.
+
+#include <unity.h>
+#include "i2c_health.h"
+
+static const uint32_t clockLevels[I2C_CLOCK_LEVEL_COUNT] = I2C_CLOCK_LEVELS;
+static const uint32_t TRANSFER_US = 20000;
+static I2cHealth health;
+
+// Stand-in for the sensor read: each frame fails with a NACK, a timeout or a
+// frame data check failure at the given rates (per mille), using the
+// Melexis status codes, drawn from a fixed-seed LCG. failAboveHz models a
+// marginal harness: only clocks above it see the error rates at all.
+struct StubBus {
+  uint16_t nackPerMille;
+  uint16_t timeoutPerMille;
+  uint16_t sanityPerMille;
+  uint32_t failAboveHz;
+  uint32_t seed;
+
+  uint32_t next() {
+    seed = seed * 1664525UL + 1013904223UL;
+    return (seed >> 8) % 1000;
+  }
+
+  // Status and transfer time of one frame read at clockHz
+  int read(uint32_t clockHz, uint32_t &transferUs) {
+    transferUs = TRANSFER_US;
+    if (clockHz <= failAboveHz) return 0;
+    uint32_t r = next();
+    if (r < nackPerMille) return -1;
+    r -= nackPerMille;
+    if (r < timeoutPerMille) {
+      transferUs = I2C_FRAME_TIMEOUT_US + 1;
+      return 0;
+    }
+    r -= timeoutPerMille;
+    if (r < sanityPerMille) return -8;
+    return 0;
+  }
+};
+
+static StubBus cleanBus() {
+  return StubBus{0, 0, 0, 0, 1};
+}
+
+// Feeds frames until the clock changes or maxFrames pass; returns the
+// frames fed (maxFrames + 1 when nothing changed)
+static int runUntilChange(StubBus &bus, int maxFrames) {
+  for (int f = 1; f <= maxFrames; f++) {
+    uint32_t us;
+    int status = bus.read(i2cHealthClock(health), us);
+    if (i2cHealthRecord(health, status, 0, us)) return f;
+  }
+  return maxFrames + 1;
+}
+
+static int level() {
+  return health.stats.level;
+}
+
+void setUp() {
+  i2cHealthInit(health, clockLevels[2]);
+}
+
+void tearDown() {
+}
+
+void test_classify_status() {
+  TEST_ASSERT_EQUAL(I2C_FRAME_OK, i2cClassifyFrame(0, TRANSFER_US));
+  TEST_ASSERT_EQUAL(I2C_FRAME_NACK, i2cClassifyFrame(-1, TRANSFER_US));
+  TEST_ASSERT_EQUAL(I2C_FRAME_SANITY, i2cClassifyFrame(-8, TRANSFER_US));
+  TEST_ASSERT_EQUAL(I2C_FRAME_TIMEOUT, i2cClassifyFrame(0, I2C_FRAME_TIMEOUT_US + 1));
+  TEST_ASSERT_EQUAL(I2C_FRAME_TIMEOUT, i2cClassifyFrame(-2, TRANSFER_US));
+}
+
+void test_starts_at_highest_level_not_above_request() {
+  i2cHealthInit(health, 900000UL);
+  TEST_ASSERT_EQUAL_UINT32(800000UL, i2cHealthClock(health));
+  i2cHealthInit(health, clockLevels[I2C_CLOCK_LEVEL_COUNT - 1] * 2);
+  TEST_ASSERT_EQUAL(I2C_CLOCK_LEVEL_COUNT - 1, level());
+}
+
+// Scattered errors never trip the fast fail; the window count does
+void test_window_steps_down_on_each_error_kind() {
+  const uint16_t rates[3][3] = {{100, 0, 0}, {0, 100, 0}, {0, 0, 100}};
+  for (int k = 0; k < 3; k++) {
+    i2cHealthInit(health, clockLevels[2]);
+    StubBus bus = {rates[k][0], rates[k][1], rates[k][2], 0, 7u + k};
+    int frames = runUntilChange(bus, I2C_HEALTH_WINDOW);
+    TEST_ASSERT_EQUAL_MESSAGE(I2C_HEALTH_WINDOW, frames, "step-down at the end of the first window");
+    TEST_ASSERT_EQUAL(1, level());
+    TEST_ASSERT_GREATER_OR_EQUAL(I2C_STEP_DOWN_ERRORS, health.stats.lastWindowErrors);
+  }
+}
+
+void test_single_error_per_window_holds_level() {
+  StubBus bus = cleanBus();
+  for (int w = 0; w < 3 * I2C_STEP_UP_WINDOWS; w++) {
+    for (int f = 0; f < I2C_HEALTH_WINDOW; f++) {
+      uint32_t us;
+      int status = f == 5 ? -1 : bus.read(i2cHealthClock(health), us);
+      TEST_ASSERT_FALSE(i2cHealthRecord(health, status, 0, TRANSFER_US));
+    }
+  }
+  TEST_ASSERT_EQUAL(2, level());
+  TEST_ASSERT_EQUAL(1, health.stats.lastWindowErrors);
+}
+
+void test_fast_fail_steps_down_mid_window() {
+  StubBus bus = {1000, 0, 0, 0, 3};
+  TEST_ASSERT_EQUAL(I2C_FAST_FAIL_ERRORS, runUntilChange(bus, I2C_HEALTH_WINDOW));
+  TEST_ASSERT_EQUAL(1, level());
+
+  // A hard failure keeps stepping down to the slowest level, then holds
+  TEST_ASSERT_EQUAL(I2C_FAST_FAIL_ERRORS, runUntilChange(bus, I2C_HEALTH_WINDOW));
+  TEST_ASSERT_EQUAL(0, level());
+  TEST_ASSERT_EQUAL(I2C_HEALTH_WINDOW + 1, runUntilChange(bus, I2C_HEALTH_WINDOW));
+  TEST_ASSERT_EQUAL(0, level());
+}
+
+void test_corrupt_frames_count_as_errors() {
+  int corrupt = (int)(SensorGeom::pixels * I2C_CORRUPT_PIXEL_RATIO) + 1;
+  bool changed = false;
+  for (int f = 0; f < I2C_FAST_FAIL_ERRORS && !changed; f++) {
+    changed = i2cHealthRecord(health, 0, corrupt, TRANSFER_US);
+  }
+  TEST_ASSERT_TRUE(changed);
+  TEST_ASSERT_EQUAL(1, level());
+}
+
+void test_clean_windows_recover() {
+  StubBus bus = cleanBus();
+  int frames = runUntilChange(bus, 64 * I2C_HEALTH_WINDOW);
+  TEST_ASSERT_EQUAL(I2C_STEP_UP_WINDOWS * I2C_HEALTH_WINDOW, frames);
+  TEST_ASSERT_EQUAL(3, level());
+  TEST_ASSERT_EQUAL_UINT32(clockLevels[3], i2cHealthClock(health));
+
+  // Already at the top: nothing further to try
+  TEST_ASSERT_EQUAL(64 * I2C_HEALTH_WINDOW + 1, runUntilChange(bus, 64 * I2C_HEALTH_WINDOW));
+}
+
+// A harness that only fails above 1 MHz: every failed try of 1.6 MHz
+// doubles the clean windows needed before the next one, up to the cap
+void test_backoff_doubles_per_failed_level() {
+  StubBus bus = {1000, 0, 0, clockLevels[2], 11};
+  int expected = I2C_STEP_UP_WINDOWS;
+
+  for (int attempt = 0; attempt < 6; attempt++) {
+    int frames = runUntilChange(bus, 1000 * I2C_HEALTH_WINDOW);
+    TEST_ASSERT_EQUAL_MESSAGE(expected * I2C_HEALTH_WINDOW, frames, "clean windows before the next try");
+    TEST_ASSERT_EQUAL(3, level());
+
+    TEST_ASSERT_EQUAL(I2C_FAST_FAIL_ERRORS, runUntilChange(bus, I2C_HEALTH_WINDOW));
+    TEST_ASSERT_EQUAL(2, level());
+
+    expected = expected * 2 > I2C_STEP_UP_MAX_WINDOWS ? I2C_STEP_UP_MAX_WINDOWS : expected * 2;
+  }
+  TEST_ASSERT_EQUAL(I2C_STEP_UP_MAX_WINDOWS, expected);
+}
+
+// Backoff is per level: the level below still recovers at the base rate
+void test_backoff_is_per_level() {
+  StubBus failing = {1000, 0, 0, 0, 5};
+  runUntilChange(failing, I2C_HEALTH_WINDOW);
+  TEST_ASSERT_EQUAL(1, level());
+  runUntilChange(failing, I2C_HEALTH_WINDOW);
+  TEST_ASSERT_EQUAL(0, level());
+
+  StubBus bus = cleanBus();
+  TEST_ASSERT_EQUAL(2 * I2C_STEP_UP_WINDOWS * I2C_HEALTH_WINDOW, runUntilChange(bus, 1000 * I2C_HEALTH_WINDOW));
+  TEST_ASSERT_EQUAL(1, level());
+  TEST_ASSERT_EQUAL(2 * I2C_STEP_UP_WINDOWS * I2C_HEALTH_WINDOW, runUntilChange(bus, 1000 * I2C_HEALTH_WINDOW));
+  TEST_ASSERT_EQUAL(2, level());
+  TEST_ASSERT_EQUAL(I2C_STEP_UP_WINDOWS * I2C_HEALTH_WINDOW, runUntilChange(bus, 1000 * I2C_HEALTH_WINDOW));
+  TEST_ASSERT_EQUAL(3, level());
+}
+
+void test_window_statistics() {
+  for (int f = 0; f < I2C_HEALTH_WINDOW - 1; f++) i2cHealthRecord(health, 0, 0, TRANSFER_US);
+  i2cHealthRecord(health, 0, 0, TRANSFER_US + I2C_HEALTH_WINDOW);
+  const I2cHealthStats &s = health.stats;
+  TEST_ASSERT_EQUAL_UINT32(TRANSFER_US + 1, s.avgTransferUs);
+  TEST_ASSERT_EQUAL(0, s.frames);
+  TEST_ASSERT_EQUAL(0, s.totalErrors);
+}
+
+// Each sensor keeps its own link state: a dead sensor steps down its own
+// clock only
+void test_links_are_independent() {
+  I2cHealth other;
+  i2cHealthInit(other, clockLevels[2]);
+  StubBus dead = {1000, 0, 0, 0, 9};
+  StubBus clean = cleanBus();
+  for (int f = 0; f < 2 * I2C_HEALTH_WINDOW; f++) {
+    uint32_t us;
+    int status = dead.read(i2cHealthClock(health), us);
+    i2cHealthRecord(health, status, 0, us);
+    status = clean.read(i2cHealthClock(other), us);
+    TEST_ASSERT_FALSE(i2cHealthRecord(other, status, 0, us));
+  }
+  TEST_ASSERT_EQUAL(0, level());
+  TEST_ASSERT_EQUAL(2, other.stats.level);
+  TEST_ASSERT_EQUAL(0, other.stats.totalErrors);
+}
+
+int main(int argc, char **argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_classify_status);
+  RUN_TEST(test_starts_at_highest_level_not_above_request);
+  RUN_TEST(test_window_steps_down_on_each_error_kind);
+  RUN_TEST(test_single_error_per_window_holds_level);
+  RUN_TEST(test_fast_fail_steps_down_mid_window);
+  RUN_TEST(test_corrupt_frames_count_as_errors);
+  RUN_TEST(test_clean_windows_recover);
+  RUN_TEST(test_backoff_doubles_per_failed_level);
+  RUN_TEST(test_backoff_is_per_level);
+  RUN_TEST(test_window_statistics);
+  RUN_TEST(test_links_are_independent);
+  return UNITY_END();
+}
@@ -0,0 +1,210 @@
+// Frame-budget quality controller driven by synthetic load traces: step
+// overloads, the hysteresis band, the doubling step-up backoff and its
+// reset, a load oscillating around the budget, and the push kept out of the
+// reducible work.
+
+#include <unity.h>
+#include <vector>
+#include "quality.h"
+
+static const float BUDGET = 1000.0f / TARGET_FPS;
+static const int DOWN_STEP = QUALITY_MIN_DWELL + QUALITY_DOWN_FRAMES;   // frames between two step downs
+
+// Load of one frame: reducible work at the controller's current level, and
+// the push, which no level shrinks
+struct Load {
+  virtual float workMs(int level, int frame) = 0;
+  virtual float pushMs(int, int) { return 0.0f; }
+};
+
+struct Trace {
+  std::vector<int> levels;      // level each frame was rendered at
+  std::vector<int> switchFrames;
+  std::vector<int> switchTo;
+};
+
+static void run(QualityController &q, Load &load, int frames, Trace &t) {
+  for (int f = 0; f < frames; f++) {
+    const int frame = (int)t.levels.size();
+    t.levels.push_back(q.level);
+    QualityDecision d = qualityUpdate(q, load.workMs(q.level, frame), load.pushMs(q.level, frame));
+    if (d.changed) {
+      t.switchFrames.push_back(frame);
+      t.switchTo.push_back(d.to);
+    }
+  }
+}
+
+struct Constant : Load {
+  float ms;
+  explicit Constant(float m) : ms(m) {}
+  float workMs(int, int) override { return ms; }
+};
+
+// Over budget at full quality, fine one level down
+struct Boundary : Load {
+  float fullMs, degradedMs;
+  Boundary(float full, float degraded) : fullMs(full), degradedMs(degraded) {}
+  float workMs(int level, int) override { return level == QUALITY_FULL ? fullMs : degradedMs; }
+};
+
+void setUp() {
+}
+
+void tearDown() {
+}
+
+// A step overload walks down one level per QUALITY_DOWN_FRAMES after each
+// dwell and stops at QUALITY_MAX_LEVEL
+void test_step_overload_walks_down_in_order() {
+  QualityController q;
+  initQuality(q);
+  Constant heavy(BUDGET * 1.5f);
+  Trace t;
+  run(q, heavy, 200, t);
+
+  TEST_ASSERT_EQUAL_INT(QUALITY_MAX_LEVEL, (int)t.switchFrames.size());
+  for (int k = 0; k < QUALITY_MAX_LEVEL; k++) {
+    TEST_ASSERT_EQUAL_INT(QUALITY_DOWN_FRAMES - 1 + k * DOWN_STEP, t.switchFrames[k]);
+    TEST_ASSERT_EQUAL_INT(k + 1, t.switchTo[k]);
+  }
+  TEST_ASSERT_EQUAL_INT(QUALITY_MAX_LEVEL, q.level);
+}
+
+// Below the budget but above QUALITY_HEADROOM of it the level holds either
+// way; once the load falls under the headroom it climbs back one level per
+// QUALITY_UP_FRAMES quiet frames
+void test_hysteresis_band_holds_then_recovers() {
+  QualityController q;
+  initQuality(q);
+  Constant heavy(BUDGET * 1.5f);
+  Trace t;
+  run(q, heavy, 3 * DOWN_STEP, t);
+
+  // The smoothed time still carries the overload for a few frames
+  Constant band(BUDGET * (1.0f + QUALITY_HEADROOM) / 2.0f);
+  run(q, band, 2 * DOWN_STEP, t);
+  const int degraded = q.level;
+  TEST_ASSERT_TRUE(degraded >= 2);
+
+  const size_t before = t.switchFrames.size();
+  run(q, band, 20 * QUALITY_UP_FRAMES, t);
+  TEST_ASSERT_EQUAL_INT(degraded, q.level);
+  TEST_ASSERT_EQUAL_INT((int)before, (int)t.switchFrames.size());
+
+  Constant light(BUDGET * QUALITY_HEADROOM * 0.5f);
+  const int quietStart = (int)t.levels.size();
+  run(q, light, 20 * QUALITY_UP_FRAMES, t);
+  TEST_ASSERT_EQUAL_INT(QUALITY_FULL, q.level);
+  TEST_ASSERT_EQUAL_INT((int)before + degraded, (int)t.switchFrames.size());
+
+  int previous = quietStart;
+  for (size_t k = before; k < t.switchFrames.size(); k++) {
+    TEST_ASSERT_EQUAL_INT(degraded - (int)(k - before) - 1, t.switchTo[k]);
+    TEST_ASSERT_TRUE(t.switchFrames[k] - previous >= QUALITY_UP_FRAMES);
+    previous = t.switchFrames[k];
+  }
+}
+
+// A step up that is undone before QUALITY_UP_FRAMES doubles the wait for the
+// next one, up to QUALITY_MAX_BACKOFF doublings
+void test_failed_step_up_doubles_the_wait() {
+  QualityController q;
+  initQuality(q, QUALITY_SLOW_UI);
+  Boundary load(BUDGET * 1.3f, BUDGET * QUALITY_HEADROOM * 0.6f);
+  Trace t;
+  run(q, load, 4000, t);
+
+  // Alternating up (to full) and down (to slow_ui) switches
+  TEST_ASSERT_TRUE(t.switchFrames.size() >= 2 * (QUALITY_MAX_BACKOFF + 2));
+  std::vector<int> waits;
+  for (size_t k = 0; k < t.switchFrames.size(); k++) {
+    if (t.switchTo[k] != QUALITY_FULL) continue;
+    const int since = k == 0 ? -1 : t.switchFrames[k - 1];    // frames counted from the first
+    waits.push_back(t.switchFrames[k] - since);
+  }
+
+  // The quiet run starts after the dwell and the smoothing has settled,
+  // which takes well under QUALITY_UP_FRAMES frames
+  for (size_t k = 0; k < waits.size(); k++) {
+    const int backoff = (int)k < QUALITY_MAX_BACKOFF ? (int)k : QUALITY_MAX_BACKOFF;
+    const int wait = QUALITY_UP_FRAMES << backoff;
+    TEST_ASSERT_TRUE(waits[k] >= wait);
+    TEST_ASSERT_TRUE(waits[k] < wait + QUALITY_UP_FRAMES);
+  }
+}
+
+// A step up that lasts QUALITY_UP_FRAMES clears the backoff
+void test_backoff_resets_after_a_lasting_step_up() {
+  QualityController q;
+  initQuality(q, QUALITY_SLOW_UI);
+  Boundary flapping(BUDGET * 1.3f, BUDGET * QUALITY_HEADROOM * 0.6f);
+  Trace t;
+  run(q, flapping, 600, t);
+  TEST_ASSERT_TRUE(q.backoff >= 2);
+
+  // Full quality fits now: the next step up sticks and the backoff clears
+  Constant light(BUDGET * QUALITY_HEADROOM * 0.5f);
+  run(q, light, (QUALITY_UP_FRAMES << QUALITY_MAX_BACKOFF) + 2 * QUALITY_UP_FRAMES, t);
+  TEST_ASSERT_EQUAL_INT(QUALITY_FULL, q.level);
+  TEST_ASSERT_EQUAL_INT(0, q.backoff);
+}
+
+// A load swinging a few ms around the budget every few frames settles one
+// level down instead of flapping between the two
+struct Oscillating : Load {
+  float workMs(int level, int frame) override {
+    const float swing = (frame / 5) % 2 ? 0.15f : -0.15f;
+    const float base = level == QUALITY_FULL ? BUDGET * 1.02f : BUDGET * 0.8f;
+    return base * (1.0f + swing);
+  }
+};
+
+void test_oscillation_around_budget_does_not_flap() {
+  QualityController q;
+  initQuality(q);
+  Oscillating load;
+  Trace t;
+  run(q, load, 4000, t);
+
+  TEST_ASSERT_EQUAL_INT(QUALITY_SLOW_UI, q.level);
+  TEST_ASSERT_TRUE(t.switchFrames.size() <= 2);
+  for (int level : t.levels) TEST_ASSERT_TRUE(level <= QUALITY_SLOW_UI);
+}
+
+// A push that alone fills the frame is not reducible: light render work
+// stays at full quality, heavy work is still held to the floor share
+struct SlowPanel : Load {
+  float work;
+  explicit SlowPanel(float w) : work(w) {}
+  float workMs(int, int) override { return work; }
+  float pushMs(int, int) override { return BUDGET * 1.05f; }
+};
+
+void test_push_time_is_not_reducible() {
+  QualityController q;
+  initQuality(q);
+  SlowPanel light(BUDGET * QUALITY_MIN_WORK_SHARE * 0.6f);
+  Trace t;
+  run(q, light, 500, t);
+  TEST_ASSERT_EQUAL_INT(QUALITY_FULL, q.level);
+  TEST_ASSERT_EQUAL_INT(0, (int)t.switchFrames.size());
+
+  SlowPanel heavy(BUDGET * QUALITY_MIN_WORK_SHARE * 1.5f);
+  run(q, heavy, 100, t);
+  TEST_ASSERT_TRUE(q.level > QUALITY_FULL);
+
+  TEST_ASSERT_EQUAL_FLOAT(BUDGET * QUALITY_MIN_WORK_SHARE, qualityWorkBudgetMs(BUDGET * 1.05f));
+  TEST_ASSERT_EQUAL_FLOAT(BUDGET - 5.0f, qualityWorkBudgetMs(5.0f));
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_step_overload_walks_down_in_order);
+  RUN_TEST(test_hysteresis_band_holds_then_recovers);
+  RUN_TEST(test_failed_step_up_doubles_the_wait);
+  RUN_TEST(test_backoff_resets_after_a_lasting_step_up);
+  RUN_TEST(test_oscillation_around_budget_does_not_flap);
+  RUN_TEST(test_push_time_is_not_reducible);
+  return UNITY_END();
+}
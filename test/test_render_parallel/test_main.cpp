@@ -0,0 +1,96 @@
+// Split render (worker thread + caller) against a single-thread render of
+// the whole framebuffer: the two halves must produce the same bytes.
+
+#include <unity.h>
+#include <math.h>
+#include <string.h>
+#include <vector>
+#include "arena.h"
+#include "palette.h"
+#include "render_parallel.h"
+
+static std::vector<float> frame(FrameGeom::pixels);
+static uint16_t lut[COLOR_LUT_SIZE];
+static FoveaMap<FbGeom> fovea;
+
+// Smooth gradient, a hot blob and a sharp step, so edges, fovea borders and
+// nearest-row copies all occur on both sides of the split
+static void buildFrame() {
+  for (int y = 0; y < FrameGeom::height; y++) {
+    for (int x = 0; x < FrameGeom::width; x++) {
+      float dx = x - FrameGeom::width * 0.6f;
+      float dy = y - FrameGeom::height * 0.45f;
+      float t = 22.0f + 0.2f * x + 0.1f * y + 15.0f * expf(-(dx * dx + dy * dy) / 8.0f);
+      if (x > FrameGeom::width / 4 && x < FrameGeom::width / 3) t += 6.0f;
+      frame[y * FrameGeom::width + x] = t;
+    }
+  }
+}
+
+static void renderBoth(bool edges, const FoveaMap<FbGeom> *fov, RenderFilter filter, const ViewWindow &view) {
+  std::vector<FbPixel> split(FbGeom::pixels), single(FbGeom::pixels);
+  std::vector<uint8_t> maskSplit(EDGE_MASK_BYTES), maskSingle(EDGE_MASK_BYTES);
+  std::vector<float> rows(2 * RENDER_CACHE_ROWS * FbGeom::width);
+
+  RenderJob job = {frame.data(), 22.0f, 45.0f, lut, edges ? maskSplit.data() : nullptr,
+                   split.data(), rows.data(), view, fov, filter};
+  renderParallel(job);
+
+  job.edgeMask = edges ? maskSingle.data() : nullptr;
+  job.out = single.data();
+  renderStrip(job, 0, FbGeom::height);
+
+  TEST_ASSERT_EQUAL_MEMORY(single.data(), split.data(), FbGeom::pixels * sizeof(FbPixel));
+  if (edges) TEST_ASSERT_EQUAL_MEMORY(maskSingle.data(), maskSplit.data(), EDGE_MASK_BYTES);
+}
+
+void setUp() {
+}
+
+void tearDown() {
+}
+
+void test_bilinear() {
+  renderBoth(false, nullptr, FILTER_BILINEAR, FULL_VIEW);
+}
+
+void test_bilinear_edges() {
+  renderBoth(true, nullptr, FILTER_BILINEAR, FULL_VIEW);
+}
+
+void test_fovea_edges() {
+  if (!FOVEATED_RENDER) TEST_IGNORE();
+  // One focus on each side of the split row
+  int focusX[2] = {FbGeom::width / 2, FbGeom::width / 4};
+  int focusY[2] = {FbGeom::height / 2 - 8, FbGeom::height - 24};
+  buildFoveaMap(fovea, focusX, focusY, 2);
+  renderBoth(true, &fovea, FILTER_BILINEAR, FULL_VIEW);
+}
+
+void test_nearest() {
+  renderBoth(false, nullptr, FILTER_NEAREST, FULL_VIEW);
+  renderBoth(true, nullptr, FILTER_NEAREST, FULL_VIEW);
+}
+
+void test_nearest_half() {
+  renderBoth(false, nullptr, FILTER_NEAREST_HALF, FULL_VIEW);
+}
+
+void test_zoomed_view() {
+  ViewWindow view = {(uint8_t)(ZOOM_LEVEL_COUNT - 1), 3, 2};
+  renderBoth(true, nullptr, FILTER_BILINEAR, view);
+}
+
+int main(int argc, char **argv) {
+  buildFrame();
+  buildPalette(PALETTE_IRON, lut);
+
+  UNITY_BEGIN();
+  RUN_TEST(test_bilinear);
+  RUN_TEST(test_bilinear_edges);
+  RUN_TEST(test_fovea_edges);
+  RUN_TEST(test_nearest);
+  RUN_TEST(test_nearest_half);
+  RUN_TEST(test_zoomed_view);
+  return UNITY_END();
+}
@@ -0,0 +1,172 @@
+// Integer lanes of the vector backends (simd.h) against the scalar
+// reference: the ops themselves, and the kernels that use them (axis
+// mapping, palette index clamping, edge mask, temporal median). SimdPie
+// only builds for the S3 (opt-in); on the host the GCC backend stands in.
+
+#include <unity.h>
+#include <math.h>
+#include <string.h>
+#include <vector>
+#include "arena.h"
+#include "pipeline.h"
+#include "render.h"
+
+static std::vector<float> frame(FrameGeom::pixels);
+
+static void buildFrame() {
+  for (int y = 0; y < FrameGeom::height; y++) {
+    for (int x = 0; x < FrameGeom::width; x++) {
+      float dx = x - FrameGeom::width * 0.6f;
+      float dy = y - FrameGeom::height * 0.45f;
+      float t = 22.0f + 0.2f * x + 0.1f * y + 15.0f * expf(-(dx * dx + dy * dy) / 8.0f);
+      if (x > FrameGeom::width / 4 && x < FrameGeom::width / 3) t += 6.0f;
+      frame[y * FrameGeom::width + x] = t;
+    }
+  }
+}
+
+void setUp() {
+}
+
+void tearDown() {
+}
+
+void test_int_ops_match_scalar() {
+  const int32_t wa[4] = {-7, 0, 2147483647, -2147483647 - 1};
+  const int32_t wb[4] = {3, -1, 5, 9};
+  alignas(16) int32_t r[4], ref[4];
+  SimdGcc::storeW(r, SimdGcc::minW(SimdGcc::loadW(wa), SimdGcc::loadW(wb)));
+  SimdScalar::storeW(ref, SimdScalar::minW(SimdScalar::loadW(wa), SimdScalar::loadW(wb)));
+  TEST_ASSERT_EQUAL_INT32_ARRAY(ref, r, 4);
+  SimdGcc::storeW(r, SimdGcc::maxW(SimdGcc::loadW(wa), SimdGcc::loadW(wb)));
+  SimdScalar::storeW(ref, SimdScalar::maxW(SimdScalar::loadW(wa), SimdScalar::loadW(wb)));
+  TEST_ASSERT_EQUAL_INT32_ARRAY(ref, r, 4);
+
+  // Sums past int16 saturate
+  const uint16_t ha[8] = {0, 1, 100, 32767, 32000, 7, 479, 31};
+  alignas(16) int16_t h[8], href[8];
+  for (int16_t offset : {(int16_t)0, (int16_t)5, (int16_t)-3, (int16_t)1000}) {
+    SimdGcc::storeH(h, SimdGcc::addH(SimdGcc::loadH(ha), SimdGcc::splatH(offset)));
+    SimdScalar::storeH(href, SimdScalar::addH(SimdScalar::loadH(ha), SimdScalar::splatH(offset)));
+    TEST_ASSERT_EQUAL_INT16_ARRAY(href, h, 8);
+  }
+  TEST_ASSERT_EQUAL_INT16(INT16_MAX, href[3]);
+  SimdGcc::storeH(h, SimdGcc::minH(SimdGcc::loadH(ha), SimdGcc::splatH(31)));
+  SimdScalar::storeH(href, SimdScalar::minH(SimdScalar::loadH(ha), SimdScalar::splatH(31)));
+  TEST_ASSERT_EQUAL_INT16_ARRAY(href, h, 8);
+  SimdGcc::storeH(h, SimdGcc::maxH(SimdGcc::loadH(ha), SimdGcc::splatH(31)));
+  SimdScalar::storeH(href, SimdScalar::maxH(SimdScalar::loadH(ha), SimdScalar::splatH(31)));
+  TEST_ASSERT_EQUAL_INT16_ARRAY(href, h, 8);
+}
+
+// Every zoom level and pan origin maps to the same clamped indices as the
+// per-pixel form
+void test_axis_lanes_match_scalar() {
+  for (uint8_t level = 0; level < ZOOM_LEVEL_COUNT; level++) {
+    for (int origin = 0; origin <= FrameGeom::width / 2; origin += 3) {
+      ViewWindow view = FULL_VIEW;
+      view.level = level;
+      view.originX = origin;
+      AxisRef ax, ay;
+      viewAxes<FrameGeom, FbGeom>(view, ax, ay);
+      for (int x8 = 0; x8 < FbGeom::width; x8 += 8) {
+        alignas(16) int16_t gcc[8], scalar[8];
+        mapAxisLanes<SimdGcc>(&ax.index[x8], ax.origin, 1, FrameGeom::width - 3, gcc);
+        mapAxisLanes<SimdScalar>(&ax.index[x8], ax.origin, 1, FrameGeom::width - 3, scalar);
+        TEST_ASSERT_EQUAL_INT16_ARRAY(scalar, gcc, 8);
+        for (int l = 0; l < 8; l++) {
+          TEST_ASSERT_EQUAL_INT(sobelBase<FrameGeom::width>(ax.origin + ax.index[x8 + l]), scalar[l]);
+        }
+      }
+    }
+  }
+}
+
+// Temperatures across and beyond the display range give the same palette
+// indices, clamped below the reserved overlay entry
+void test_palette_indices_match_scalar() {
+  const float tMin = 20.0f, tMax = 40.0f;
+  std::vector<float> row(FbGeom::width);
+  for (int x = 0; x < FbGeom::width; x++) row[x] = -10.0f + 60.0f * x / FbGeom::width;
+
+  std::vector<uint8_t> gcc(FbGeom::width), scalar(FbGeom::width);
+  const SimdScalar::F sMin = SimdScalar::splat(tMin), sMax = SimdScalar::splat(tMax);
+  const SimdScalar::F sRange = SimdScalar::splat(tMax - tMin), sSteps = SimdScalar::splat(PALETTE_TOP_INDEX);
+  const SimdGcc::F gMin = SimdGcc::splat(tMin), gMax = SimdGcc::splat(tMax);
+  const SimdGcc::F gRange = SimdGcc::splat(tMax - tMin), gSteps = SimdGcc::splat(PALETTE_TOP_INDEX);
+  for (int x = 0; x < FbGeom::width; x += 4) {
+    storeColorLanes<SimdScalar>(SimdScalar::load(&row[x]), sMin, sMax, sRange, sSteps, nullptr, nullptr,
+                                scalar.data(), x);
+    storeColorLanes<SimdGcc>(SimdGcc::load(&row[x]), gMin, gMax, gRange, gSteps, nullptr, nullptr,
+                             gcc.data(), x);
+  }
+  TEST_ASSERT_EQUAL_UINT8_ARRAY(scalar.data(), gcc.data(), FbGeom::width);
+  TEST_ASSERT_EQUAL_UINT8(0, scalar[0]);
+  TEST_ASSERT_EQUAL_UINT8(PALETTE_TOP_INDEX, scalar[FbGeom::width - 1]);
+
+  // The overlay entry is the same in every palette, so a re-coloured frame
+  // keeps its edges
+  uint16_t lut[COLOR_LUT_SIZE];
+  for (int p = 0; p < PALETTE_COUNT; p++) {
+    buildPalette((PaletteId)p, lut);
+    TEST_ASSERT_EQUAL_UINT16(PALETTE_OVERLAY_COLOR, lut[EDGE_PALETTE_INDEX]);
+  }
+}
+
+void test_edge_mask_matches_scalar() {
+  std::vector<uint8_t> gcc(EDGE_MASK_BYTES), scalar(EDGE_MASK_BYTES);
+  FoveaMap<FbGeom> fovea;
+  const int focusX = FbGeom::width / 3, focusY = FbGeom::height / 2;
+  buildFoveaMap(fovea, &focusX, &focusY, 1);
+
+  calculateEdgeMaskRows<FrameGeom, FbGeom, SimdScalar>(frame.data(), scalar.data(), 0, FbGeom::height);
+  calculateEdgeMaskRows<FrameGeom, FbGeom, SimdGcc>(frame.data(), gcc.data(), 0, FbGeom::height);
+  TEST_ASSERT_EQUAL_UINT8_ARRAY(scalar.data(), gcc.data(), EDGE_MASK_BYTES);
+  bool any = false;
+  for (uint8_t b : scalar) any = any || b;
+  TEST_ASSERT_TRUE(any);
+
+  calculateEdgeMaskRows<FrameGeom, FbGeom, SimdScalar>(frame.data(), scalar.data(), 0, FbGeom::height,
+                                                       FULL_VIEW, &fovea);
+  calculateEdgeMaskRows<FrameGeom, FbGeom, SimdGcc>(frame.data(), gcc.data(), 0, FbGeom::height,
+                                                    FULL_VIEW, &fovea);
+  TEST_ASSERT_EQUAL_UINT8_ARRAY(scalar.data(), gcc.data(), EDGE_MASK_BYTES);
+}
+
+// Integer min / max where every lane is positive and finite, the float
+// decision tree elsewhere: the result is bitwise that of median3 per pixel
+void test_median_matches_decision_tree() {
+  const float specials[] = {0.0f, -0.0f, -5.5f, NAN, -NAN, INFINITY, -INFINITY, 1e-42f, 3.0e38f};
+  const int count = sizeof(specials) / sizeof(specials[0]);
+  std::vector<float> a(FrameGeom::pixels), b(FrameGeom::pixels), c(FrameGeom::pixels);
+  uint32_t seed = 1;
+  for (int i = 0; i < FrameGeom::pixels; i++) {
+    float *planes[3] = {&a[i], &b[i], &c[i]};
+    for (float *p : planes) {
+      seed = seed * 1664525u + 1013904223u;
+      *p = frame[i] + (float)((seed >> 16) % 5);
+      if (i >= FrameGeom::pixels / 2 && (seed >> 8) % 7 == 0) *p = specials[(seed >> 12) % count];
+    }
+  }
+
+  std::vector<float> gcc(FrameGeom::pixels), scalar(FrameGeom::pixels);
+  medianOf3Frames<FrameGeom, SimdGcc>(a.data(), b.data(), c.data(), gcc.data());
+  medianOf3Frames<FrameGeom, SimdScalar>(a.data(), b.data(), c.data(), scalar.data());
+  for (int i = 0; i < FrameGeom::pixels; i++) {
+    SimdScalar::F tree = median3<SimdScalar>(SimdScalar::splat(a[i]), SimdScalar::splat(b[i]),
+                                             SimdScalar::splat(c[i]));
+    TEST_ASSERT_EQUAL_MEMORY(&tree.v[0], &scalar[i], sizeof(float));
+    TEST_ASSERT_EQUAL_MEMORY(&tree.v[0], &gcc[i], sizeof(float));
+  }
+}
+
+int main() {
+  buildFrame();
+  UNITY_BEGIN();
+  RUN_TEST(test_int_ops_match_scalar);
+  RUN_TEST(test_axis_lanes_match_scalar);
+  RUN_TEST(test_palette_indices_match_scalar);
+  RUN_TEST(test_edge_mask_matches_scalar);
+  RUN_TEST(test_median_matches_decision_tree);
+  return UNITY_END();
+}